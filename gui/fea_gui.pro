@@ -32,14 +32,24 @@ SOURCES += main.cpp \
            $${EXT_BOOST_ROOT}/libs/smart_ptr/src/sp_debug_hooks.cpp \
            $${FEA_SRC_ROOT}/threed_beam_fea.cpp \
            $${FEA_SRC_ROOT}/summary.cpp \
-           $${FEA_SRC_ROOT}/setup.cpp
+           $${FEA_SRC_ROOT}/result_statistics.cpp \
+           $${FEA_SRC_ROOT}/setup.cpp \
+           $${FEA_SRC_ROOT}/csv_parser.cpp \
+           $${FEA_SRC_ROOT}/model_file.cpp \
+           $${FEA_SRC_ROOT}/lattice.cpp \
+           $${FEA_SRC_ROOT}/result_file.cpp
 
 HEADERS  += mainwindow.h \
            $${FEA_INCLUDE_ROOT}/threed_beam_fea.h \
            $${FEA_INCLUDE_ROOT}/summary.h \
+           $${FEA_INCLUDE_ROOT}/result_matrix.h \
+           $${FEA_INCLUDE_ROOT}/result_statistics.h \
            $${FEA_INCLUDE_ROOT}/setup.h \
            $${FEA_INCLUDE_ROOT}/containers.h \
            $${FEA_INCLUDE_ROOT}/csv_parser.h \
+           $${FEA_INCLUDE_ROOT}/model_file.h \
+           $${FEA_INCLUDE_ROOT}/lattice.h \
+           $${FEA_INCLUDE_ROOT}/result_file.h \
            $${FEA_INCLUDE_ROOT}/options.h
 
 RESOURCES += fea_gui.qrc
@@ -171,6 +171,33 @@ namespace fea {
         };
     };
 
+    /**
+     * @brief Section properties used to convert element end forces to stresses.
+     * @details The stresses are computed by `fea::computeElemStresses` from the local end forces of an element.
+     * @code
+     * // rectangular section of width b (along local z) and height h (along local y)
+     * double b = 0.01, h = 0.02;
+     * fea::SectionModuli section(b * h, h * b * b / 6.0, b * h * h / 6.0);
+     * @endcode
+     */
+    struct SectionModuli {
+        double area;/**<Cross-sectional area.*/
+        double Sy;/**<Elastic section modulus for bending about the local y-axis.*/
+        double Sz;/**<Elastic section modulus for bending about the local z-axis.*/
+
+        SectionModuli() : area(0), Sy(0), Sz(0) { };/**<Default constuctor*/
+
+        /**
+         * @brief Constructor
+         * @details Allows the section properties to be set upon initialization.
+         *
+         * @param[in] area double. Cross-sectional area.
+         * @param[in] Sy double. Elastic section modulus for bending about the local y-axis.
+         * @param[in] Sz double. Elastic section modulus for bending about the local z-axis.
+         */
+        SectionModuli(double _area, double _Sy, double _Sz) : area(_area), Sy(_Sy), Sz(_Sz) { };
+    };
+
     /**
      * @brief Places linear springs between all degrees of freedom of 2 nodes.
      * @details To form a tie specify the 2 nodes that will be linked as well as the spring constants for translational and rotational degrees of freedom.
@@ -305,11 +332,25 @@ namespace fea {
 
     /**
      * @brief Contains a node list, element list, and the properties of each element.
+     * @details The properties are either stored once per element, or as a table of distinct properties that the
+     * elements refer to by index through `prop_ids`. The table is much smaller if many elements share the same
+     * section.
      */
     struct Job {
         std::vector<Node> nodes;/**<A vector of Node objects that define the mesh.*/
         std::vector<Eigen::Vector2i> elems;/**<A 2D vector of ints that defines the connectivity of the node list.*/
-        std::vector<Props> props;/**<A vector that contains the properties of each element.*/
+
+        /**
+         * The properties of each element if `prop_ids` is empty, otherwise the table of properties indexed by
+         * `prop_ids`.
+         */
+        std::vector<Props> props;
+
+        /**
+         * The index into `props` of the properties of each element. Empty if `props` holds the properties of each
+         * element.
+         */
+        std::vector<unsigned int> prop_ids;
 
         /**
          * @brief Default constructor
@@ -325,7 +366,7 @@ namespace fea {
          * @param[in] elems std::vector<Elem>. The elements that define the mesh.
          *                  An element is defined by the connectivity list and the associated properties.
          */
-        Job(const std::vector<Node> &_nodes, const std::vector<Elem> _elems) : nodes(_nodes) {
+        Job(const std::vector<Node> &_nodes, const std::vector<Elem> &_elems) : nodes(_nodes) {
             unsigned int num_elems = _elems.size();
             elems.reserve(num_elems);
             props.reserve(num_elems);
@@ -335,6 +376,29 @@ namespace fea {
                 props.push_back(_elems[i].props);
             }
         };
+
+        /**
+         * @brief Constructor
+         * @details Takes a list of nodes, the connectivity of the elements, a table of properties and the index
+         * of each element's properties in the table.
+         *
+         * @param[in] nodes std::vector<Node>. The node list that defines the mesh.
+         * @param[in] elems std::vector<Eigen::Vector2i>. The indices of the nodes of each element.
+         * @param[in] props std::vector<Props>. The table of distinct properties.
+         * @param[in] prop_ids std::vector<unsigned int>. The index into `props` for each element.
+         */
+        Job(const std::vector<Node> &_nodes,
+            const std::vector<Eigen::Vector2i> &_elems,
+            const std::vector<Props> &_props,
+            const std::vector<unsigned int> &_prop_ids)
+                : nodes(_nodes), elems(_elems), props(_props), prop_ids(_prop_ids) { };
+
+        /**
+         * @brief Returns the properties of the `i`th element.
+         */
+        const Props &getElemProps(size_t i) const {
+            return prop_ids.empty() ? props[i] : props[prop_ids[i]];
+        };
     };
 
     /**
@@ -26,8 +26,10 @@
 #ifndef CSV_PARSER_H
 #define CSV_PARSER_H
 
+#include <Eigen/Core>
 #include <boost/format.hpp>
 #include <boost/tokenizer.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <exception>
 #include <fstream>
@@ -36,6 +38,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include "options.h"
 
 namespace fea {
     /**
@@ -86,9 +89,46 @@ namespace fea {
         return ins;
     }
 
+    /**
+     * @brief Read-only view of the contents of a file.
+     * @details The file is memory mapped where the platform supports it, otherwise it is read into memory.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @brief Opens and maps `filename`.
+         *
+         * @param[in] filename `std::string`. The file to map. Throws if it cannot be opened.
+         */
+        explicit MappedFile(const std::string &filename);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /**
+         * @brief Returns the first byte of the file.
+         */
+        const char *data() const { return begin; };
+
+        /**
+         * @brief Returns the size of the file in bytes.
+         */
+        size_t size() const { return length; };
+
+    private:
+        const char *begin;/**<First byte of the contents.*/
+        size_t length;/**<Size of the contents in bytes.*/
+        bool is_mapped;/**<Specifies if the contents are memory mapped or held in `buffer`.*/
+        std::vector<char> buffer;/**<Contents of the file if it could not be memory mapped.*/
+    };
+
     /**
      * @brief Reads data from a csv file into an `std::vector` and writes the contents of an `std::vector` to a file.
-     * \note The parser assumes the data is comma delimited when reading data from a file.
+     * \note The values of a row may be separated by commas, spaces or tabs. Each separator starts a new value, so
+     * empty values, e.g. between two consecutive separators, are read as 0. An empty line is a row without values.
      */
     class CSVParser {
     public:
@@ -97,31 +137,84 @@ namespace fea {
          * @brief parses the contents of `file_name` into `data`.
          *
          * @param[in] file_name `std::string`. The file specified is opened and the contained information is parsed into `data`.
-         * @param data `std::vector<T>`. Variable updated in place that will fold the data of the specified file.
+         * @param data `std::vector< std::vector<T> >`. Variable updated in place that will fold the data of the specified file.
          */
         template<typename T>
-        void parseToVector(std::string filename, std::vector<T> &data) {
+        void parseToVector(const std::string &filename, std::vector<std::vector<T> > &data) {
+            struct NestedVectorSink {
+                std::vector<std::vector<T> > &data;
+
+                void resize(size_t num_rows) {
+                    data.clear();
+                    data.resize(num_rows);
+                }
+
+                void setRow(size_t row, const double *values, size_t num_values) {
+                    data[row].resize(num_values);
+                    for (size_t j = 0; j < num_values; ++j) {
+                        data[row][j] = static_cast<T>(values[j]);
+                    }
+                }
+            };
+
+            NestedVectorSink sink = {data};
+            parseRows(filename, sink);
+        }
+
+        /**
+         * @brief Parses the rows of a csv file in parallel and hands each row to `sink`.
+         * @details The file is memory mapped and split into chunks of whole lines that are parsed on separate
+         * threads. The rows are counted first, so each row is passed with its final index and `sink` can write it
+         * directly to its destination. Numbers are parsed without allocating memory per value and give the same
+         * result as `std::strtod`.
+         *
+         * `RowSink` must provide
+         * - `void resize(size_t num_rows)`, which is called once before any row, and
+         * - `void setRow(size_t row, const double *values, size_t num_values)`, which is called once per row from
+         *   several threads at the same time.
+         *
+         * If `setRow` throws, the exception of the row with the smallest index is rethrown after all threads finish.
+         *
+         * @param[in] filename `std::string`. The file to parse.
+         * @param sink `RowSink`. Receives the number of rows and the values of each row.
+         */
+        template<typename RowSink>
+        void parseRows(const std::string &filename, RowSink &sink) {
+            MappedFile file(filename);
+            const std::vector<const char *> chunks = splitIntoChunks(file.data(), file.data() + file.size());
+            const long num_chunks = static_cast<long>(chunks.size()) - 1;
 
-            std::ifstream infile;
-            infile.open(filename);
+            // count the rows of each chunk to get the index of its first row
+            std::vector<size_t> first_row(num_chunks + 1, 0);
+#pragma omp parallel for
+            for (long i = 0; i < num_chunks; ++i) {
+                first_row[i + 1] = countRows(chunks[i], chunks[i + 1]);
+            }
+            for (long i = 0; i < num_chunks; ++i) {
+                first_row[i + 1] += first_row[i];
+            }
+            sink.resize(first_row[num_chunks]);
 
-            if (infile.is_open()) {
+            std::vector<std::exception_ptr> errors(num_chunks);
+#pragma omp parallel for schedule(dynamic, 1)
+            for (long i = 0; i < num_chunks; ++i) {
+                std::vector<double> values;
+                size_t row = first_row[i];
                 try {
-                    infile >> data;
+                    for (const char *pos = chunks[i]; pos < chunks[i + 1]; ++row) {
+                        pos = parseLine(pos, chunks[i + 1], values);
+                        sink.setRow(row, values.data(), values.size());
+                    }
                 }
-                catch (std::exception &e) {
-                    throw std::runtime_error(
-                            (boost::format("Error when parsing csv file %s.\nDetails from tokenizer:\n\t%s") %
-                             filename % e.what()).str()
-                    );
+                catch (...) {
+                    errors[i] = std::current_exception();
                 }
-
-                infile.close();
             }
-            else {
-                throw std::runtime_error(
-                        (boost::format("Error opening file %s") % filename).str()
-                );
+
+            for (long i = 0; i < num_chunks; ++i) {
+                if (errors[i]) {
+                    std::rethrow_exception(errors[i]);
+                }
             }
         }
 
@@ -132,34 +225,185 @@ namespace fea {
          * @param[in] data `std::vector< std::vector< T > >`. Data to write to file.
          * @param[in] precision `unsigned int`. The number of decimal places to use when writing the data to file.
          * @param[in] demlimiter `std::string`. The delimiter to use between data entries.
+         * @param[in] num_threads `unsigned int`. Number of threads formatting the rows, see `Options::num_threads`.
          */
         template<typename T>
         void write(const std::string &filename,
                    const std::vector<std::vector<T> > &data,
                    unsigned int precision,
-                   const std::string &delimiter) {
+                   const std::string &delimiter,
+                   unsigned int num_threads = 1) {
+            struct NestedVectorSource {
+                const std::vector<std::vector<T> > &data;
+
+                size_t size() const { return data.size(); }
+
+                size_t numCols(size_t row) const { return data[row].size(); }
+
+                const T &value(size_t row, size_t col) const { return data[row][col]; }
+            };
+
+            NestedVectorSource source = {data};
+            writeRows(filename, source, precision, delimiter, num_threads);
+        }
+
+        /**
+         * Writes the rows of the Eigen matrix `data` to the file specified by `filename`.
+         *
+         * @param[in] filename `std::string`. The file to write data to.
+         * @param[in] data `Eigen::DenseBase`. Data to write to file.
+         * @param[in] precision `unsigned int`. The number of decimal places to use when writing the data to file.
+         * @param[in] demlimiter `std::string`. The delimiter to use between data entries.
+         * @param[in] num_threads `unsigned int`. Number of threads formatting the rows, see `Options::num_threads`.
+         */
+        template<typename Derived>
+        void write(const std::string &filename,
+                   const Eigen::DenseBase<Derived> &data,
+                   unsigned int precision,
+                   const std::string &delimiter,
+                   unsigned int num_threads = 1) {
+            struct MatrixSource {
+                const Eigen::DenseBase<Derived> &data;
+
+                size_t size() const { return data.rows(); }
+
+                size_t numCols(size_t) const { return data.cols(); }
+
+                typename Derived::Scalar value(size_t row, size_t col) const { return data(row, col); }
+            };
+
+            MatrixSource source = {data};
+            writeRows(filename, source, precision, delimiter, num_threads);
+        }
+
+        /**
+         * @brief Writes the rows of `source` to a csv file.
+         * @details The rows are formatted in parallel chunks into buffers that are reused between batches of chunks,
+         * and each batch is written in order with one large write per chunk. Values are written as with
+         * `std::fixed << std::setprecision(precision)`, byte for byte, but without going through a stream per value.
+         *
+         * `RowSource` must provide
+         * - `size_t size() const`, the number of rows,
+         * - `size_t numCols(size_t row) const`, the number of values in a row, and
+         * - `value(size_t row, size_t col) const`, which returns a value. It is called from several threads at the
+         *   same time.
+         *
+         * @param[in] filename `std::string`. The file to write data to.
+         * @param[in] source `RowSource`. The rows to write.
+         * @param[in] precision `unsigned int`. The number of decimal places to use when writing the data to file.
+         * @param[in] delimiter `std::string`. The delimiter to use between data entries.
+         * @param[in] num_threads `unsigned int`. Number of threads formatting the rows, see `Options::num_threads`.
+         */
+        template<typename RowSource>
+        void writeRows(const std::string &filename,
+                       const RowSource &source,
+                       unsigned int precision,
+                       const std::string &delimiter,
+                       unsigned int num_threads = 1) {
             std::ofstream output_file;
             output_file.open(filename);
-            size_t num_cols;
 
             if (!output_file.is_open()) {
                 throw std::runtime_error(
                         (boost::format("Error opening file %s") % filename).str()
                 );
             }
-            else {
-                for (size_t i = 0; i < data.size(); ++i) {
-                    num_cols = data[i].size();
-                    for (size_t j = 0; j < num_cols; ++j) {
-                        output_file << std::fixed << std::setprecision(precision) << data[i][j];
-                        if (j < num_cols - 1) {
-                            output_file << delimiter;
+
+            const long num_rows = static_cast<long>(source.size());
+            const int max_threads = resolveNumThreads(num_threads);
+            const long rows_per_batch = static_cast<long>(WRITE_CHUNK_ROWS) * numWriteChunks(max_threads);
+            std::vector<std::string> buffers(numWriteChunks(max_threads));
+
+            for (long first = 0; first < num_rows; first += rows_per_batch) {
+                const long batch_end = std::min(first + rows_per_batch, num_rows);
+                const long num_chunks = (batch_end - first + WRITE_CHUNK_ROWS - 1) / WRITE_CHUNK_ROWS;
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(max_threads)
+                for (long c = 0; c < num_chunks; ++c) {
+                    std::string &buffer = buffers[c];
+                    buffer.clear();
+                    const long chunk_end = std::min(first + (c + 1) * WRITE_CHUNK_ROWS, batch_end);
+                    for (long i = first + c * WRITE_CHUNK_ROWS; i < chunk_end; ++i) {
+                        const size_t num_cols = source.numCols(i);
+                        for (size_t j = 0; j < num_cols; ++j) {
+                            appendValue(buffer, source.value(i, j), precision);
+                            if (j + 1 < num_cols) {
+                                buffer += delimiter;
+                            }
                         }
+                        buffer += '\n';
                     }
-                    output_file << "\n";
                 }
-                output_file.close();
+
+                for (long c = 0; c < num_chunks; ++c) {
+                    output_file.write(buffers[c].data(), buffers[c].size());
+                }
             }
+
+            output_file.close();
+            if (!output_file) {
+                throw std::runtime_error(
+                        (boost::format("Error writing file %s") % filename).str()
+                );
+            }
+        }
+
+    private:
+        /**
+         * @brief Splits the range into chunks of whole lines, one per available thread. Small ranges form a single
+         * chunk.
+         * @return The first character of each chunk followed by `end`.
+         */
+        static std::vector<const char *> splitIntoChunks(const char *begin, const char *end);
+
+        /**
+         * @brief Counts the lines in the range, including a last line without a newline.
+         */
+        static size_t countRows(const char *begin, const char *end);
+
+        /**
+         * @brief Parses the line starting at `begin` into `values`.
+         * @return The first character of the next line.
+         */
+        static const char *parseLine(const char *begin, const char *end, std::vector<double> &values);
+
+        /**
+         * @brief Parses a single value. Decimal numbers that can be converted exactly are parsed directly, all
+         * other values are passed to `std::strtod`.
+         */
+        static double parseValue(const char *begin, const char *end);
+
+        /**
+         * Number of rows formatted by a thread at a time when writing.
+         */
+        static const long WRITE_CHUNK_ROWS = 4096;
+
+        /**
+         * @brief Returns the number of chunks formatted before they are written, a few per thread.
+         *
+         * @param[in] max_threads `int`. Number of threads formatting the chunks.
+         */
+        static size_t numWriteChunks(int max_threads);
+
+        /**
+         * @brief Appends `value` to `out` as `std::fixed << std::setprecision(precision)` would write it. The
+         * decimal digits are computed directly from the binary value when it is small enough to do so exactly, other
+         * values are formatted with `std::snprintf`.
+         */
+        static void appendValue(std::string &out, double value, unsigned int precision);
+
+        static void appendValue(std::string &out, float value, unsigned int precision) {
+            appendValue(out, static_cast<double>(value), precision);
+        }
+
+        /**
+         * @brief Appends values of other types through a string stream.
+         */
+        template<typename T>
+        static void appendValue(std::string &out, const T &value, unsigned int precision) {
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(precision) << value;
+            out += stream.str();
         }
     };
 } // namespace fea
@@ -0,0 +1,163 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_LATTICE_H
+#define FEA_LATTICE_H
+
+#include <vector>
+#include <Eigen/Core>
+#include "containers.h"
+
+namespace fea {
+
+    /**
+     * @brief Built in unit cells of periodic lattices.
+     */
+    enum UnitCellType {
+        /**
+         * Simple cubic lattice. Struts along the edges of the cell.
+         */
+        CUBIC_CELL,
+        /**
+         * Octet truss. Nodes on the face centered cubic lattice connected to their 12 nearest neighbors.
+         */
+        OCTET_CELL,
+        /**
+         * Kelvin foam. Struts along the edges of the truncated octahedra that tile space on the body centered
+         * cubic lattice. Each node connects to 4 struts.
+         */
+        KELVIN_CELL
+    };
+
+    /**
+     * @brief A face of the bounding box of a mesh.
+     */
+    enum BoxFace {
+        X_MIN,
+        X_MAX,
+        Y_MIN,
+        Y_MAX,
+        Z_MIN,
+        Z_MAX
+    };
+
+    /**
+     * @brief Periodic description of a lattice.
+     * @details The nodes of a single cell are given in fractional coordinates in `[0, 1)`, so each node of the
+     * tiled lattice belongs to exactly one cell. A strut connects a node of a cell to a node of the cell shifted by
+     * `offset` cells, which allows struts to cross the boundary of the cell. Each strut of the lattice must be listed
+     * once.
+     */
+    struct UnitCell {
+        /**
+         * @brief A strut between two nodes of the periodic lattice.
+         */
+        struct Strut {
+            unsigned int node_1;/**<Index of the first node in the cell.*/
+            unsigned int node_2;/**<Index of the second node in the cell shifted by `offset`.*/
+            Eigen::Vector3i offset;/**<Number of cells between the cell of the first and second node.*/
+
+            /**
+             * @brief Constructor
+             * @param[in] node_1 `unsigned int`. Index of the first node in the cell.
+             * @param[in] node_2 `unsigned int`. Index of the second node in the shifted cell.
+             * @param[in] offset `Eigen::Vector3i`. Number of cells between the cells of the two nodes.
+             */
+            Strut(unsigned int _node_1, unsigned int _node_2, const Eigen::Vector3i &_offset)
+                    : node_1(_node_1), node_2(_node_2), offset(_offset) { };
+        };
+
+        std::vector<Eigen::Vector3d> nodes;/**<Fractional coordinates of the nodes of a single cell.*/
+        std::vector<Strut> struts;/**<Struts of a single cell.*/
+    };
+
+    /**
+     * @brief Returns one of the built in unit cells.
+     *
+     * @param[in] type `fea::UnitCellType`. The lattice to create.
+     * @return The unit cell. `fea::UnitCell`.
+     */
+    UnitCell createUnitCell(UnitCellType type);
+
+    /**
+     * @brief Creates a unit cell that connects every pair of nodes of the periodic lattice that are `strut_length`
+     * apart.
+     *
+     * @param[in] nodes `std::vector<Eigen::Vector3d>`. Fractional coordinates of the nodes of a single cell. Each
+     *                  coordinate must be in `[0, 1)`.
+     * @param[in] strut_length `double`. Distance between connected nodes in fractional coordinates.
+     * @return The unit cell. `fea::UnitCell`.
+     */
+    UnitCell createUnitCell(const std::vector<Eigen::Vector3d> &nodes, double strut_length);
+
+    /**
+     * @brief Tiles the unit cell to fill a box of `num_cells` cells and returns the resulting mesh.
+     * @details Cells are tiled from the origin. Nodes and struts that lie within the box are kept, so the faces at
+     * the upper end of the box are closed. The mesh is built in parallel without any intermediate files. The
+     * properties are stored as a table with one entry per strut of the unit cell. Each entry uses the section
+     * stiffnesses of `section` and a normal vector perpendicular to its strut, since a single normal vector is
+     * parallel to some strut of most lattices. `section.normal_vec` is ignored.
+     *
+     * @param[in] cell `fea::UnitCell`. Periodic description of the lattice.
+     * @param[in] num_cells `Eigen::Vector3i`. Number of cells along x, y and z.
+     * @param[in] cell_size `Eigen::Vector3d`. Dimensions of a cell along x, y and z.
+     * @param[in] section `fea::Props`. Stiffnesses of every strut.
+     * @return The mesh. `fea::Job`.
+     */
+    Job createLatticeJob(const UnitCell &cell,
+                         const Eigen::Vector3i &num_cells,
+                         const Eigen::Vector3d &cell_size,
+                         const Props &section);
+
+    /**
+     * @brief Returns the indices of the nodes that lie on a face of the bounding box of all nodes.
+     *
+     * @param[in] job `fea::Job`. The mesh.
+     * @param[in] face `fea::BoxFace`. The face of the bounding box.
+     * @return Node indices in ascending order. `std::vector<unsigned int>`.
+     */
+    std::vector<unsigned int> findFaceNodes(const Job &job, BoxFace face);
+
+    /**
+     * @brief Returns boundary conditions that fix all degrees of freedom of `nodes`.
+     *
+     * @param[in] nodes `std::vector<unsigned int>`. Indices of the nodes to fix.
+     * @return Boundary conditions. `std::vector<fea::BC>`.
+     */
+    std::vector<BC> createFixedBCs(const std::vector<unsigned int> &nodes);
+
+    /**
+     * @brief Returns forces that apply `total_force` split evenly over `nodes`.
+     *
+     * @param[in] nodes `std::vector<unsigned int>`. Indices of the loaded nodes.
+     * @param[in] total_force `Eigen::Vector3d`. Sum of the forces along x, y and z.
+     * @return Prescribed forces. `std::vector<fea::Force>`.
+     */
+    std::vector<Force> createDistributedForces(const std::vector<unsigned int> &nodes,
+                                               const Eigen::Vector3d &total_force);
+
+} // namespace fea
+
+#endif //FEA_LATTICE_H
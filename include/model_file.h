@@ -0,0 +1,118 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_MODEL_FILE_H
+#define FEA_MODEL_FILE_H
+
+#include <string>
+#include <vector>
+#include "containers.h"
+#include "options.h"
+
+namespace fea {
+
+    /**
+     * @brief The time it took to load one input file of a model.
+     */
+    struct InputLoadTime {
+        std::string variable;/**<The configuration member the file was given for, e.g. "nodes".*/
+        std::string filename;/**<The file that was loaded.*/
+        long long load_time_in_ms;/**<The time to read and parse the file.*/
+
+        /**
+         * @brief Constructor
+         * @param[in] variable `std::string`. The configuration member the file was given for.
+         * @param[in] filename `std::string`. The file that was loaded.
+         * @param[in] load_time_in_ms `long long`. The time to read and parse the file.
+         */
+        InputLoadTime(const std::string &_variable, const std::string &_filename, long long _load_time_in_ms)
+                : variable(_variable), filename(_filename), load_time_in_ms(_load_time_in_ms) { };
+    };
+
+    /**
+     * @brief Everything needed to run an analysis: the mesh, constraints, load cases and options.
+     */
+    struct Model {
+        Job job;/**<Nodes, elements and element properties.*/
+        std::vector<BC> bcs;/**<Boundary conditions.*/
+        std::vector<std::vector<Force> > load_cases;/**<Prescribed forces of each load case.*/
+        std::vector<Tie> ties;/**<Tie constraints.*/
+        std::vector<Equation> equations;/**<Equation constraints.*/
+        Options options;/**<Analysis options.*/
+
+        /**
+         * The time it took to load each input file, in the order the files were listed in the configuration.
+         * Not stored in binary model files.
+         */
+        std::vector<InputLoadTime> input_load_times;
+
+        /**
+         * @brief Default constructor
+         * @details Holds a single empty load case.
+         */
+        Model() : load_cases(1) { };
+    };
+
+    /**
+     * @brief Version of the binary model format written by `fea::writeModelFile`.
+     */
+    const unsigned int MODEL_FILE_VERSION = 2;
+
+    /**
+     * @brief Writes `model` to a binary model file.
+     * @details The file starts with a versioned header and a table of sections. Each section holds the records
+     * of one container, e.g. the nodal coordinates or the boundary conditions, as fixed size binary records and
+     * starts at a multiple of 64 bytes, so it can be read directly from a memory mapped file. Integers and
+     * floating point values are stored in the byte order of the machine that writes the file.
+     *
+     * `model.options` is stored as the json object created by `fea::createJSONFromOptions`, which holds the value
+     * of every option and is read back with `fea::createOptionsFromJSON`.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] model `fea::Model`. The model to store.
+     */
+    void writeModelFile(const std::string &filename, const Model &model);
+
+    /**
+     * @brief Reads a binary model file written by `fea::writeModelFile`.
+     * @details The file is memory mapped and each section is copied into its container without parsing.
+     * Throws if the file is not a model file, was written by a different version or on a machine with a
+     * different byte order, or if a section is truncated.
+     *
+     * @param[in] filename `std::string`. The file to read.
+     * @return The model. `fea::Model`.
+     */
+    Model readModelFile(const std::string &filename);
+
+    /**
+     * @brief Returns true if `filename` starts with the identifier of a binary model file.
+     *
+     * @param[in] filename `std::string`. The file to check.
+     */
+    bool isModelFile(const std::string &filename);
+
+} // namespace fea
+
+#endif //FEA_MODEL_FILE_H
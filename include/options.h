@@ -28,7 +28,92 @@
 
 #include <string>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace fea {
+    /**
+     * @brief Specifies how the linear system of the finite element analysis is solved.
+     */
+    enum LinearSolver {
+        /**
+         * Sparse LU factorization of the full stiffness matrix. Uses `Eigen::PardisoLU` if MKL is enabled,
+         * otherwise `Eigen::SparseLU`.
+         */
+        SPARSE_LU,
+        /**
+         * Sparse LDLT factorization of the upper triangle of the stiffness matrix. Only the upper triangle is
+         * assembled. Uses `Eigen::PardisoLDLT` if MKL is enabled, otherwise `Eigen::SimplicialLDLT` with an
+         * ordering that pivots every Lagrange multiplier after the degree of freedom it constrains.
+         */
+        SPARSE_LDLT,
+        /**
+         * Preconditioned conjugate gradient method on the upper triangle of the stiffness matrix. Requires a
+         * positive definite system, i.e. `Options::eliminate_bcs == true` and no equation constraints.
+         */
+        CONJUGATE_GRADIENT,
+        /**
+         * Preconditioned MINRES method on the upper triangle of the system. Handles the symmetric indefinite
+         * systems formed by Lagrange multipliers.
+         */
+        MINRES,
+        /**
+         * Preconditioned restarted GMRES method on the full system.
+         */
+        GMRES
+    };
+
+    /**
+     * @brief Specifies the preconditioner of the iterative linear solvers.
+     */
+    enum Preconditioner {
+        /**
+         * Inverts the dense block formed by the degrees of freedom of each node. Lagrange multipliers form
+         * blocks of their own.
+         */
+        BLOCK_JACOBI,
+        /**
+         * Incomplete Cholesky factorization with zero fill-in beyond the approximate minimum degree ordering.
+         * Requires a positive definite system.
+         */
+        INCOMPLETE_CHOLESKY
+    };
+
+    /**
+     * @brief Specifies how the nodes are renumbered before the analysis.
+     */
+    enum NodeOrdering {
+        /**
+         * Keeps the numbering of the input.
+         */
+        ORIGINAL_ORDER,
+        /**
+         * Reverse Cuthill-McKee ordering of the graph formed by the elements and ties. Reduces the bandwidth of the
+         * stiffness matrix.
+         */
+        REVERSE_CUTHILL_MCKEE,
+        /**
+         * Ordering along a Hilbert curve through the bounding box of the node coordinates. Keeps nodes that are
+         * close in space close in memory.
+         */
+        HILBERT_CURVE
+    };
+
+    /**
+     * @brief Specifies the format of the nodal displacement, nodal force and tie force files.
+     */
+    enum ResultFormat {
+        /**
+         * Text files with one row per node or tie, written with `Options::csv_precision` decimal places.
+         */
+        CSV_RESULTS,
+        /**
+         * NumPy `.npy` files holding an N x 6 array of doubles, written without loss of precision.
+         */
+        NPY_RESULTS
+    };
+
     /**
      * @brief Provides a method for customizing the finite element analysis.
      */
@@ -44,17 +129,39 @@ namespace fea {
 
             csv_precision = 14;
             csv_delimiter = ",";
+            result_format = CSV_RESULTS;
 
             save_nodal_displacements = false;
             save_nodal_forces = false;
             save_tie_forces = false;
             verbose = false;
             save_report = false;
+            save_vtu = false;
+
+            compute_nodal_forces = true;
+            compute_reaction_forces = true;
+            compute_tie_forces = true;
+            compute_elem_forces = false;
+            save_elem_forces = false;
+
+            num_largest_values = 3;
+            num_histogram_bins = 10;
+
+            num_threads = 1;
+            use_sparsity_pattern = false;
+            linear_solver = SPARSE_LU;
+            eliminate_bcs = false;
+            preconditioner = BLOCK_JACOBI;
+            tolerance = 1e-10;
+            max_iterations = 0;
+            node_ordering = ORIGINAL_ORDER;
 
             nodal_displacements_filename = "nodal_displacements.csv";
             nodal_forces_filename = "nodal_forces.csv";
             tie_forces_filename = "tie_forces.csv";
+            elem_forces_filename = "elem_forces.csv";
             report_filename = "report.txt";
+            vtu_filename = "results.vtu";
         }
 
         /**
@@ -75,6 +182,12 @@ namespace fea {
          */
         std::string csv_delimiter;
 
+        /**
+         * Format of the nodal displacement, nodal force and tie force files. Default = `CSV_RESULTS`.
+         * With `NPY_RESULTS` a ".csv" extension of the file names is replaced by ".npy".
+         */
+        ResultFormat result_format;
+
         /**
          * Specifies if the nodal displacements should be saved to a file. Default = `false`.
          * If `true` the nodal displacements will be saved to the file indicated by `nodal_displacements_filename`.
@@ -105,6 +218,116 @@ namespace fea {
          */
         bool save_report;
 
+        /**
+         * Specifies if the mesh and results should be saved to a VTK XML unstructured grid file. Default = `false`.
+         * If `true` the nodes, elements, ties, nodal displacements, nodal forces and tie forces will be saved to the
+         * file indicated by `vtu_filename`, which can be opened in ParaView.
+         */
+        bool save_vtu;
+
+        /**
+         * Specifies if the nodal forces should be computed. Default = `true`.
+         * If `false` the multiplication of the stiffness matrix with the displacements is skipped and
+         * `Summary::nodal_forces` is left empty, unless `save_nodal_forces` or `save_vtu` need the nodal forces.
+         * They can be computed later with `Analysis::computeNodalForces`.
+         */
+        bool compute_nodal_forces;
+
+        /**
+         * Specifies if the reaction forces should be computed. Default = `true`.
+         * Without `eliminate_bcs` the reactions are the negated Lagrange multipliers of the boundary conditions and
+         * cost nothing extra. With `eliminate_bcs` they are recovered from the residual of the unreduced system. If
+         * `false` `Summary::reaction_forces` is left empty.
+         */
+        bool compute_reaction_forces;
+
+        /**
+         * Specifies if the tie forces should be computed. Default = `true`.
+         * If `false` `Summary::tie_forces` is left empty, unless `save_tie_forces` or `save_vtu` need the tie forces.
+         * They can be computed later with `fea::computeTieForces`.
+         */
+        bool compute_tie_forces;
+
+        /**
+         * Specifies if the local end forces of the elements should be computed. Default = `false`.
+         * If `true` the forces are stored in `Summary::elem_forces`.
+         */
+        bool compute_elem_forces;
+
+        /**
+         * Specifies if the local end forces of the elements should be saved to a file. Default = `false`.
+         * If `true` the element forces will be computed and saved to the file indicated by `elem_forces_filename`,
+         * with 12 values per element.
+         */
+        bool save_elem_forces;
+
+        /**
+         * Number of values with the largest magnitude listed per degree of freedom in the statistics of the results
+         * and in the report. Default = 3.
+         */
+        unsigned int num_largest_values;
+
+        /**
+         * Number of bins of the histogram of each degree of freedom in the statistics of the results and in the
+         * report. Default = 10. A value of 0 leaves out the histograms.
+         */
+        unsigned int num_histogram_bins;
+
+        /**
+         * Number of threads used by the parallel parts of the analysis, e.g. the assembly of the global stiffness
+         * matrix and the post-processing of the results. Default = 1.
+         * A value of 0 lets OpenMP decide, which typically means one thread per core.
+         * Has no effect if the library was compiled without OpenMP support.
+         */
+        unsigned int num_threads;
+
+        /**
+         * Specifies if the global stiffness matrix should be assembled by adding the elemental stiffness matrices
+         * directly into a precomputed sparsity pattern instead of forming a list of triplets. Default = `false`.
+         * This lowers the peak memory used during assembly. The pattern includes the Lagrange multipliers, so
+         * repeated assemblies of an `fea::Analysis` only update the values of the stiffness matrix in place.
+         */
+        bool use_sparsity_pattern;
+
+        /**
+         * Method used to solve the linear system. Default = `SPARSE_LU`.
+         * The stiffness matrix is symmetric, so `SPARSE_LDLT` only stores and factors its upper triangle, which
+         * roughly halves the memory and time of the factorization.
+         */
+        LinearSolver linear_solver;
+
+        /**
+         * Specifies if the degrees of freedom prescribed by boundary conditions should be removed from the linear
+         * system instead of being enforced with Lagrange multipliers. Default = `false`.
+         * The contribution of the prescribed values is moved to the right hand side, which keeps the system small
+         * and, without equation constraints, positive definite. The reactions are reported in
+         * `Summary::reaction_forces`. Each degree of freedom may only be prescribed once.
+         */
+        bool eliminate_bcs;
+
+        /**
+         * Preconditioner used by the iterative linear solvers. Default = `BLOCK_JACOBI`.
+         */
+        Preconditioner preconditioner;
+
+        /**
+         * Relative residual at which the iterative linear solvers stop. Default = `1e-10`.
+         */
+        double tolerance;
+
+        /**
+         * Maximum number of iterations of the iterative linear solvers. Default = 0, which uses twice the number of
+         * unknowns.
+         */
+        unsigned int max_iterations;
+
+        /**
+         * Ordering of the nodes used internally by the analysis. Default = `ORIGINAL_ORDER`.
+         * The elements are sorted by their renumbered nodes as well, which improves the locality of the assembly
+         * and gives the factorization a better starting order. All results are reported in the input numbering.
+         */
+        NodeOrdering node_ordering;
+
         /**
          * File name to save the nodal displacements to when `save_nodal_displacements == true`.
          */
@@ -120,13 +343,38 @@ namespace fea {
          */
         std::string tie_forces_filename;
 
+        /**
+         * File name to save the element end forces to when `save_elem_forces == true`.
+         */
+        std::string elem_forces_filename;
+
         /**
          * File name to save the nodal forces to when `save_report == true`.
          */
         std::string report_filename;
 
+        /**
+         * File name to save the mesh and results to when `save_vtu == true`.
+         */
+        std::string vtu_filename;
+
     };
 
+    /**
+     * @brief Returns the number of threads of a parallel region for the `Options::num_threads` setting.
+     *
+     * @param[in] num_threads `unsigned int`. Requested number of threads. A value of 0 lets OpenMP decide.
+     * @return Number of threads, always 1 if the library was compiled without OpenMP support. `int`
+     */
+    inline int resolveNumThreads(unsigned int num_threads) {
+#ifdef _OPENMP
+        return num_threads > 0 ? static_cast<int>(num_threads) : omp_get_max_threads();
+#else
+        (void) num_threads;
+        return 1;
+#endif
+    }
+
 } // namespace fea
 
 #endif //THREEDBEAMFEA_OPTIONS_H
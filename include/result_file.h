@@ -0,0 +1,80 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_RESULT_FILE_H
+#define FEA_RESULT_FILE_H
+
+#include <string>
+#include <vector>
+#include "containers.h"
+#include "summary.h"
+
+namespace fea {
+
+    /**
+     * @brief Writes a row-major array of doubles to a NumPy `.npy` file.
+     * @details The file uses version 1.0 of the format and stores the values in the byte order of the machine,
+     * which is recorded in the header, so `numpy.load` returns an array of shape `(num_rows, num_cols)`. The
+     * values are written with a single write after the header.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] data `const double*`. `num_rows * num_cols` values, row after row.
+     * @param[in] num_rows `size_t`. Number of rows.
+     * @param[in] num_cols `size_t`. Number of columns.
+     */
+    void writeNpyFile(const std::string &filename, const double *data, size_t num_rows, size_t num_cols);
+
+    /**
+     * @brief Writes N x 6 nodal or tie results to a NumPy `.npy` file of shape `(results.rows(), 6)`.
+     * @details The rows of the matrix are contiguous, so the values are written without copying.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] results `fea::ResultMatrix`. The results to write.
+     */
+    void writeNpyFile(const std::string &filename, const ResultMatrix &results);
+
+    /**
+     * @brief Writes the mesh and the results of a load case to a VTK XML unstructured grid (`.vtu`) file.
+     * @details The elements and the ties are written as line cells, elements first. The cell data array
+     * "cell_set" is 0 for elements and 1 for ties, so the ties can be selected, e.g. with a threshold filter in
+     * ParaView. The point data holds the "displacement", "rotation", "force" and "moment" of each node, and the cell
+     * data holds the "tie_force" and "tie_moment" of each tie, which are zero for elements. All arrays are stored as
+     * raw binary data appended to the XML header, in the byte order of the machine.
+     *
+     * @param[in] filename `std::string`. The file to write.
+     * @param[in] job `fea::Job`. The nodes and elements of the model. The properties are not used.
+     * @param[in] ties `std::vector<fea::Tie>`. The ties of the model.
+     * @param[in] summary `fea::Summary`. The results of the load case.
+     * @param[in] num_threads `unsigned int`. Number of threads gathering the arrays, see `Options::num_threads`.
+     */
+    void writeVtuFile(const std::string &filename,
+                      const Job &job,
+                      const std::vector<Tie> &ties,
+                      const Summary &summary,
+                      unsigned int num_threads = 1);
+
+} // namespace fea
+
+#endif //FEA_RESULT_FILE_H
@@ -0,0 +1,52 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_RESULT_MATRIX_H
+#define FEA_RESULT_MATRIX_H
+
+#include <Eigen/Core>
+
+namespace fea {
+
+    /**
+     * @brief Results with one row of 6 values per node or tie, stored contiguously row after row.
+     */
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor> ResultMatrix;
+
+    /**
+     * @brief Results with one row of 12 values per element, the 6 values of its first node followed by the 6 values
+     * of its second node, stored contiguously row after row.
+     */
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 12, Eigen::RowMajor> ElemResultMatrix;
+
+    /**
+     * @brief Stresses with one row of 8 values per element, `[axial, bending_y, bending_z, max]` at its first node
+     * followed by the same values at its second node.
+     */
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 8, Eigen::RowMajor> ElemStressMatrix;
+
+} // namespace fea
+
+#endif //FEA_RESULT_MATRIX_H
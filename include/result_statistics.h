@@ -0,0 +1,136 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef FEA_RESULT_STATISTICS_H
+#define FEA_RESULT_STATISTICS_H
+
+#include <cstddef>
+#include <vector>
+#include "result_matrix.h"
+
+namespace fea {
+
+    /**
+     * @brief A value of a result and the row, i.e. the node or tie, it belongs to.
+     */
+    struct RowValue {
+        RowValue() : row(0), value(0.0) { };
+
+        RowValue(size_t _row, double _value) : row(_row), value(_value) { };
+
+        size_t row;
+        double value;
+    };
+
+    /**
+     * @brief Statistics of one column, i.e. one degree of freedom, of a `fea::ResultMatrix`.
+     */
+    struct ColumnStatistics {
+        /**
+         * Default constructor
+         */
+        ColumnStatistics() : mean(0.0), rms(0.0), histogram_min(0.0), histogram_max(0.0) { };
+
+        /**
+         * The smallest value and the first row holding it.
+         */
+        RowValue min;
+
+        /**
+         * The largest value and the first row holding it.
+         */
+        RowValue max;
+
+        /**
+         * The mean of the values.
+         */
+        double mean;
+
+        /**
+         * The root mean square of the values.
+         */
+        double rms;
+
+        /**
+         * The values with the largest magnitude, largest first. Rows with equal magnitudes are listed in order.
+         */
+        std::vector<RowValue> largest;
+
+        /**
+         * Number of values in each of the equally wide bins between `histogram_min` and `histogram_max`. The last bin
+         * includes `histogram_max`.
+         */
+        std::vector<unsigned long> histogram;
+
+        /**
+         * Lower edge of the first bin of the histogram, the smallest value.
+         */
+        double histogram_min;
+
+        /**
+         * Upper edge of the last bin of the histogram, the largest value.
+         */
+        double histogram_max;
+    };
+
+    /**
+     * @brief Statistics of the nodal or tie results of a load case, one entry per degree of freedom.
+     */
+    struct ResultStatistics {
+        /**
+         * Default constructor
+         */
+        ResultStatistics() : num_rows(0) { };
+
+        /**
+         * The number of rows the statistics were computed from. The columns are empty if this is 0.
+         */
+        size_t num_rows;
+
+        /**
+         * Statistics of each column of the results, `[x, y, z, rot_x, rot_y, rot_z]`.
+         */
+        std::vector<ColumnStatistics> columns;
+    };
+
+    /**
+     * @brief Computes the statistics of each column of `results`.
+     * @details The rows are split into chunks which are processed in parallel. The extrema, sums, sums of squares
+     * and largest magnitudes of all columns are gathered in one sweep over each chunk and merged in chunk order, so
+     * the result does not depend on the number of threads. The histograms need the range of the values and are
+     * filled in a second parallel sweep.
+     *
+     * @param[in] results `fea::ResultMatrix`. Nodal or tie results.
+     * @param[in] num_largest `unsigned int`. Number of values with the largest magnitude to keep per column.
+     * @param[in] num_bins `unsigned int`. Number of histogram bins per column. No histogram is computed if 0.
+     * @param[in] num_threads `unsigned int`. Number of threads processing the chunks, see `Options::num_threads`.
+     * @return Statistics of the results. `fea::ResultStatistics`
+     */
+    ResultStatistics computeResultStatistics(const ResultMatrix &results, unsigned int num_largest,
+                                             unsigned int num_bins, unsigned int num_threads = 1);
+
+} // namespace fea
+
+#endif //FEA_RESULT_STATISTICS_H
@@ -28,6 +28,8 @@
 
 #include "containers.h"
 #include "csv_parser.h"
+#include "lattice.h"
+#include "model_file.h"
 #include "options.h"
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
@@ -38,6 +40,8 @@ namespace fea {
      * Opens the specified json file and parses the data into a rapidjson::Document and returns the result.
      * The config document should have key's "nodes", "elems", and "props". Optionally, there can be keys
      * "bcs" for boundary conditions, "forces" for prescribed forces, and "ties" for and tie constraints between nodes.
+     * Each of these keys holds either the name of a csv file or the rows inline as an array of arrays of numbers.
+     * Use `fea::createModelFromJSONFile` to avoid holding large inline arrays in the document.
      *
      * @param config_filename `std::string`. The location of the configuration json file.
      * @return Document`rapidjson::Document`
@@ -77,6 +81,16 @@ namespace fea {
      */
     std::vector<Force> createForceVecFromJSON(const rapidjson::Document &config_doc);
 
+    /**
+     * Parses the file indicated by the "forces" key in `config_doc` into the prescribed forces of each load case.
+     * Each row is `[node number,DOF,value]` or `[node number,DOF,value,load case]`. Rows without a load case belong
+     * to load case 0. Load cases are numbered from 0, and a load case without any rows has no prescribed forces.
+     *
+     * @param config_doc `rapidjson::Document`. Document storing the file name containing the prescribed forces.
+     * @return Load cases. `std::vector< std::vector<Force> >`.
+     */
+    std::vector<std::vector<Force> > createLoadCasesFromJSON(const rapidjson::Document &config_doc);
+
     /**
      * Parses the file indicated by the "ties" key in `config_doc` into a vector of `fea::Tie`'s.
      *
@@ -95,7 +109,8 @@ namespace fea {
 
     /**
      * Creates vectors of `fea::Node`'s and `fea::Elem`'s from the files specified in `config_doc`. A
-     * `fea::Job` is created from the node and element vectors and returned.
+     * `fea::Job` is created from the node and element vectors and returned. If `config_doc` has a "lattice"
+     * member the mesh is generated from the lattice description instead.
      *
      * @param config_doc `rapidjson::Document`. Document storing the file name containing the
      *                    nodes, elements, and properties.
@@ -113,6 +128,56 @@ namespace fea {
      * @return Analysis options `fea::Options`.
      */
     Options createOptionsFromJSON(const rapidjson::Document &config_doc);
+
+    /**
+     * Creates the "options" json object that `fea::createOptionsFromJSON` reads back into `options`. Every option
+     * is written, so the result does not depend on the defaults of the reader.
+     *
+     * @param options `fea::Options`. The options to convert.
+     * @return The json object. `std::string`.
+     */
+    std::string createJSONFromOptions(const Options &options);
+
+    /**
+     * Creates a `fea::Model` from the files and options specified in `config_doc`. The "nodes", "elems" and "props"
+     * keys are required, while "bcs", "forces", "ties", "equations" and "options" are optional. A "lattice" member
+     * may be given instead of "nodes", "elems" and "props" to generate the mesh in memory with
+     * `fea::createLatticeJob`. The boundary conditions and forces of the lattice are added to those of "bcs" and to
+     * the first load case.
+     *
+     * @param config_doc `rapidjson::Document`. Document containing the configuration for the current analysis.
+     * @return Model `fea::Model`.
+     */
+    Model createModelFromJSON(const rapidjson::Document &config_doc);
+
+    /**
+     * Loads the model specified in `config_doc` and writes it to a binary model file that can be read with
+     * `fea::readModelFile`. The options are stored with the model.
+     *
+     * @param config_doc `rapidjson::Document`. Document containing the configuration for the current analysis.
+     * @param model_filename `std::string`. The binary model file to write.
+     */
+    void convertJSONToModelFile(const rapidjson::Document &config_doc, const std::string &model_filename);
+
+    /**
+     * Reads the configuration file with a SAX parser and creates the `fea::Model` it specifies. Members
+     * "nodes", "elems", "props", "bcs", "forces", "ties" and "equations" given as inline arrays are written row by
+     * row straight into the model, so no DOM is built for them. Members given as file names are parsed like in
+     * `fea::createModelFromJSON`.
+     *
+     * @param config_filename `std::string`. The location of the configuration json file.
+     * @return Model `fea::Model`.
+     */
+    Model createModelFromJSONFile(const std::string &config_filename);
+
+    /**
+     * Reads the configuration file like `fea::createModelFromJSONFile` and writes the model to a binary model file
+     * that can be read with `fea::readModelFile`. The options are stored with the model.
+     *
+     * @param config_filename `std::string`. The location of the configuration json file.
+     * @param model_filename `std::string`. The binary model file to write.
+     */
+    void convertJSONFileToModelFile(const std::string &config_filename, const std::string &model_filename);
 }
 
 #endif // FEA_SETUP_H
@@ -28,6 +28,8 @@
 
 #include <string>
 #include <vector>
+#include "result_matrix.h"
+#include "result_statistics.h"
 
 namespace fea {
 
@@ -43,6 +45,9 @@ namespace fea {
 
         /**
          * @brief Returns a message containing the results of the analysis.
+         * @details The extrema and statistics of the results are taken from `nodal_displacement_statistics`,
+         * `nodal_force_statistics` and `tie_force_statistics`, so the time to create the report does not depend on
+         * the size of the model. Results without statistics are left out.
          */
         std::string FullReport() const;
 
@@ -82,6 +87,11 @@ namespace fea {
          */
         long long tie_forces_solve_time_in_ms;
 
+        /**
+         * The time to compute the local end forces of the elements.
+         */
+        long long elem_forces_solve_time_in_ms;
+
         /**
          * The time to compute the nodal forces.
          * Does not include the time to save the summary itself if `Options::save_report == true` since all data must be
@@ -119,29 +129,93 @@ namespace fea {
          */
         unsigned long num_eqns;
 
+        /**
+         * The number of nonzero coefficients stored in the matrix of the linear system, including the coefficients
+         * of the Lagrange multipliers. Only the upper triangle is stored if `Options::linear_solver == SPARSE_LDLT`.
+         */
+        unsigned long num_stiffness_nonzeros;
+
+        /**
+         * Name of the factorization used to solve the linear system, e.g. `"SparseLU"`.
+         */
+        std::string linear_solver;
+
+        /**
+         * The number of iterations of the iterative linear solver, the largest over all load cases that were solved
+         * together. Zero if a direct solver was used.
+         */
+        unsigned long iterations;
+
+        /**
+         * The estimated relative residual of the solution of the iterative linear solver, the largest over all load
+         * cases that were solved together. Zero if a direct solver was used.
+         */
+        double residual;
+
         /**
          * The resultant nodal displacement from the FE analysis.
-         * `nodal_displacements` is a 2D vector where each row
+         * `nodal_displacements` is a row-major matrix where each row
          * correspond to a node, and the columns correspond to
          * `[d_x, d_y, d_z, theta_x, theta_y, theta_z]`
          */
-        std::vector<std::vector<double> > nodal_displacements;
+        ResultMatrix nodal_displacements;
 
         /**
          * The resultant nodal forces from the FE analysis.
-         * `nodal_displacements` is a 2D vector where each row
+         * `nodal_forces` is a row-major matrix where each row
          * correspond to a node, and the columns correspond to
-         * `[f_x, f_y, f_z, m_x, m_y, m_z]`
+         * `[f_x, f_y, f_z, m_x, m_y, m_z]`. Empty if the nodal forces were not computed, see
+         * `Options::compute_nodal_forces`.
          */
-        std::vector<std::vector<double> > nodal_forces;
+        ResultMatrix nodal_forces;
 
         /**
          * The resultant forces associated with ties between nodes.
-         * `tie_forces` is a 2D vector where each row
+         * `tie_forces` is a row-major matrix where each row
          * correspond to a tie, and the columns correspond to
-         * `[f_x, f_y, f_z, f_rot_x, f_rot_y, f_rot_z]`
+         * `[f_x, f_y, f_z, f_rot_x, f_rot_y, f_rot_z]`. Empty if the tie forces were not computed, see
+         * `Options::compute_tie_forces`.
+         */
+        ResultMatrix tie_forces;
+
+        /**
+         * The local end forces of the elements, in the input order of the elements.
+         * `elem_forces` is a row-major matrix where each row corresponds to an element, and the columns correspond to
+         * `[f_x, f_y, f_z, m_x, m_y, m_z]` at its first node followed by the same values at its second node, in the
+         * local coordinate system of the element. Only computed if `Options::compute_elem_forces` or
+         * `Options::save_elem_forces` is `true`. See `fea::computeElemForces`.
+         */
+        ElemResultMatrix elem_forces;
+
+        /**
+         * The reaction force or moment required to enforce each boundary condition, in the order the boundary
+         * conditions were specified. Only computed if `Options::compute_reaction_forces == true`. The reactions are
+         * the negated Lagrange multipliers of the boundary conditions, or are recovered from the residual of the
+         * unreduced system if `Options::eliminate_bcs == true`.
+         */
+        std::vector<double> reaction_forces;
+
+        /**
+         * The generalized force enforcing each equation constraint, in the order the equations were specified. This
+         * is the negated Lagrange multiplier of the equation, so the force acting on the degree of freedom of a term
+         * is its coefficient times this value.
+         */
+        std::vector<double> equation_forces;
+
+        /**
+         * Statistics of each degree of freedom of `nodal_displacements`.
+         */
+        ResultStatistics nodal_displacement_statistics;
+
+        /**
+         * Statistics of each degree of freedom of `nodal_forces`.
+         */
+        ResultStatistics nodal_force_statistics;
+
+        /**
+         * Statistics of each degree of freedom of `tie_forces`.
          */
-        std::vector<std::vector<double> > tie_forces;
+        ResultStatistics tie_force_statistics;
 
     };
 
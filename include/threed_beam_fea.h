@@ -35,20 +35,30 @@
 #ifndef THREED_BEAM_FEA_H
 #define THREED_BEAM_FEA_H
 
+#include <memory>
+
+// the unsupported iterative solvers use std::cerr without including iostream
+#include <iostream>
+
 #ifdef EIGEN_USE_MKL_ALL
 #include <Eigen/PardisoSupport>
 #else
 #include <Eigen/SparseLU>
+#include <Eigen/SparseCholesky>
 #endif
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/OrderingMethods>
 #include <Eigen/SparseCore>
+#include <unsupported/Eigen/IterativeSolvers>
 
 #include "containers.h"
 #include "options.h"
 #include "summary.h"
 #include "csv_parser.h"
+#include "result_file.h"
 
 namespace fea {
 
@@ -73,6 +83,123 @@ namespace fea {
      */
     typedef Eigen::SparseMatrix<double> SparseMat;
 
+    /**
+     * @brief Compressed column sparsity pattern of the stiffness matrix formed by the elements and ties of a job.
+     * @details Every node contributes a dense 6x6 block to each node it is connected to, so all 6 columns of a
+     * node share the same row indices: the 6 rows of every connected node in ascending order. In addition to the
+     * pattern, the offset of each connected node's rows within the columns of the elements and ties is stored.
+     * This allows the elemental stiffness matrices to be added directly to the values of the sparse matrix.
+     * The pattern may also hold the entries of the Lagrange multipliers of the boundary conditions and equations,
+     * which follow the degrees of freedom in the same order as `loadBCs` and `loadEquations` place them.
+     * The pattern only depends on the connectivity and the constrained degrees of freedom, so it can be reused as
+     * long as these are unchanged.
+     */
+    struct SparsityPattern {
+        /**
+         * Number of degrees of freedom covered by the pattern, i.e. `6 * job.nodes.size()`.
+         */
+        unsigned long num_dofs;
+
+        /**
+         * Specifies if the pattern only contains the upper triangle, i.e. the entries with row <= column.
+         * The rows of each column are a prefix of the rows of the full pattern, so the offsets are the same.
+         */
+        bool upper_only;
+
+        /**
+         * Index of the first entry of each column followed by the number of entries. Covers the `num_dofs`
+         * degrees of freedom followed by one column per Lagrange multiplier.
+         */
+        std::vector<SparseMat::StorageIndex> outer_index;
+
+        /**
+         * Row indices of the entries in each column.
+         */
+        std::vector<SparseMat::StorageIndex> inner_index;
+
+        /**
+         * Offset of the rows of a node within the columns of another node. Stored as 4 values per element
+         * in the order `(nn1 in nn1), (nn2 in nn1), (nn1 in nn2), (nn2 in nn2)`.
+         */
+        std::vector<SparseMat::StorageIndex> elem_offsets;
+
+        /**
+         * Offsets for each tie stored in the same order as `elem_offsets`.
+         */
+        std::vector<SparseMat::StorageIndex> tie_offsets;
+
+        /**
+         * Position in the values of the coupling of each boundary condition with its Lagrange multiplier. Stored as
+         * 2 values per boundary condition: the entry in the multiplier's column and the entry in the multiplier's
+         * row, which is `-1` if only the upper triangle is stored.
+         */
+        std::vector<SparseMat::StorageIndex> bc_slots;
+
+        /**
+         * Positions of the coefficient of each equation term stored in the same order as `bc_slots`. The terms of
+         * all equations are stored one after the other.
+         */
+        std::vector<SparseMat::StorageIndex> equation_slots;
+
+        /**
+         * @brief Default constructor
+         */
+        SparsityPattern() : num_dofs(0), upper_only(false) { };
+    };
+
+    /**
+     * Number of elemental stiffness matrices computed together by `GlobalStiffAssembler::calcKelemBatch`.
+     * Matches the number of doubles in the widest vector registers the code is compiled for.
+     */
+#ifdef __AVX512F__
+    const unsigned int ELEM_BATCH_SIZE = 8;
+#else
+    const unsigned int ELEM_BATCH_SIZE = 4;
+#endif
+
+    /**
+     * @brief Element data stored as one contiguous array per quantity.
+     * @details Holds everything that is needed to compute the elemental stiffness matrices, so consecutive
+     * elements can be loaded into the lanes of a vector register. The arrays are indexed by element number.
+     */
+    struct ElemSoA {
+        typedef std::vector<double, Eigen::aligned_allocator<double> > Array;
+
+        Array dx;/**<x-component of the vector from the first to the second node.*/
+        Array dy;/**<y-component of the vector from the first to the second node.*/
+        Array dz;/**<z-component of the vector from the first to the second node.*/
+        Array EA;/**<Axial stiffness of each element.*/
+        Array EIz;/**<Bending stiffness about the local z-axis of each element.*/
+        Array EIy;/**<Bending stiffness about the local y-axis of each element.*/
+        Array GJ;/**<Torsional stiffness of each element.*/
+        Array nvx;/**<x-component of the normal vector of each element.*/
+        Array nvy;/**<y-component of the normal vector of each element.*/
+        Array nvz;/**<z-component of the normal vector of each element.*/
+
+        /**
+         * @brief Constructor
+         * @details Gathers the element geometry and properties of `job`.
+         *
+         * @param[in] job `fea::Job`. Contains node, element, and property lists.
+         * @param[in] num_threads `unsigned int`. Number of threads gathering the data, see `Options::num_threads`.
+         */
+        explicit ElemSoA(const Job &job, unsigned int num_threads = 1);
+    };
+
+    /**
+     * @brief Returns whether only the upper triangle of the linear system is stored for the requested solver.
+     * @details Holds for the solvers that only read one triangle of a symmetric matrix, i.e. all but
+     * `SPARSE_LU` and `GMRES`.
+     *
+     * @param[in] options `fea::Options`. Options of the current analysis.
+     * @return Upper triangle storage. `bool`.
+     */
+    inline bool storesUpperTriangle(const Options &options) {
+        return options.linear_solver == SPARSE_LDLT
+               || options.linear_solver == CONJUGATE_GRADIENT
+               || options.linear_solver == MINRES;
+    }
+
     /**
      * @brief Calculates the distance between 2 nodes.
      * @details Calculates the original Euclidean distance between 2 nodes in the x-y plane.
@@ -95,13 +222,21 @@ namespace fea {
          * @brief Default constructor.
          * @details Initializes all entries in member matrices to 0.0.
          */
-        GlobalStiffAssembler() {
-            Kelem.setZero();
-            Klocal.setZero();
-            Aelem.setZero();
-            AelemT.setZero();
-            SparseKelem.resize(12, 12);
-            SparseKelem.reserve(40);
+        GlobalStiffAssembler() : num_threads(1), upper_only(false) {
+            init();
+        };
+
+        /**
+         * @brief Constructor
+         * @details Initializes all entries in member matrices to 0.0 and reads the assembly settings,
+         * e.g. the number of threads, from the provided options. Only the upper triangle is assembled if
+         * `storesUpperTriangle(options)` holds.
+         *
+         * @param[in] options `fea::Options`. Options of the current analysis.
+         */
+        explicit GlobalStiffAssembler(const Options &options)
+                : num_threads(options.num_threads), upper_only(storesUpperTriangle(options)) {
+            init();
         };
 
         /**
@@ -114,17 +249,71 @@ namespace fea {
          * @param[in] job `fea::Job`. Current Job to analyze contains node, element, and property lists.
          * @param[in] ties `std::vector<fea::Tie>`. Vector of ties that apply to attach springs of specified stiffness to
          *                                     all nodal degrees of freedom between each set of nodes indicated.
+         *
+         * \note If more than one thread was requested the elements are split into contiguous blocks, one per thread.
+         * Each thread uses its own copy of the elemental matrices and its own list of triplets. The lists are
+         * concatenated in element order before the global matrix is formed, so the result is identical to the
+         * serial assembly.
+         * \note If the assembler was constructed for a solver that only reads the upper triangle, only the upper
+         * triangle of `Kg` is formed.
          */
         void operator()(SparseMat &Kg, const Job &job, const std::vector<Tie> &ties);
 
+        /**
+         * @brief Assembles the global stiffness matrix directly into a precomputed sparsity pattern.
+         * @details The elemental stiffness matrices are added to the values of `Kg` through the offsets stored in
+         * `pattern`, so no triplets are formed. If `Kg` does not yet have the structure described by `pattern` it
+         * is set up first, otherwise only the values are recomputed and no memory is allocated. `Kg` must have at
+         * least as many rows and columns as `pattern`. Any additional columns are left empty. The entries of the
+         * Lagrange multipliers in the pattern are set to zero and can be filled in with `loadBCs` and
+         * `loadEquations`. Only the upper triangle is formed if `pattern.upper_only` is set.
+         *
+         * @param Kg `fea::SparseMat`. Modified in place. After evaluation, Kg is compressed and contains the
+         *                             stiffness of the elements and ties.
+         * @param[in] job `fea::Job`. Current Job to analyze contains node, element, and property lists.
+         * @param[in] ties `std::vector<fea::Tie>`. Vector of ties used to compute `pattern`.
+         * @param[in] pattern `fea::SparsityPattern`. Pattern computed from `job` and `ties`.
+         *
+         * \note If more than one thread was requested the nodes are split into contiguous blocks, one per thread.
+         * Each thread computes the elemental matrices of the elements connected to its nodes and only adds them to
+         * the columns of its nodes, so no two threads write the same value. Every value receives its contributions
+         * in element order, so the result is identical to the serial assembly.
+         */
+        void operator()(SparseMat &Kg, const Job &job, const std::vector<Tie> &ties, const SparsityPattern &pattern);
+
         /**
          * @brief Updates the elemental stiffness matrix for the `ith` element.
+         * @details The rotation to global coordinates is applied to each 3x3 block of the local stiffness matrix
+         * in closed form, so neither `Klocal` nor the rotation matrices are formed. `getAelem` does not reflect
+         * the current element after calling this function.
          *
          * @param[in] i `unsigned int`. Specifies the ith element for which the elemental stiffness matrix is calculated.
          * @param[in] job `Job`. Current `fea::Job` to analyze contains node, element, and property lists.
          */
         void calcKelem(unsigned int i, const Job &job);
 
+        /**
+         * @brief Updates the elemental stiffness matrix for the `ith` element using dense matrix products.
+         * @details Forms the local stiffness matrix and the rotation matrices and evaluates
+         * \f$[A]^T[K_{local}][A]\f$. This is the reference implementation of `calcKelem`.
+         *
+         * @param[in] i `unsigned int`. Specifies the ith element for which the elemental stiffness matrix is calculated.
+         * @param[in] job `Job`. Current `fea::Job` to analyze contains node, element, and property lists.
+         */
+        void calcKelemDense(unsigned int i, const Job &job);
+
+        /**
+         * @brief Updates the elemental stiffness matrices of elements `[first, first + ELEM_BATCH_SIZE)`.
+         * @details Uses the same closed form as `calcKelem`, evaluated for all elements of the batch at once so the
+         * compiler can vectorize across elements. The results are identical to calling `calcKelem` for each
+         * element and can be retrieved with `getKelemBatch`.
+         *
+         * @param[in] first `size_t`. Index of the first element of the batch.
+         * @param[in] elems `fea::ElemSoA`. Element data of the current job. Must hold at least
+         *                  `first + ELEM_BATCH_SIZE` elements.
+         */
+        void calcKelemBatch(size_t first, const ElemSoA &elems);
+
         /**
          * @brief Updates the rotation and transposed rotation matrices.
          * @details The rotation matrices `Aelem` and `AelemT` are updated based on the 2 specified unit
@@ -135,6 +324,28 @@ namespace fea {
          */
         void calcAelem(const Eigen::Vector3d &nx, const Eigen::Vector3d &nz);
 
+        /**
+         * @brief Computes the end forces of elements `[first, last)` in their local coordinate systems.
+         * @details The elemental stiffness matrices are computed in batches as during the assembly. Since
+         * \f$[A][K_{elem}] = [K_{local}][A]\f$, the local end forces are \f$[A][K_{elem}]\{u_e\}\f$, where
+         * \f$\{u_e\}\f$ holds the global displacements of the two nodes and the rotation \f$[A]\f$ is applied to
+         * each 3-vector with `calcAelem`.
+         *
+         * @param[in] first `size_t`. Index of the first element.
+         * @param[in] last `size_t`. One past the index of the last element.
+         * @param[in] job `Job`. Current `fea::Job` to analyze contains node, element, and property lists.
+         * @param[in] elems `fea::ElemSoA`. Element data of `job`.
+         * @param[in] nodal_displacements `fea::ResultMatrix`. Displacements of the nodes of `job`.
+         * @param elem_forces `fea::ElemResultMatrix`. Modified in place. Rows `[first, last)` are set to the local
+         *                    end forces `[f_x, f_y, f_z, m_x, m_y, m_z]` of the first and second node.
+         */
+        void calcElemForces(size_t first,
+                            size_t last,
+                            const Job &job,
+                            const ElemSoA &elems,
+                            const ResultMatrix &nodal_displacements,
+                            ElemResultMatrix &elem_forces);
+
         /**
          * @brief Returns the currently stored elemental stiffness matrix.
          * @return <B>Elemental stiffness matrix</B> `fea::LocalMatrix`.
@@ -143,6 +354,16 @@ namespace fea {
             return Kelem;
         }
 
+        /**
+         * @brief Returns an elemental stiffness matrix computed by the last call to `calcKelemBatch`.
+         *
+         * @param[in] lane `unsigned int`. Position of the element within the batch.
+         * @return <B>Elemental stiffness matrix</B> `fea::LocalMatrix`.
+         */
+        LocalMatrix getKelemBatch(unsigned int lane) {
+            return KelemBatch[lane];
+        }
+
         /**
          * @brief Returns the currently stored rotation matrix.
          * @return <B>Rotation matrix</B> `fea::LocalMatrix`.
@@ -152,6 +373,68 @@ namespace fea {
         }
 
     private:
+        /**
+         * @brief Sets all entries in the member matrices to 0.0.
+         */
+        void init() {
+            Kelem.setZero();
+            Klocal.setZero();
+            Aelem.setZero();
+            AelemT.setZero();
+            SparseKelem.resize(12, 12);
+            SparseKelem.reserve(40);
+        }
+
+        /**
+         * @brief Appends the triplets of an elemental stiffness matrix to `triplets`.
+         *
+         * @param[in] K `fea::LocalMatrix`. Elemental stiffness matrix in global coordinates.
+         * @param[in] nn1 `int`. Index of the first node of the element.
+         * @param[in] nn2 `int`. Index of the second node of the element.
+         * @param triplets `std::vector< Eigen::Triplet< double > >`. Modified in place. Entries below the diagonal
+         *                 of the global matrix are skipped if only the upper triangle is assembled.
+         */
+        void appendTriplets(const LocalMatrix &K, int nn1, int nn2, std::vector<Eigen::Triplet<double> > &triplets);
+
+        /**
+         * @brief Appends the triplets of the elemental stiffness matrices of elements `[first, last)` to `triplets`.
+         *
+         * @param[in] first `size_t`. Index of the first element to assemble.
+         * @param[in] last `size_t`. One past the index of the last element to assemble.
+         * @param[in] job `Job`. Current `fea::Job` to analyze contains node, element, and property lists.
+         * @param[in] elems `fea::ElemSoA`. Element data of `job`.
+         * @param triplets `std::vector< Eigen::Triplet< double > >`. Modified in place. Triplets are appended in element order.
+         */
+        void assembleElems(size_t first,
+                           size_t last,
+                           const Job &job,
+                           const ElemSoA &elems,
+                           std::vector<Eigen::Triplet<double> > &triplets);
+
+        /**
+         * @brief Adds the elemental stiffness matrices to the columns of nodes `[first_node, last_node)`.
+         * @details Only the elements connected to one of the nodes are computed. The elements are visited in order.
+         *
+         * @param[in] first_node `size_t`. Index of the first node whose columns are assembled.
+         * @param[in] last_node `size_t`. One past the index of the last node whose columns are assembled.
+         * @param[in] job `Job`. Current `fea::Job` to analyze contains node, element, and property lists.
+         * @param[in] elems `fea::ElemSoA`. Element data of `job`.
+         * @param[in] pattern `fea::SparsityPattern`. Pattern computed from `job`.
+         * @param[in] outer `SparseMat::StorageIndex*`. Index of the first entry of each column of the global matrix.
+         * @param values `double*`. Modified in place. Values of the global matrix.
+         */
+        void scatterElems(size_t first_node,
+                          size_t last_node,
+                          const Job &job,
+                          const ElemSoA &elems,
+                          const SparsityPattern &pattern,
+                          const SparseMat::StorageIndex *outer,
+                          double *values);
+
+        unsigned int num_threads;
+        /**<Number of threads used during assembly. `0` uses the OpenMP default.*/
+        bool upper_only;
+        /**<Specifies if only the upper triangle of the global stiffness matrix is assembled.*/
         LocalMatrix Kelem;
         /**<Elemental stiffness matrix in global coordinate system.*/
         LocalMatrix Klocal;
@@ -161,8 +444,39 @@ namespace fea {
         LocalMatrix AelemT;
         /**<Transposed rotation matrix.*/
         SparseMat SparseKelem;/**<Sparse representation of elemental stiffness matrix.*/
+        LocalMatrix KelemBatch[ELEM_BATCH_SIZE];/**<Elemental stiffness matrices of the last batch.*/
     };
 
+    /**
+     * @brief Computes the sparsity pattern of the stiffness matrix formed by the elements and ties.
+     *
+     * @param[in] job `fea::Job`. Contains the node and element lists that define the connectivity.
+     * @param[in] ties `std::vector<fea::Tie>`. Vector of ties that connect additional pairs of nodes.
+     * @param[in] upper_only `bool`. Specifies if only the upper triangle should be included in the pattern.
+     * @return Sparsity pattern. `fea::SparsityPattern`.
+     */
+    SparsityPattern computeSparsityPattern(const Job &job, const std::vector<Tie> &ties, bool upper_only = false);
+
+    /**
+     * @brief Computes the sparsity pattern of the stiffness matrix including the Lagrange multipliers.
+     * @details Adds a column for the multiplier of each boundary condition followed by a column for the multiplier
+     * of each equation. These hold the constrained degrees of freedom and, unless only the upper triangle is
+     * included, are mirrored as rows in the columns of the degrees of freedom. The diagonal of a multiplier is
+     * not part of the pattern.
+     *
+     * @param[in] job `fea::Job`. Contains the node and element lists that define the connectivity.
+     * @param[in] ties `std::vector<fea::Tie>`. Vector of ties that connect additional pairs of nodes.
+     * @param[in] BCs `std::vector<fea::BC>`. Boundary conditions enforced with Lagrange multipliers.
+     * @param[in] equations `std::vector<fea::Equation>`. Equations enforced with Lagrange multipliers.
+     * @param[in] upper_only `bool`. Specifies if only the upper triangle should be included in the pattern.
+     * @return Sparsity pattern. `fea::SparsityPattern`.
+     */
+    SparsityPattern computeSparsityPattern(const Job &job,
+                                           const std::vector<Tie> &ties,
+                                           const std::vector<BC> &BCs,
+                                           const std::vector<Equation> &equations,
+                                           bool upper_only = false);
+
     /**
     * @brief Loads the boundary conditions into the global stiffness matrix and force vector.
     * @details Boundary conditions are enforced via Lagrange multipliers. The reaction force
@@ -176,10 +490,159 @@ namespace fea {
     * @param[in] num_nodes `unsigned int`. The number of nodes in the current job being analyzed.
     *                                  Used to calculate the position to insert border coefficients associated
     *                                  with enforcing boundary conditions via Langrange multipliers.
+    * @param[in] upper_only `bool`. Specifies if only the coefficients in the upper triangle of `Kg` should be set.
     */
-    void loadBCs(SparseMat &Kg, ForceVector &force_vec, const std::vector<BC> &BCs, unsigned int num_nodes);
+    void loadBCs(SparseMat &Kg,
+                 SparseMat &force_vec,
+                 const std::vector<BC> &BCs,
+                 unsigned int num_nodes,
+                 bool upper_only = false);
+
+    /**
+    * @brief Loads the boundary conditions into a global stiffness matrix that has the structure of a pattern.
+    * @details Same as `loadBCs` above, but the coefficients are written to the entries reserved by `pattern`, so
+    * the structure of `Kg` is unchanged.
+    *
+    * @param Kg `fea::SparseMat`. Coefficients are modified in place. Must have the structure of `pattern`.
+    * @param force_vec `fea::ForceVector`. Right hand side of the \f$[K][Q]=[F]\f$ equation of the FE analysis.
+    * @param[in] BCs `std::vector<fea::BC>`. Vector of `BC`'s used to compute `pattern`.
+    * @param[in] pattern `fea::SparsityPattern`. Pattern computed with `BCs`.
+    */
+    void loadBCs(SparseMat &Kg, SparseMat &force_vec, const std::vector<BC> &BCs, const SparsityPattern &pattern);
+
+    /**
+    * @brief Loads the equation constraints into the global stiffness matrix.
+    * @details Equations are enforced via Lagrange multipliers. The coefficients of each equation are added
+    * as the row and column following the boundary conditions.
+    *
+    * @param Kg `fea::SparseMat`. Coefficients are modified in place to reflect Lagrange multipliers.
+    *                             Assumes `Kg` has the correct dimensions.
+    * @param[in] equations `std::vector<fea::Equation>`. Vector of `Equation`'s to apply to the current analysis.
+    * @param[in] num_nodes `unsigned int`. The number of nodes in the current job being analyzed.
+    * @param[in] num_bcs `unsigned int`. The number of boundary conditions in the current analysis.
+    * @param[in] upper_only `bool`. Specifies if only the coefficients in the upper triangle of `Kg` should be set.
+    */
+    void loadEquations(SparseMat &Kg,
+                       const std::vector<Equation> &equations,
+                       unsigned int num_nodes,
+                       unsigned int num_bcs,
+                       bool upper_only = false);
+
+    /**
+    * @brief Loads the equation constraints into a global stiffness matrix that has the structure of a pattern.
+    * @details Same as `loadEquations` above, but the coefficients are written to the entries reserved by
+    * `pattern`, so the structure of `Kg` is unchanged.
+    *
+    * @param Kg `fea::SparseMat`. Coefficients are modified in place. Must have the structure of `pattern`.
+    * @param[in] equations `std::vector<fea::Equation>`. Vector of `Equation`'s used to compute `pattern`.
+    * @param[in] pattern `fea::SparsityPattern`. Pattern computed with `equations`.
+    */
+    void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations, const SparsityPattern &pattern);
+
+    /**
+     * @brief Fill-reducing ordering for symmetric systems with Lagrange multipliers.
+     * @details The diagonal of a Lagrange multiplier is zero, so an LDLT factorization without pivoting fails if a
+     * multiplier is eliminated before the degrees of freedom it constrains. Multipliers are recognized as columns
+     * without a diagonal entry. Each multiplier is paired with the first degree of freedom in its column that has
+     * not yet been paired. The approximate minimum degree ordering is computed for the graph in which each pair is
+     * merged into a single vertex, and every multiplier is placed directly after its degree of freedom. Multipliers
+     * that could not be paired are placed last. Meets the interface of the `Ordering` template argument of
+     * `Eigen::SimplicialLDLT`.
+     */
+    template<typename StorageIndex>
+    class LagrangeMultiplierOrdering {
+    public:
+        typedef Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, StorageIndex> PermutationType;
+
+        /**
+         * @brief Computes the ordering.
+         *
+         * @param[in] mat Sparse matrix with a symmetric pattern, i.e. both triangles must be stored.
+         * @param perm `PermutationType`. Modified in place. `perm.indices()[k]` is the column eliminated at step `k`.
+         */
+        template<typename MatrixType>
+        void operator()(const MatrixType &mat, PermutationType &perm) {
+            typedef Eigen::SparseMatrix<double, Eigen::ColMajor, StorageIndex> PatternMatrix;
+            const StorageIndex n = mat.cols();
+
+            std::vector<bool> has_diag(n, false);
+            for (StorageIndex j = 0; j < n; ++j) {
+                for (typename MatrixType::InnerIterator it(mat, j); it; ++it) {
+                    if (it.index() == j) {
+                        has_diag[j] = true;
+                    }
+                }
+            }
+
+            // pair each multiplier with a degree of freedom it constrains
+            std::vector<StorageIndex> multiplier(n, -1), unpaired;
+            for (StorageIndex j = 0; j < n; ++j) {
+                if (has_diag[j]) {
+                    continue;
+                }
+                typename MatrixType::InnerIterator it(mat, j);
+                while (it && (!has_diag[it.index()] || multiplier[it.index()] >= 0)) {
+                    ++it;
+                }
+                if (it) {
+                    multiplier[it.index()] = j;
+                }
+                else {
+                    unpaired.push_back(j);
+                }
+            }
 
-    void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations, unsigned int num_nodes, unsigned int num_bcs);
+            // number the vertices of the merged graph. Multipliers share the vertex of their degree of freedom.
+            std::vector<StorageIndex> vertex(n, -1), vertex_dof;
+            for (StorageIndex j = 0; j < n; ++j) {
+                if (has_diag[j]) {
+                    vertex[j] = vertex_dof.size();
+                    vertex_dof.push_back(j);
+                }
+            }
+            for (StorageIndex j = 0; j < n; ++j) {
+                if (has_diag[j] && multiplier[j] >= 0) {
+                    vertex[multiplier[j]] = vertex[j];
+                }
+            }
+
+            const StorageIndex num_vertices = vertex_dof.size();
+            std::vector<Eigen::Triplet<double> > triplets;
+            for (StorageIndex j = 0; j < n; ++j) {
+                if (vertex[j] < 0) {
+                    continue;
+                }
+                for (typename MatrixType::InnerIterator it(mat, j); it; ++it) {
+                    if (vertex[it.index()] >= 0) {
+                        triplets.push_back(Eigen::Triplet<double>(vertex[it.index()], vertex[j], 1.0));
+                    }
+                }
+            }
+            PatternMatrix merged(num_vertices, num_vertices);
+            merged.setFromTriplets(triplets.begin(), triplets.end());
+
+            std::vector<StorageIndex> order;
+            order.reserve(n);
+            if (num_vertices > 0) {
+                PermutationType merged_perm;
+                Eigen::AMDOrdering<StorageIndex> amd;
+                amd(merged, merged_perm);
+                for (StorageIndex k = 0; k < num_vertices; ++k) {
+                    const StorageIndex dof = vertex_dof[merged_perm.indices()[k]];
+                    order.push_back(dof);
+                    if (multiplier[dof] >= 0) {
+                        order.push_back(multiplier[dof]);
+                    }
+                }
+            }
+            order.insert(order.end(), unpaired.begin(), unpaired.end());
+
+            perm.resize(n);
+            for (StorageIndex k = 0; k < n; ++k) {
+                perm.indices()[k] = order[k];
+            }
+        }
+    };
 
     /**
      * @brief Loads any tie constraints into the set of triplets that will become the global stiffness matrix.
@@ -199,19 +662,397 @@ namespace fea {
      * analysis and the spring constants provided in `ties`.
      *
      * @param[in] ties `std::vector<Tie>`. Vector of `fea::Tie`'s to applied to the current analysis.
-     * @param[in] nodal_displacements `std::vector < std::vector < double > >`. The resultant nodal displacements of the analysis.
-     * @return Tie forces. `std::vector < std::vector < double > >`
+     * @param[in] nodal_displacements `fea::ResultMatrix`. The resultant nodal displacements of the analysis.
+     * @return Tie forces. `fea::ResultMatrix`
+     */
+    ResultMatrix computeTieForces(const std::vector<Tie> &ties, const ResultMatrix &nodal_displacements);
+
+    /**
+     * @brief Computes the end forces and moments of each element in its local coordinate system.
+     * @details The elements are processed in parallel chunks with `GlobalStiffAssembler::calcElemForces`. The
+     * forces are those the nodes exert on the element, so for an element in tension `f_x` is negative at the first
+     * node and positive at the second node. The element data only depends on `job`, so it can be gathered once and
+     * reused for the displacements of every load case.
+     *
+     * @param[in] job `fea::Job`. Contains the node, element, and property lists for the mesh.
+     * @param[in] elems `fea::ElemSoA`. Element data of `job`.
+     * @param[in] nodal_displacements `fea::ResultMatrix`. The resultant nodal displacements of the analysis.
+     * @param[in] num_threads `unsigned int`. Number of threads processing the chunks, see `Options::num_threads`.
+     * @return Local end forces, one row of `[f_x, f_y, f_z, m_x, m_y, m_z]` of the first node followed by those of
+     * the second node per element. `fea::ElemResultMatrix`
      */
-    std::vector<std::vector<double> > computeTieForces(const std::vector<Tie> &ties,
-                                                       const std::vector<std::vector<double> > &nodal_displacements);
+    ElemResultMatrix computeElemForces(const Job &job, const ElemSoA &elems, const ResultMatrix &nodal_displacements,
+                                       unsigned int num_threads = 1);
+
+    /**
+     * @brief Computes the normal stresses at both ends of each element from its local end forces.
+     * @details At each end the axial stress is \f$N / A\f$ and the bending stresses are \f$M_y / S_y\f$ and
+     * \f$M_z / S_z\f$, where the axial force and moments are the internal forces of the element, i.e. the end
+     * forces of the first node with their sign flipped and the end forces of the second node. The last value is
+     * the sum of the magnitudes, the largest normal stress at the outer fibers of a doubly symmetric section.
+     *
+     * @param[in] elem_forces `fea::ElemResultMatrix`. Local end forces computed by `fea::computeElemForces`.
+     * @param[in] sections `std::vector<fea::SectionModuli>`. Section of each element, or a single section shared by
+     *                     all elements.
+     * @param[in] num_threads `unsigned int`. Number of threads computing the stresses, see `Options::num_threads`.
+     * @return Stresses, one row of `[axial, bending_y, bending_z, max]` at the first node followed by the same
+     * values at the second node per element. `fea::ElemStressMatrix`
+     */
+    ElemStressMatrix computeElemStresses(const ElemResultMatrix &elem_forces,
+                                         const std::vector<SectionModuli> &sections,
+                                         unsigned int num_threads = 1);
 
     /**
      * @brief Loads the prescribed forces into the force vector.
      *
      * @param force_vec `ForceVector`. Right hand side of the \f$[K][Q]=[F]\f$ equation of the FE analysis.
      * @param[in] forces std::vector<Force>. Vector of prescribed forces to apply to the current analysis.
+     * @param[in] load_case `unsigned int`. Column of `force_vec` that holds the load case of `forces`.
+     */
+    void loadForces(SparseMat &force_vec, const std::vector<Force> &forces, unsigned int load_case = 0);
+
+    /**
+     * @brief Block-Jacobi preconditioner with one dense block per node.
+     * @details The coefficients that couple the degrees of freedom of a node form a dense block on the diagonal of
+     * the stiffness matrix. Each block is inverted through its Cholesky factorization, so applying the
+     * preconditioner captures the coupling between the translations and rotations of a node. Blocks that are not
+     * positive definite, e.g. the zero diagonal of a Lagrange multiplier, fall back to the inverse of the magnitude
+     * of their diagonal, or the identity where the diagonal is zero, so the preconditioner stays positive definite.
+     * Only the upper triangle of each block is read, so it can be used with matrices that store one triangle.
+     * Meets the preconditioner interface of the Eigen iterative solvers.
+     */
+    class NodalBlockJacobiPreconditioner {
+    public:
+        typedef Eigen::Matrix<double, DOF::NUM_DOFS, DOF::NUM_DOFS> Block;
+
+        /**
+         * @brief Default constructor
+         */
+        NodalBlockJacobiPreconditioner() : size(0), num_threads(1) { };
+
+        /**
+         * @brief Sets the index of the first unknown of each block.
+         * @details Must be called before `compute`. If no blocks were set, consecutive blocks of
+         * `DOF::NUM_DOFS` unknowns are used.
+         *
+         * @param[in] starts `std::vector<long>`. Increasing indices of the first unknown of each block, starting with 0.
+         *                   No block may have more than `DOF::NUM_DOFS` unknowns.
+         */
+        void setBlockStarts(const std::vector<long> &starts) {
+            block_starts = starts;
+        }
+
+        /**
+         * @brief Sets the number of threads inverting and applying the blocks.
+         *
+         * @param[in] threads `unsigned int`. Number of threads, see `Options::num_threads`.
+         */
+        void setNumThreads(unsigned int threads) {
+            num_threads = threads;
+        }
+
+        Eigen::Index rows() const { return size; }
+
+        Eigen::Index cols() const { return size; }
+
+        template<typename MatType>
+        NodalBlockJacobiPreconditioner &analyzePattern(const MatType &) {
+            return *this;
+        }
+
+        template<typename MatType>
+        NodalBlockJacobiPreconditioner &factorize(const MatType &mat) {
+            size = mat.cols();
+            starts = block_starts;
+            if (starts.empty()) {
+                for (long i = 0; i < size; i += DOF::NUM_DOFS) {
+                    starts.push_back(i);
+                }
+            }
+            starts.push_back(size);
+
+            // gather the upper triangle of each block and mirror it
+            std::vector<Block, Eigen::aligned_allocator<Block> > blocks(starts.size() - 1, Block::Zero());
+            for (size_t b = 0; b + 1 < starts.size(); ++b) {
+                for (long j = starts[b]; j < starts[b + 1]; ++j) {
+                    for (typename MatType::InnerIterator it(mat, j); it; ++it) {
+                        if (it.index() >= starts[b] && it.index() <= j) {
+                            blocks[b](it.index() - starts[b], j - starts[b]) = it.value();
+                            blocks[b](j - starts[b], it.index() - starts[b]) = it.value();
+                        }
+                    }
+                }
+            }
+
+            inv_blocks.resize(blocks.size());
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+            for (long b = 0; b < static_cast<long>(blocks.size()); ++b) {
+                const long n = starts[b + 1] - starts[b];
+                inv_blocks[b].setZero();
+                Eigen::LLT<Eigen::MatrixXd> llt(blocks[b].topLeftCorner(n, n));
+                if (llt.info() == Eigen::Success) {
+                    inv_blocks[b].topLeftCorner(n, n) = llt.solve(Eigen::MatrixXd::Identity(n, n));
+                }
+                else {
+                    for (long i = 0; i < n; ++i) {
+                        const double d = std::abs(blocks[b](i, i));
+                        inv_blocks[b](i, i) = d > 0.0 ? 1.0 / d : 1.0;
+                    }
+                }
+            }
+            return *this;
+        }
+
+        template<typename MatType>
+        NodalBlockJacobiPreconditioner &compute(const MatType &mat) {
+            return factorize(mat);
+        }
+
+        /**
+         * @brief Applies the inverse of the block diagonal to `b`.
+         */
+        template<typename Rhs>
+        Eigen::VectorXd solve(const Eigen::MatrixBase<Rhs> &b) const {
+            Eigen::VectorXd x(size);
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+            for (long i = 0; i < static_cast<long>(inv_blocks.size()); ++i) {
+                const long n = starts[i + 1] - starts[i];
+                x.segment(starts[i], n) = inv_blocks[i].topLeftCorner(n, n) * b.segment(starts[i], n);
+            }
+            return x;
+        }
+
+        Eigen::ComputationInfo info() { return Eigen::Success; }
+
+    private:
+        Eigen::Index size;/**<Number of unknowns.*/
+        std::vector<long> block_starts;/**<Block starts set by the user.*/
+        unsigned int num_threads;/**<Number of threads set by the user.*/
+        std::vector<long> starts;/**<Block starts of the current matrix followed by its size.*/
+        std::vector<Block, Eigen::aligned_allocator<Block> > inv_blocks;/**<Inverse of each block.*/
+    };
+
+    /**
+     * @brief Computes the position of each unknown in the linear system with the prescribed degrees of freedom removed.
+     * @details The unknowns that are not prescribed keep their relative order.
+     *
+     * @param[in] BCs `std::vector<fea::BC>`. Vector of boundary conditions of the current analysis.
+     * @param[in] size `unsigned long`. Number of unknowns in the system before the elimination.
+     * @return Reduced indices. `std::vector<long>`. Index of each unknown in the reduced system or `-1` if it is
+     *         prescribed by a boundary condition.
+     */
+    std::vector<long> computeReducedIndices(const std::vector<BC> &BCs, unsigned long size);
+
+    /**
+     * @brief Removes the degrees of freedom prescribed by boundary conditions from the linear system.
+     * @details The columns of the prescribed degrees of freedom multiplied by the prescribed values are moved to the
+     * right hand side, and their rows and columns are removed. Unlike `loadBCs` this keeps the system small and,
+     * without equation constraints, symmetric positive definite. The reaction forces can be recovered from the
+     * unreduced system once the remaining unknowns are known.
+     *
+     * @param[in] Kg `fea::SparseMat`. Compressed coefficient matrix without boundary conditions. Only the upper
+     *                                 triangle is read if `upper_only` is set.
+     * @param[in] force_vec `fea::SparseMat`. Right hand side of the system before the elimination. Each column
+     *                                        holds one load case.
+     * @param[in] BCs `std::vector<fea::BC>`. Vector of `BC`'s to apply to the current analysis.
+     * @param[in] reduced_idx `std::vector<long>`. Indices returned by `computeReducedIndices`.
+     * @param[in] upper_only `bool`. Specifies if `Kg` only stores its upper triangle.
+     * @param Kr `fea::SparseMat`. Modified in place. Compressed coefficient matrix of the reduced system.
+     * @param fr `fea::SparseMat`. Modified in place. Right hand side of the reduced system with one column per
+     *                             load case.
+     */
+    void eliminateBCs(const SparseMat &Kg,
+                      const SparseMat &force_vec,
+                      const std::vector<BC> &BCs,
+                      const std::vector<long> &reduced_idx,
+                      bool upper_only,
+                      SparseMat &Kr,
+                      SparseMat &fr);
+
+    /**
+     * @brief Maps the numbering of the nodes and elements of a job to an ordering with better locality.
+     */
+    struct Renumbering {
+        std::vector<unsigned int> node_index;/**<New index of each node in the input numbering.*/
+        std::vector<unsigned int> elem_order;/**<Input index of each element in the new order.*/
+    };
+
+    /**
+     * @brief Computes a new numbering of the nodes and elements.
+     * @details The nodes are ordered as requested and the elements are sorted by their smallest and then their
+     * largest renumbered node, so each element only touches nearby columns of the stiffness matrix.
+     *
+     * @param[in] job `fea::Job`. Contains the node, element, and property lists for the mesh.
+     * @param[in] ties `std::vector<fea::Tie>`. Ties that connect nodes in addition to the elements.
+     * @param[in] ordering `fea::NodeOrdering`. Requested ordering of the nodes. Must not be `ORIGINAL_ORDER`.
+     * @return Renumbering. `fea::Renumbering`.
+     */
+    Renumbering computeRenumbering(const Job &job, const std::vector<Tie> &ties, NodeOrdering ordering);
+
+    /**
+     * @brief Renumbers the nodes of a model and reorders its elements.
+     * @details The order of the boundary conditions, ties and equations is kept, only the node numbers they
+     * refer to are changed.
+     *
+     * @param[in] renumbering `fea::Renumbering`. Numbering computed by `computeRenumbering`.
+     * @param job `fea::Job`. Modified in place.
+     * @param BCs `std::vector<fea::BC>`. Modified in place.
+     * @param ties `std::vector<fea::Tie>`. Modified in place.
+     * @param equations `std::vector<fea::Equation>`. Modified in place.
+     */
+    void applyRenumbering(const Renumbering &renumbering,
+                          Job &job,
+                          std::vector<BC> &BCs,
+                          std::vector<Tie> &ties,
+                          std::vector<Equation> &equations);
+
+    /**
+     * @brief Renumbers the nodes that prescribed forces are applied to.
+     *
+     * @param[in] renumbering `fea::Renumbering`. Numbering computed by `computeRenumbering`.
+     * @param forces `std::vector<fea::Force>`. Modified in place.
+     */
+    void applyRenumbering(const Renumbering &renumbering, std::vector<Force> &forces);
+
+    /**
+     * @brief Interface of the linear solvers held by `fea::Analysis` between its phases. Defined in the source file.
      */
-    void loadForces(SparseMat &force_vec, const std::vector<Force> &forces);
+    class LinearSystemSolver;
+
+    /**
+     * @brief Finite element analysis that keeps the assembled system and its factorization between solves.
+     * @details The analysis is split into the phases of `fea::solve`:
+     * 1. `assemble` forms the global stiffness matrix and applies the boundary conditions and equations,
+     * 2. `analyzePattern` computes the ordering and symbolic factorization from the structure of the system,
+     * 3. `factorize` computes the numerical factorization, or the preconditioner of an iterative solver, and
+     * 4. `solve` solves the load cases against the factorization and computes the results.
+     *
+     * Each phase runs the phases it depends on if they are out of date, so calling `solve` alone performs the
+     * complete analysis. Changing the element properties with `setProps` only requires the system to be
+     * assembled and factorized again. The symbolic analysis is kept as long as the structure of the assembled
+     * system is unchanged. Solving additional load cases reuses the factorization.
+     *
+     * \note Iterative solvers keep a reference to the assembled system, so an `Analysis` cannot be copied.
+     */
+    class Analysis {
+    public:
+        /**
+         * @brief Constructor
+         * @details The model is only copied if it is renumbered, i.e. `Options::node_ordering` is not
+         * `ORIGINAL_ORDER`, or its properties are replaced with `setProps`. Otherwise the analysis refers to the
+         * given containers, which must outlive it. No phase is run until it is requested.
+         *
+         * @param[in] job `fea::Job`. Contains the node, element, and property lists for the mesh.
+         * @param[in] BCs `std::vector<fea::BC>`. Vector of boundary conditions shared by all load cases.
+         * @param[in] ties `std::vector<fea::Tie>`. Vector of ties that apply to attach springs of specified
+         *                                          stiffness to all nodal degrees of freedom between each set of
+         *                                          nodes indicated.
+         * @param[in] equations `std::vector<fea::Equation>`. Vector of equation constraints shared by all load cases.
+         * @param[in] options `fea::Options`. Options of the analysis.
+         */
+        Analysis(const Job &job,
+                 const std::vector<BC> &BCs,
+                 const std::vector<Tie> &ties,
+                 const std::vector<Equation> &equations,
+                 const Options &options);
+
+        ~Analysis();
+
+        Analysis(const Analysis &) = delete;
+
+        Analysis &operator=(const Analysis &) = delete;
+
+        /**
+         * @brief Replaces the properties of the elements.
+         * @details The system has to be assembled and factorized again before the next solve, but the symbolic
+         * analysis is reused if the structure of the system does not change.
+         *
+         * @param[in] props `std::vector<fea::Props>`. Properties of each element in the input order of the elements.
+         */
+        void setProps(const std::vector<Props> &props);
+
+        /**
+         * @brief Assembles the global stiffness matrix and applies the boundary conditions and equations.
+         */
+        void assemble();
+
+        /**
+         * @brief Computes the ordering and symbolic factorization of the assembled system.
+         * @details Assembles the system first if it is out of date.
+         */
+        void analyzePattern();
+
+        /**
+         * @brief Computes the numerical factorization of the assembled system.
+         * @details Runs the previous phases first if they are out of date. For iterative solvers the preconditioner
+         * is computed.
+         */
+        void factorize();
+
+        /**
+         * @brief Solves the load cases against the factorization of the system.
+         * @details Runs the previous phases first if they are out of date. If more than one load case is given, the
+         * files requested in the options get the suffix `_case<i>` before their extension, where `<i>` is the
+         * index of the load case. The total time of each summary covers the phases run by this call.
+         *
+         * @param[in] load_cases `std::vector< std::vector<fea::Force> >`. Prescribed forces of each load case.
+         * @return <B>Summaries</B> `std::vector<fea::Summary>`. Summary containing the results of each load case.
+         */
+        std::vector<Summary> solve(const std::vector<std::vector<Force> > &load_cases);
+
+        /**
+         * @brief Solves a single load case against the factorization of the system.
+         *
+         * @param[in] forces `std::vector<fea::Force>`. Prescribed forces of the load case.
+         * @return <B>Summary</B> `fea::Summary`. Summary containing the results of the analysis.
+         */
+        Summary solve(const std::vector<Force> &forces);
+
+        /**
+         * @brief Computes the nodal forces from the nodal displacements of a summary returned by `solve`.
+         * @details Recovers the nodal forces on demand if they were skipped during the solve because
+         * `Options::compute_nodal_forces` was `false`. The displacements are the rounded values of the summary, so
+         * the forces may differ from the ones computed during the solve by the effect of `Options::epsilon`.
+         * Tie forces can be recovered in the same way with `fea::computeTieForces`. Throws if the properties were
+         * changed since the last solve.
+         *
+         * @param[in] summary `fea::Summary`. Summary of a load case returned by the last call to `solve`.
+         * @return Nodal forces in the input numbering. `fea::ResultMatrix`
+         */
+        ResultMatrix computeNodalForces(const Summary &summary) const;
+
+        /**
+         * @brief Returns the coefficient matrix of the assembled linear system.
+         * @details Does not include the prescribed degrees of freedom if `Options::eliminate_bcs` is set. Only the
+         * upper triangle is stored if `storesUpperTriangle(options)` holds. The nodes are numbered as requested by
+         * `Options::node_ordering`.
+         */
+        const SparseMat &getSystemMatrix() const { return options.eliminate_bcs ? Kr : Kg; };
+
+    private:
+        Renumbering renumbering;/**<Internal numbering of the nodes and elements. Empty if the input order is used.*/
+        Job job_copy;/**<Copy of the job if it is renumbered or its properties are replaced.*/
+        std::vector<BC> BCs_copy;/**<Copy of the boundary conditions if the model is renumbered.*/
+        std::vector<Tie> ties_copy;/**<Copy of the ties if the model is renumbered.*/
+        std::vector<Equation> equations_copy;/**<Copy of the equations if the model is renumbered.*/
+        const Job *job;/**<Model of the analysis with the current element properties in the internal numbering.*/
+        const std::vector<BC> *BCs;/**<Boundary conditions shared by all load cases.*/
+        const std::vector<Tie> *ties;/**<Ties of the model.*/
+        const std::vector<Equation> *equations;/**<Equation constraints shared by all load cases.*/
+        Options options;/**<Options of the analysis.*/
+        bool upper_only;/**<Specifies if only the upper triangle of the system is stored.*/
+        unsigned long size;/**<Number of unknowns before boundary conditions are eliminated.*/
+        std::vector<long> system_idx;/**<Index of each unknown in the solved system or `-1` if it was eliminated.*/
+        SparsityPattern pattern;/**<Pattern of the element and tie stiffness if `options.use_sparsity_pattern` is set.*/
+        SparseMat Kg;/**<Coefficient matrix including the prescribed degrees of freedom.*/
+        SparseMat Kr;/**<Coefficient matrix with the prescribed degrees of freedom eliminated.*/
+        Eigen::VectorXd base_rhs;/**<Right hand side of the solved system without any prescribed forces.*/
+        std::unique_ptr<LinearSystemSolver> solver;/**<Solver holding the symbolic analysis and factorization.*/
+        Summary phase_summary;/**<Model parameters and the times of the latest run of each phase.*/
+        bool is_assembled;/**<Specifies if the system is up to date with the element properties.*/
+        bool is_analyzed;/**<Specifies if the symbolic analysis is up to date with the structure of the system.*/
+        bool is_factorized;/**<Specifies if the factorization is up to date with the system.*/
+    };
 
     /**
      * @brief Solves the finite element analysis defined by the input Job, boundary conditions, and prescribed nodal forces.
@@ -232,6 +1073,29 @@ namespace fea {
                   const std::vector<Tie> &ties,
                   const std::vector<Equation> &equations,
                   const Options &options);
+    /**
+     * @brief Solves the finite element analysis for several load cases with a single factorization.
+     * @details The force vectors of all load cases form the columns of one right hand side, so the global stiffness
+     * matrix is assembled and factorized once and the factors are reused for every load case. If more than one
+     * load case is given, the files requested in `options` get the suffix `_case<i>` before their extension, where
+     * `<i>` is the index of the load case.
+     *
+     * @param[in] job `fea::Job`. Contains the node, element, and property lists for the mesh.
+     * @param[in] BCs `std::vector<fea::BC>`. Vector of boundary conditions shared by all load cases.
+     * @param[in] load_cases `std::vector< std::vector<fea::Force> >`. Prescribed forces of each load case.
+     * @param[in] ties `std::vector<fea::Tie>`. Vector of ties that apply to attach springs of specified stiffness to
+     *                                          all nodal degrees of freedom between each set of nodes indicated.
+     * @param[in] equations `std::vector<fea::Equation>`. Vector of equation constraints shared by all load cases.
+     * @param[in] options `fea::Options`. Options of the analysis.
+     *
+     * @return <B>Summaries</B> `std::vector<fea::Summary>`. Summary containing the results of each load case.
+     */
+    std::vector<Summary> solve(const Job &job,
+                               const std::vector<BC> &BCs,
+                               const std::vector<std::vector<Force> > &load_cases,
+                               const std::vector<Tie> &ties,
+                               const std::vector<Equation> &equations,
+                               const Options &options);
 } // namespace fea
 
 #endif // THREED_BEAM_FEA_H
@@ -28,38 +28,22 @@
 #include "threed_beam_fea.h"
 #include "setup.h"
 
-fea::Summary runAnalysis(const rapidjson::Document &config_doc) {
-    fea::Job job = fea::createJobFromJSON(config_doc);
-
-    std::vector<fea::Tie> ties;
-    if (config_doc.HasMember("ties")) {
-        ties = fea::createTieVecFromJSON(config_doc);
-    }
-
-    std::vector<fea::BC> bcs;
-    if (config_doc.HasMember("bcs")) {
-        bcs = fea::createBCVecFromJSON(config_doc);
-    }
-
-    std::vector<fea::Force> forces;
-    if (config_doc.HasMember("forces")) {
-        forces = fea::createForceVecFromJSON(config_doc);
+std::vector<fea::Summary> runAnalysis(const fea::Model &model) {
+    if (model.options.verbose) {
+        for (size_t i = 0; i < model.input_load_times.size(); ++i) {
+            const fea::InputLoadTime &input = model.input_load_times[i];
+            std::cout << "Loaded " << input.variable << " from " << input.filename
+            << " in " << input.load_time_in_ms << " ms." << std::endl;
+        }
     }
-
-    std::vector<fea::Equation> equations;
-    if (config_doc.HasMember("equations")) {
-        equations = fea::createEquationVecFromJSON(config_doc);
-    }
-
-    fea::Options options = fea::createOptionsFromJSON(config_doc);
-
-    return fea::solve(job, bcs, forces, ties, equations, options);
+    return fea::solve(model.job, model.bcs, model.load_cases, model.ties, model.equations, model.options);
 }
 
 int main(int argc, char *argv[]) {
     try {
         TCLAP::CmdLine cmd("3D Euler-Bernoulli beam element FEA. "
-                                   "Use the -c [--config] flag to point to the configuration file for the current analysis.",
+                                   "Use the -c [--config] flag to point to the configuration file for the current analysis, "
+                                   "or the -m [--model] flag to point to a binary model file.",
                            ' ', "1.0");
         TCLAP::ValueArg<std::string> configArg("c",
                                                "config",
@@ -75,12 +59,25 @@ int main(int argc, char *argv[]) {
                                                true,
                                                "config.json",
                                                "string");
-        cmd.add(configArg);
+        TCLAP::ValueArg<std::string> modelArg("m",
+                                              "model",
+                                              "Binary model file created from a configuration file with fea_convert. "
+                                                      "The model is memory mapped instead of parsing the csv files "
+                                                      "again. Files of either kind are recognized by their contents.",
+                                              true,
+                                              "model.feab",
+                                              "string");
+        cmd.xorAdd(configArg, modelArg);
         cmd.parse(argc, argv);
-        std::string config_filename = configArg.getValue();
-        rapidjson::Document config_doc = fea::parseJSONConfig(config_filename);
 
-        runAnalysis(config_doc);
+        // the format is detected from the contents, so either flag accepts both kinds of file
+        const std::string &filename = modelArg.isSet() ? modelArg.getValue() : configArg.getValue();
+        if (fea::isModelFile(filename)) {
+            runAnalysis(fea::readModelFile(filename));
+        }
+        else {
+            runAnalysis(fea::createModelFromJSONFile(filename));
+        }
     }
     catch (TCLAP::ArgException &e)  // catch any exceptions from parsing
     {
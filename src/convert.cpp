@@ -0,0 +1,66 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <tclap/CmdLine.h>
+#include <rapidjson/document.h>
+#include "setup.h"
+
+int main(int argc, char *argv[]) {
+    try {
+        TCLAP::CmdLine cmd("Converts the configuration file of an analysis and the csv files it points to into a "
+                                   "single binary model file that fea_cmd can load with the -m [--model] flag.",
+                           ' ', "1.0");
+        TCLAP::ValueArg<std::string> configArg("c",
+                                               "config",
+                                               "Finite element configuration file (json format). Must have "
+                                                       "\"nodes\", \"elems\", and \"props\" members pointing the "
+                                                       "associated files. The \"bcs\", \"forces\", \"ties\", "
+                                                       "\"equations\" and \"options\" members are optional.",
+                                               true,
+                                               "config.json",
+                                               "string");
+        TCLAP::ValueArg<std::string> outputArg("o",
+                                               "output",
+                                               "The binary model file to write.",
+                                               true,
+                                               "model.feab",
+                                               "string");
+        cmd.add(configArg);
+        cmd.add(outputArg);
+        cmd.parse(argc, argv);
+
+        fea::convertJSONFileToModelFile(configArg.getValue(), outputArg.getValue());
+    }
+    catch (TCLAP::ArgException &e)  // catch any exceptions from parsing
+    {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        return 1;
+    }
+    catch (std::exception &e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,363 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csv_parser.h"
+
+namespace fea {
+
+    namespace {
+        // Smallest number of bytes parsed by a thread.
+        const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+        // Powers of ten that are exactly representable as doubles.
+        const double EXACT_POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+                                              1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        // Largest precision written without std::snprintf. 10^precision must stay below 2^53.
+        const unsigned int MAX_EXACT_PRECISION = 15;
+
+        // Number of chunks formatted per thread before they are written.
+        const size_t WRITE_CHUNKS_PER_THREAD = 4;
+
+        // Two digit strings of the numbers 0 to 99.
+        const char DIGIT_PAIRS[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+
+        // Appends the decimal digits of value, padded with zeros to at least min_digits digits.
+        void appendDigits(std::string &out, uint64_t value, unsigned int min_digits) {
+            char digits[24];
+            int pos = sizeof(digits);
+            while (value >= 100) {
+                const unsigned int pair = static_cast<unsigned int>(value % 100);
+                value /= 100;
+                pos -= 2;
+                std::memcpy(digits + pos, DIGIT_PAIRS + 2 * pair, 2);
+            }
+            if (value >= 10) {
+                pos -= 2;
+                std::memcpy(digits + pos, DIGIT_PAIRS + 2 * value, 2);
+            }
+            else {
+                digits[--pos] = static_cast<char>('0' + value);
+            }
+            while (sizeof(digits) - pos < min_digits) {
+                digits[--pos] = '0';
+            }
+            out.append(digits + pos, sizeof(digits) - pos);
+        }
+
+        inline bool isSeparator(char c) {
+            return c == ',' || c == ' ' || c == '\t';
+        }
+
+        inline bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        // Parses the value with std::strtod, which needs a null-terminated copy.
+        double parseValueWithStrtod(const char *begin, const char *end) {
+            const size_t length = end - begin;
+            char buffer[64];
+            if (length < sizeof(buffer)) {
+                std::memcpy(buffer, begin, length);
+                buffer[length] = '\0';
+                return std::strtod(buffer, 0);
+            }
+            return std::strtod(std::string(begin, end).c_str(), 0);
+        }
+    }
+
+    MappedFile::MappedFile(const std::string &filename) : begin(0), length(0), is_mapped(false) {
+#ifdef _WIN32
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s") % filename).str()
+            );
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        begin = buffer.data();
+        length = buffer.size();
+#else
+        const int fd = open(filename.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if (fd < 0 || fstat(fd, &file_stat) != 0) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s") % filename).str()
+            );
+        }
+
+        length = file_stat.st_size;
+        if (length > 0) {
+            void *address = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, length, MADV_SEQUENTIAL);
+                begin = static_cast<const char *>(address);
+                is_mapped = true;
+            }
+            else {
+                // fall back to reading the file, e.g. for pipes
+                buffer.resize(length);
+                size_t num_read = 0;
+                while (num_read < length) {
+                    const ssize_t n = read(fd, buffer.data() + num_read, length - num_read);
+                    if (n <= 0) {
+                        break;
+                    }
+                    num_read += n;
+                }
+                buffer.resize(num_read);
+                begin = buffer.data();
+                length = num_read;
+            }
+        }
+        close(fd);
+#endif
+    };
+
+    MappedFile::~MappedFile() {
+#ifndef _WIN32
+        if (is_mapped) {
+            munmap(const_cast<char *>(begin), length);
+        }
+#endif
+    };
+
+    std::vector<const char *> CSVParser::splitIntoChunks(const char *begin, const char *end) {
+        size_t num_threads = 1;
+#ifdef _OPENMP
+        num_threads = omp_get_max_threads();
+#endif
+        const size_t size = end - begin;
+        const size_t num_chunks = std::max<size_t>(1, std::min(num_threads, size / MIN_CHUNK_SIZE));
+
+        // move each boundary to the start of the next line
+        std::vector<const char *> chunks(1, begin);
+        for (size_t i = 1; i < num_chunks; ++i) {
+            const char *pos = std::max(begin + i * (size / num_chunks), chunks.back());
+            const void *newline = std::memchr(pos, '\n', end - pos);
+            if (!newline) {
+                break;
+            }
+            pos = static_cast<const char *>(newline) + 1;
+            if (pos > chunks.back() && pos < end) {
+                chunks.push_back(pos);
+            }
+        }
+        chunks.push_back(end);
+        return chunks;
+    };
+
+    size_t CSVParser::countRows(const char *begin, const char *end) {
+        size_t num_rows = 0;
+        for (const char *pos = begin; pos < end; ++num_rows) {
+            const void *newline = std::memchr(pos, '\n', end - pos);
+            if (!newline) {
+                return num_rows + 1;
+            }
+            pos = static_cast<const char *>(newline) + 1;
+        }
+        return num_rows;
+    };
+
+    const char *CSVParser::parseLine(const char *begin, const char *end, std::vector<double> &values) {
+        values.clear();
+
+        const void *newline = std::memchr(begin, '\n', end - begin);
+        const char *line_end = newline ? static_cast<const char *>(newline) : end;
+        const char *next = newline ? line_end + 1 : end;
+
+        // ignore the carriage return of Windows line endings
+        if (line_end > begin && line_end[-1] == '\r') {
+            --line_end;
+        }
+        if (line_end == begin) {
+            return next;
+        }
+
+        const char *field = begin;
+        for (const char *pos = begin; pos <= line_end; ++pos) {
+            if (pos == line_end || isSeparator(*pos)) {
+                values.push_back(parseValue(field, pos));
+                field = pos + 1;
+            }
+        }
+        return next;
+    };
+
+    double CSVParser::parseValue(const char *begin, const char *end) {
+        const char *pos = begin;
+        const bool negative = pos < end && *pos == '-';
+        if (pos < end && (*pos == '-' || *pos == '+')) {
+            ++pos;
+        }
+
+        // accumulate up to 19 significant digits, which fit into 64 bits
+        uint64_t mantissa = 0;
+        int num_digits = 0;
+        int exponent = 0;
+        bool has_digits = false;
+        for (; pos < end && isDigit(*pos); ++pos) {
+            if (num_digits >= 19) {
+                return parseValueWithStrtod(begin, end);
+            }
+            mantissa = 10 * mantissa + (*pos - '0');
+            num_digits += mantissa != 0;
+            has_digits = true;
+        }
+        if (pos < end && *pos == '.') {
+            for (++pos; pos < end && isDigit(*pos); ++pos) {
+                if (num_digits >= 19) {
+                    return parseValueWithStrtod(begin, end);
+                }
+                mantissa = 10 * mantissa + (*pos - '0');
+                num_digits += mantissa != 0;
+                --exponent;
+                has_digits = true;
+            }
+        }
+        if (!has_digits) {
+            // empty values are 0, anything else, e.g. inf or hexadecimal numbers, is left to strtod
+            return begin == end ? 0.0 : parseValueWithStrtod(begin, end);
+        }
+
+        if (pos < end && (*pos == 'e' || *pos == 'E')) {
+            const char *exponent_pos = pos + 1;
+            const bool negative_exponent = exponent_pos < end && *exponent_pos == '-';
+            if (exponent_pos < end && (*exponent_pos == '-' || *exponent_pos == '+')) {
+                ++exponent_pos;
+            }
+            if (exponent_pos == end || !isDigit(*exponent_pos)) {
+                return parseValueWithStrtod(begin, end);
+            }
+            int explicit_exponent = 0;
+            for (; exponent_pos < end && isDigit(*exponent_pos); ++exponent_pos) {
+                if (explicit_exponent > 10000) {
+                    return parseValueWithStrtod(begin, end);
+                }
+                explicit_exponent = 10 * explicit_exponent + (*exponent_pos - '0');
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+            pos = exponent_pos;
+        }
+        if (pos != end) {
+            // trailing characters are ignored by strtod
+            return parseValueWithStrtod(begin, end);
+        }
+
+        // the result is correctly rounded if the mantissa and the power of ten are exact (Clinger, 1990)
+        if (mantissa == 0) {
+            return negative ? -0.0 : 0.0;
+        }
+        if (mantissa > (uint64_t(1) << 53) || exponent < -22 || exponent > 22) {
+            return parseValueWithStrtod(begin, end);
+        }
+        double value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / EXACT_POWERS_OF_TEN[-exponent] : value * EXACT_POWERS_OF_TEN[exponent];
+        return negative ? -value : value;
+    };
+
+    size_t CSVParser::numWriteChunks(int max_threads) {
+        return WRITE_CHUNKS_PER_THREAD * std::max(max_threads, 1);
+    };
+
+    void CSVParser::appendValue(std::string &out, double value, unsigned int precision) {
+        // 2^52, below which the integer and fractional parts of a double are exact
+        const double max_exact_value = 4503599627370496.0;
+        const double magnitude = std::abs(value);
+        if (!(magnitude < max_exact_value) || precision > MAX_EXACT_PRECISION) {
+            char buffer[512];
+            const int length = std::snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(precision), value);
+            if (length >= 0 && static_cast<size_t>(length) < sizeof(buffer)) {
+                out.append(buffer, length);
+            }
+            else {
+                std::vector<char> large_buffer(length + 1);
+                std::snprintf(large_buffer.data(), large_buffer.size(), "%.*f", static_cast<int>(precision), value);
+                out.append(large_buffer.data(), length);
+            }
+            return;
+        }
+
+        // Split the value into its integer part and the fractional part scaled by 10^precision. The product is
+        // rounded, but fma recovers its exact error, which decides the cases where the rounded product sits on a
+        // tie between two decimal values.
+        const double scale = EXACT_POWERS_OF_TEN[precision];
+        uint64_t int_part = static_cast<uint64_t>(magnitude);
+        const double fraction = magnitude - static_cast<double>(int_part);
+        const double scaled = fraction * scale;
+        const double error = std::fma(fraction, scale, -scaled);
+        uint64_t frac_part = static_cast<uint64_t>(scaled);
+        const double remainder = scaled - static_cast<double>(frac_part);
+
+        // ties round to an even last digit, like printf
+        const bool odd = ((precision == 0 ? int_part : frac_part) & 1) != 0;
+        if (remainder > 0.5 || (remainder == 0.5 && (error > 0 || (error == 0 && odd)))) {
+            ++frac_part;
+        }
+        if (precision == 0) {
+            int_part += frac_part;
+            frac_part = 0;
+        }
+        else if (static_cast<double>(frac_part) == scale) {
+            ++int_part;
+            frac_part = 0;
+        }
+
+        if (std::signbit(value)) {
+            out += '-';
+        }
+        appendDigits(out, int_part, 1);
+        if (precision > 0) {
+            out += '.';
+            appendDigits(out, frac_part, precision);
+        }
+    };
+
+} // namespace fea
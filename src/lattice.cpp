@@ -0,0 +1,362 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include "boost/format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "lattice.h"
+
+namespace fea {
+
+    namespace {
+        // tolerance used to compare fractional coordinates and lengths
+        const double LATTICE_TOL = 1e-9;
+
+        // Number of boundary classes of a cell. A cell at the upper end of the box along an axis only keeps the
+        // nodes whose fractional coordinate along that axis is 0.
+        const int NUM_BOUNDARY_CLASSES = 8;
+
+        // Returns the boundary class of the cell with indices ijk in a box of num_cells cells.
+        int boundaryClass(const Eigen::Vector3i &ijk, const Eigen::Vector3i &num_cells) {
+            return (ijk(0) == num_cells(0) ? 1 : 0)
+                   | (ijk(1) == num_cells(1) ? 2 : 0)
+                   | (ijk(2) == num_cells(2) ? 4 : 0);
+        }
+
+        // Cells of a tiled lattice indexed over one extra layer along each axis, which holds the nodes on the upper
+        // faces of the box.
+        struct CellGrid {
+            Eigen::Vector3i num_cells;
+            Eigen::Vector3i extent;
+
+            // rank[c][n] is the position of node n among the nodes kept by a cell of boundary class c, or -1.
+            std::vector<std::vector<int> > rank;
+
+            CellGrid(const UnitCell &cell, const Eigen::Vector3i &_num_cells)
+                    : num_cells(_num_cells), extent(_num_cells + Eigen::Vector3i::Ones()),
+                      rank(NUM_BOUNDARY_CLASSES, std::vector<int>(cell.nodes.size(), -1)) {
+                for (int c = 0; c < NUM_BOUNDARY_CLASSES; ++c) {
+                    int num_kept = 0;
+                    for (size_t n = 0; n < cell.nodes.size(); ++n) {
+                        bool keep = true;
+                        for (int axis = 0; axis < 3; ++axis) {
+                            if ((c & (1 << axis)) && cell.nodes[n](axis) > LATTICE_TOL) {
+                                keep = false;
+                            }
+                        }
+                        if (keep) {
+                            rank[c][n] = num_kept++;
+                        }
+                    }
+                }
+            }
+
+            long size() const {
+                return static_cast<long>(extent(0)) * extent(1) * extent(2);
+            }
+
+            Eigen::Vector3i indices(long cell_index) const {
+                return Eigen::Vector3i(cell_index % extent(0),
+                                       (cell_index / extent(0)) % extent(1),
+                                       cell_index / (static_cast<long>(extent(0)) * extent(1)));
+            }
+
+            long index(const Eigen::Vector3i &ijk) const {
+                return ijk(0) + extent(0) * (ijk(1) + static_cast<long>(extent(1)) * ijk(2));
+            }
+
+            const std::vector<int> &ranks(const Eigen::Vector3i &ijk) const {
+                return rank[boundaryClass(ijk, num_cells)];
+            }
+
+            // Returns the index of the cell of the strut's second node, or -1 if the strut is not kept.
+            long strutNeighbor(const Eigen::Vector3i &ijk, const UnitCell::Strut &strut) const {
+                const Eigen::Vector3i other = ijk + strut.offset;
+                if ((other.array() < 0).any() || (other.array() > num_cells.array()).any()
+                    || ranks(ijk)[strut.node_1] < 0 || ranks(other)[strut.node_2] < 0) {
+                    return -1;
+                }
+                return index(other);
+            }
+        };
+
+        // Returns a unit vector perpendicular to the unit vector dir.
+        Eigen::Vector3d perpendicularTo(const Eigen::Vector3d &dir) {
+            Eigen::Vector3d::Index axis;
+            dir.cwiseAbs().minCoeff(&axis);
+            Eigen::Vector3d normal = Eigen::Vector3d::Unit(axis) - dir(axis) * dir;
+            return normal.normalized();
+        }
+    }
+
+    UnitCell createUnitCell(UnitCellType type) {
+        std::vector<Eigen::Vector3d> nodes;
+
+        switch (type) {
+            case CUBIC_CELL:
+                nodes.push_back(Eigen::Vector3d(0, 0, 0));
+                return createUnitCell(nodes, 1.0);
+            case OCTET_CELL:
+                nodes.push_back(Eigen::Vector3d(0, 0, 0));
+                nodes.push_back(Eigen::Vector3d(0.5, 0.5, 0));
+                nodes.push_back(Eigen::Vector3d(0.5, 0, 0.5));
+                nodes.push_back(Eigen::Vector3d(0, 0.5, 0.5));
+                return createUnitCell(nodes, std::sqrt(2.0) / 2.0);
+            case KELVIN_CELL: {
+                // the vertices of the truncated octahedra are the permutations of (0, +-1/4, 1/2) wrapped into the cell
+                const double quarters[2] = {0.25, 0.75};
+                for (int q = 0; q < 2; ++q) {
+                    Eigen::Vector3d vertex(0, quarters[q], 0.5);
+                    std::sort(vertex.data(), vertex.data() + 3);
+                    do {
+                        nodes.push_back(vertex);
+                    } while (std::next_permutation(vertex.data(), vertex.data() + 3));
+                }
+                return createUnitCell(nodes, std::sqrt(2.0) / 4.0);
+            }
+            default:
+                throw std::runtime_error("Unknown unit cell type.");
+        }
+    }
+
+    UnitCell createUnitCell(const std::vector<Eigen::Vector3d> &nodes, double strut_length) {
+        if (nodes.empty()) {
+            throw std::runtime_error("A unit cell must contain at least one node.");
+        }
+
+        // struts no longer than a cell only reach the neighboring cells
+        if (!(strut_length > 0) || strut_length > 1.0) {
+            throw std::runtime_error(
+                    (boost::format("The strut length of a unit cell must be in (0, 1], not %f.") % strut_length).str()
+            );
+        }
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if ((nodes[i].array() < 0).any() || (nodes[i].array() >= 1).any()) {
+                throw std::runtime_error(
+                        (boost::format("The fractional coordinates of node %d of the unit cell must be in [0, 1).")
+                         % i).str()
+                );
+            }
+        }
+
+        UnitCell cell;
+        cell.nodes = nodes;
+
+        const unsigned int num_nodes = nodes.size();
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const Eigen::Vector3i offset(dx, dy, dz);
+
+                    // each strut is found from both of its ends, keep the one with the positive offset
+                    const bool positive_offset = dx > 0 || (dx == 0 && (dy > 0 || (dy == 0 && dz > 0)));
+                    const bool zero_offset = dx == 0 && dy == 0 && dz == 0;
+
+                    for (unsigned int a = 0; a < num_nodes; ++a) {
+                        for (unsigned int b = 0; b < num_nodes; ++b) {
+                            if (!positive_offset && !(zero_offset && b > a)) {
+                                continue;
+                            }
+                            const double length = (nodes[b] + offset.cast<double>() - nodes[a]).norm();
+                            if (std::abs(length - strut_length) <= LATTICE_TOL * strut_length) {
+                                cell.struts.push_back(UnitCell::Strut(a, b, offset));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return cell;
+    }
+
+    Job createLatticeJob(const UnitCell &cell,
+                         const Eigen::Vector3i &num_cells,
+                         const Eigen::Vector3d &cell_size,
+                         const Props &section) {
+        if ((num_cells.array() < 1).any()) {
+            throw std::runtime_error("The number of cells of a lattice must be positive along each axis.");
+        }
+
+        if (!(cell_size.array() > 0).all()) {
+            throw std::runtime_error("The cell size of a lattice must be positive along each axis.");
+        }
+
+        const unsigned int num_cell_nodes = cell.nodes.size();
+        const unsigned int num_cell_struts = cell.struts.size();
+
+        for (unsigned int s = 0; s < num_cell_struts; ++s) {
+            const UnitCell::Strut &strut = cell.struts[s];
+            if (strut.node_1 >= num_cell_nodes || strut.node_2 >= num_cell_nodes) {
+                throw std::runtime_error(
+                        (boost::format("Strut %d of the unit cell references a node that does not exist.") % s).str()
+                );
+            }
+        }
+
+        const CellGrid grid(cell, num_cells);
+        const long num_ext_cells = grid.size();
+
+        // offsets of the first node and element of each cell
+        std::vector<size_t> node_offsets(num_ext_cells + 1);
+        std::vector<size_t> elem_offsets(num_ext_cells + 1);
+
+#pragma omp parallel for
+        for (long i = 0; i < num_ext_cells; ++i) {
+            const Eigen::Vector3i ijk = grid.indices(i);
+            const std::vector<int> &cell_rank = grid.ranks(ijk);
+            node_offsets[i + 1] = num_cell_nodes - std::count(cell_rank.begin(), cell_rank.end(), -1);
+
+            size_t num_struts = 0;
+            for (unsigned int s = 0; s < num_cell_struts; ++s) {
+                if (grid.strutNeighbor(ijk, cell.struts[s]) >= 0) {
+                    ++num_struts;
+                }
+            }
+            elem_offsets[i + 1] = num_struts;
+        }
+
+        node_offsets[0] = 0;
+        elem_offsets[0] = 0;
+        for (long i = 0; i < num_ext_cells; ++i) {
+            node_offsets[i + 1] += node_offsets[i];
+            elem_offsets[i + 1] += elem_offsets[i];
+        }
+
+        const size_t num_nodes = node_offsets[num_ext_cells];
+        const size_t num_elems = elem_offsets[num_ext_cells];
+        if (num_nodes > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error(
+                    (boost::format("A lattice of %d nodes exceeds the maximum node index.") % num_nodes).str()
+            );
+        }
+
+        Job job;
+        job.nodes.resize(num_nodes);
+        job.elems.resize(num_elems);
+        job.prop_ids.resize(num_elems);
+
+#pragma omp parallel for
+        for (long i = 0; i < num_ext_cells; ++i) {
+            const Eigen::Vector3i ijk = grid.indices(i);
+            const std::vector<int> &cell_rank = grid.ranks(ijk);
+            const Eigen::Vector3d origin = ijk.cast<double>();
+
+            for (unsigned int n = 0; n < num_cell_nodes; ++n) {
+                if (cell_rank[n] >= 0) {
+                    job.nodes[node_offsets[i] + cell_rank[n]] = (origin + cell.nodes[n]).cwiseProduct(cell_size);
+                }
+            }
+
+            size_t elem = elem_offsets[i];
+            for (unsigned int s = 0; s < num_cell_struts; ++s) {
+                const UnitCell::Strut &strut = cell.struts[s];
+                const long other = grid.strutNeighbor(ijk, strut);
+                if (other >= 0) {
+                    const int other_rank = grid.ranks(grid.indices(other))[strut.node_2];
+                    job.elems[elem] << node_offsets[i] + cell_rank[strut.node_1], node_offsets[other] + other_rank;
+                    job.prop_ids[elem] = s;
+                    ++elem;
+                }
+            }
+        }
+
+        // one table entry per strut of the unit cell with a normal vector perpendicular to the strut
+        job.props.resize(num_cell_struts, section);
+        for (unsigned int s = 0; s < num_cell_struts; ++s) {
+            const UnitCell::Strut &strut = cell.struts[s];
+            const Eigen::Vector3d dir = (cell.nodes[strut.node_2] + strut.offset.cast<double>()
+                                         - cell.nodes[strut.node_1]).cwiseProduct(cell_size);
+            if (dir.norm() <= LATTICE_TOL * cell_size.norm()) {
+                throw std::runtime_error(
+                        (boost::format("Strut %d of the unit cell has zero length.") % s).str()
+                );
+            }
+            job.props[s].normal_vec = perpendicularTo(dir.normalized());
+        }
+
+        return job;
+    }
+
+    std::vector<unsigned int> findFaceNodes(const Job &job, BoxFace face) {
+        std::vector<unsigned int> face_nodes;
+        if (job.nodes.empty()) {
+            return face_nodes;
+        }
+
+        Eigen::Vector3d min_coords = job.nodes[0];
+        Eigen::Vector3d max_coords = job.nodes[0];
+        for (size_t i = 1; i < job.nodes.size(); ++i) {
+            min_coords = min_coords.cwiseMin(job.nodes[i]);
+            max_coords = max_coords.cwiseMax(job.nodes[i]);
+        }
+
+        const int axis = face / 2;
+        const bool upper = face % 2 == 1;
+        const double bound = upper ? max_coords(axis) : min_coords(axis);
+        const double tol = LATTICE_TOL * std::max((max_coords - min_coords).maxCoeff(), 1.0);
+
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            if (std::abs(job.nodes[i](axis) - bound) <= tol) {
+                face_nodes.push_back(i);
+            }
+        }
+        return face_nodes;
+    }
+
+    std::vector<BC> createFixedBCs(const std::vector<unsigned int> &nodes) {
+        std::vector<BC> bcs;
+        bcs.reserve(nodes.size() * NUM_DOFS);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (unsigned int dof = 0; dof < NUM_DOFS; ++dof) {
+                bcs.push_back(BC(nodes[i], dof, 0.0));
+            }
+        }
+        return bcs;
+    }
+
+    std::vector<Force> createDistributedForces(const std::vector<unsigned int> &nodes,
+                                               const Eigen::Vector3d &total_force) {
+        if (nodes.empty()) {
+            throw std::runtime_error("Cannot distribute a force over an empty set of nodes.");
+        }
+
+        const Eigen::Vector3d nodal_force = total_force / nodes.size();
+
+        std::vector<Force> forces;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (unsigned int dof = 0; dof < 3; ++dof) {
+                if (nodal_force(dof) != 0) {
+                    forces.push_back(Force(nodes[i], dof, nodal_force(dof)));
+                }
+            }
+        }
+        return forces;
+    }
+
+} // namespace fea
@@ -0,0 +1,450 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <boost/format.hpp>
+#include <rapidjson/document.h>
+#include "csv_parser.h"
+#include "model_file.h"
+#include "setup.h"
+
+namespace fea {
+
+    namespace {
+        const char MAGIC[8] = {'F', 'E', 'A', 'M', 'O', 'D', 'E', 'L'};
+
+        // Written as is, so files from a machine with a different byte order can be detected.
+        const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        // Every section starts at a multiple of this many bytes.
+        const uint64_t SECTION_ALIGNMENT = 64;
+
+        enum SectionId {
+            NODES_SECTION,
+            ELEMS_SECTION,
+            PROPS_SECTION,
+            PROP_IDS_SECTION,
+            BCS_SECTION,
+            FORCES_SECTION,
+            LOAD_CASE_OFFSETS_SECTION,
+            TIES_SECTION,
+            EQUATION_OFFSETS_SECTION,
+            EQUATION_TERMS_SECTION,
+            OPTIONS_SECTION,
+            NUM_SECTIONS
+        };
+
+        struct FileHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order_mark;
+            uint32_t num_sections;
+            uint32_t reserved;
+        };
+
+        struct SectionEntry {
+            uint32_t id;
+            uint32_t record_size;
+            uint64_t offset;
+            uint64_t num_records;
+        };
+
+        struct NodeRecord {
+            double coords[3];
+        };
+
+        struct ElemRecord {
+            int32_t node_numbers[2];
+        };
+
+        struct PropsRecord {
+            double EA;
+            double EIz;
+            double EIy;
+            double GJ;
+            double normal_vec[3];
+        };
+
+        // Boundary conditions, forces and the terms of equation constraints.
+        struct DofValueRecord {
+            uint32_t node;
+            uint32_t dof;
+            double value;
+        };
+
+        struct TieRecord {
+            uint32_t node_number_1;
+            uint32_t node_number_2;
+            double lmult;
+            double rmult;
+        };
+
+        static_assert(sizeof(FileHeader) == 24, "Unexpected padding in the model file header.");
+        static_assert(sizeof(SectionEntry) == 24, "Unexpected padding in the model file section table.");
+        static_assert(sizeof(DofValueRecord) == 16, "Unexpected padding in the model file records.");
+        static_assert(sizeof(TieRecord) == 24, "Unexpected padding in the model file records.");
+
+        uint64_t alignOffset(uint64_t offset) {
+            return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        }
+
+        template<typename Record>
+        void writeSection(std::ofstream &file, const SectionEntry &entry, const std::vector<Record> &records) {
+            const std::streamoff padding = static_cast<std::streamoff>(entry.offset) - file.tellp();
+            const char zeros[SECTION_ALIGNMENT] = {};
+            file.write(zeros, padding);
+            if (!records.empty()) {
+                file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(Record));
+            }
+        }
+
+        /**
+         * Returns the records of the section `id` after checking that they lie within the file.
+         */
+        template<typename Record>
+        const Record *getSection(const MappedFile &file,
+                                 const std::vector<SectionEntry> &table,
+                                 SectionId id,
+                                 size_t &num_records) {
+            const SectionEntry &entry = table[id];
+            if (entry.id != static_cast<uint32_t>(id) || entry.record_size != sizeof(Record)
+                || entry.offset % SECTION_ALIGNMENT != 0 || entry.offset > file.size()
+                || entry.num_records > (file.size() - entry.offset) / sizeof(Record)) {
+                throw std::runtime_error(
+                        (boost::format("Section %d of the model file is corrupt or truncated.") % id).str()
+                );
+            }
+            num_records = static_cast<size_t>(entry.num_records);
+            return reinterpret_cast<const Record *>(file.data() + entry.offset);
+        }
+
+        /**
+         * Checks that `offsets` are non-decreasing indices into `num_records` records.
+         */
+        void checkOffsets(const uint64_t *offsets, size_t num_offsets, size_t num_records, SectionId id) {
+            if (num_offsets == 0 || offsets[0] != 0 || offsets[num_offsets - 1] != num_records) {
+                throw std::runtime_error(
+                        (boost::format("Section %d of the model file is corrupt or truncated.") % id).str()
+                );
+            }
+            for (size_t i = 1; i < num_offsets; ++i) {
+                if (offsets[i] < offsets[i - 1]) {
+                    throw std::runtime_error(
+                            (boost::format("Section %d of the model file is corrupt or truncated.") % id).str()
+                    );
+                }
+            }
+        }
+    }
+
+    void writeModelFile(const std::string &filename, const Model &model) {
+        const Job &job = model.job;
+        const std::string options_json = createJSONFromOptions(model.options);
+
+        std::vector<SectionEntry> table(NUM_SECTIONS);
+        const uint32_t record_sizes[NUM_SECTIONS] = {sizeof(NodeRecord), sizeof(ElemRecord), sizeof(PropsRecord),
+                                                     sizeof(uint32_t), sizeof(DofValueRecord), sizeof(DofValueRecord),
+                                                     sizeof(uint64_t), sizeof(TieRecord), sizeof(uint64_t),
+                                                     sizeof(DofValueRecord), sizeof(char)};
+
+        size_t num_forces = 0;
+        for (size_t i = 0; i < model.load_cases.size(); ++i) {
+            num_forces += model.load_cases[i].size();
+        }
+        size_t num_terms = 0;
+        for (size_t i = 0; i < model.equations.size(); ++i) {
+            num_terms += model.equations[i].terms.size();
+        }
+        const size_t num_records[NUM_SECTIONS] = {job.nodes.size(), job.elems.size(), job.props.size(),
+                                                  job.prop_ids.size(), model.bcs.size(), num_forces, model.load_cases.size() + 1,
+                                                  model.ties.size(), model.equations.size() + 1, num_terms,
+                                                  options_json.size()};
+
+        uint64_t offset = alignOffset(sizeof(FileHeader) + NUM_SECTIONS * sizeof(SectionEntry));
+        for (uint32_t i = 0; i < NUM_SECTIONS; ++i) {
+            table[i].id = i;
+            table[i].record_size = record_sizes[i];
+            table[i].offset = offset;
+            table[i].num_records = num_records[i];
+            offset = alignOffset(offset + table[i].record_size * table[i].num_records);
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s") % filename).str()
+            );
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = MODEL_FILE_VERSION;
+        header.byte_order_mark = BYTE_ORDER_MARK;
+        header.num_sections = NUM_SECTIONS;
+        header.reserved = 0;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(SectionEntry));
+
+        // each section is converted to its records just before it is written to limit the memory overhead
+        {
+            std::vector<NodeRecord> records(job.nodes.size());
+            for (size_t i = 0; i < records.size(); ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    records[i].coords[j] = job.nodes[i](j);
+                }
+            }
+            writeSection(file, table[NODES_SECTION], records);
+        }
+        {
+            std::vector<ElemRecord> records(job.elems.size());
+            for (size_t i = 0; i < records.size(); ++i) {
+                records[i].node_numbers[0] = job.elems[i](0);
+                records[i].node_numbers[1] = job.elems[i](1);
+            }
+            writeSection(file, table[ELEMS_SECTION], records);
+        }
+        {
+            std::vector<PropsRecord> records(job.props.size());
+            for (size_t i = 0; i < records.size(); ++i) {
+                const Props &p = job.props[i];
+                records[i].EA = p.EA;
+                records[i].EIz = p.EIz;
+                records[i].EIy = p.EIy;
+                records[i].GJ = p.GJ;
+                for (int j = 0; j < 3; ++j) {
+                    records[i].normal_vec[j] = p.normal_vec(j);
+                }
+            }
+            writeSection(file, table[PROPS_SECTION], records);
+        }
+        {
+            const std::vector<uint32_t> records(job.prop_ids.begin(), job.prop_ids.end());
+            writeSection(file, table[PROP_IDS_SECTION], records);
+        }
+        {
+            std::vector<DofValueRecord> records(model.bcs.size());
+            for (size_t i = 0; i < records.size(); ++i) {
+                records[i].node = model.bcs[i].node;
+                records[i].dof = model.bcs[i].dof;
+                records[i].value = model.bcs[i].value;
+            }
+            writeSection(file, table[BCS_SECTION], records);
+        }
+        {
+            std::vector<DofValueRecord> records;
+            records.reserve(num_forces);
+            std::vector<uint64_t> offsets(1, 0);
+            for (size_t i = 0; i < model.load_cases.size(); ++i) {
+                for (size_t j = 0; j < model.load_cases[i].size(); ++j) {
+                    const Force &force = model.load_cases[i][j];
+                    const DofValueRecord record = {force.node, force.dof, force.value};
+                    records.push_back(record);
+                }
+                offsets.push_back(records.size());
+            }
+            writeSection(file, table[FORCES_SECTION], records);
+            writeSection(file, table[LOAD_CASE_OFFSETS_SECTION], offsets);
+        }
+        {
+            std::vector<TieRecord> records(model.ties.size());
+            for (size_t i = 0; i < records.size(); ++i) {
+                records[i].node_number_1 = model.ties[i].node_number_1;
+                records[i].node_number_2 = model.ties[i].node_number_2;
+                records[i].lmult = model.ties[i].lmult;
+                records[i].rmult = model.ties[i].rmult;
+            }
+            writeSection(file, table[TIES_SECTION], records);
+        }
+        {
+            std::vector<DofValueRecord> records;
+            records.reserve(num_terms);
+            std::vector<uint64_t> offsets(1, 0);
+            for (size_t i = 0; i < model.equations.size(); ++i) {
+                for (size_t j = 0; j < model.equations[i].terms.size(); ++j) {
+                    const Equation::Term &term = model.equations[i].terms[j];
+                    const DofValueRecord record = {term.node_number, term.dof, term.coefficient};
+                    records.push_back(record);
+                }
+                offsets.push_back(records.size());
+            }
+            writeSection(file, table[EQUATION_OFFSETS_SECTION], offsets);
+            writeSection(file, table[EQUATION_TERMS_SECTION], records);
+        }
+        writeSection(file, table[OPTIONS_SECTION], std::vector<char>(options_json.begin(), options_json.end()));
+
+        if (!file.good()) {
+            throw std::runtime_error(
+                    (boost::format("Error writing model file %s") % filename).str()
+            );
+        }
+    }
+
+    Model readModelFile(const std::string &filename) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        MappedFile file(filename);
+
+        FileHeader header;
+        if (file.size() < sizeof(header)) {
+            throw std::runtime_error(
+                    (boost::format("%s is not a model file.") % filename).str()
+            );
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error(
+                    (boost::format("%s is not a model file.") % filename).str()
+            );
+        }
+        if (header.byte_order_mark != BYTE_ORDER_MARK) {
+            throw std::runtime_error(
+                    (boost::format("Model file %s was written on a machine with a different byte order.")
+                     % filename).str()
+            );
+        }
+        if (header.version != MODEL_FILE_VERSION || header.num_sections != NUM_SECTIONS) {
+            throw std::runtime_error(
+                    (boost::format("Model file %s has version %d, but only version %d is supported.")
+                     % filename % header.version % MODEL_FILE_VERSION).str()
+            );
+        }
+        if (file.size() < sizeof(header) + NUM_SECTIONS * sizeof(SectionEntry)) {
+            throw std::runtime_error(
+                    (boost::format("Model file %s is truncated.") % filename).str()
+            );
+        }
+        std::vector<SectionEntry> table(NUM_SECTIONS);
+        std::memcpy(table.data(), file.data() + sizeof(header), NUM_SECTIONS * sizeof(SectionEntry));
+
+        Model model;
+        size_t num_records;
+
+        const NodeRecord *nodes = getSection<NodeRecord>(file, table, NODES_SECTION, num_records);
+        model.job.nodes.resize(num_records);
+        for (size_t i = 0; i < num_records; ++i) {
+            model.job.nodes[i] << nodes[i].coords[0], nodes[i].coords[1], nodes[i].coords[2];
+        }
+
+        const ElemRecord *elems = getSection<ElemRecord>(file, table, ELEMS_SECTION, num_records);
+        model.job.elems.resize(num_records);
+        for (size_t i = 0; i < num_records; ++i) {
+            model.job.elems[i] << elems[i].node_numbers[0], elems[i].node_numbers[1];
+        }
+
+        const PropsRecord *props = getSection<PropsRecord>(file, table, PROPS_SECTION, num_records);
+        model.job.props.resize(num_records);
+        for (size_t i = 0; i < num_records; ++i) {
+            Props &p = model.job.props[i];
+            p.EA = props[i].EA;
+            p.EIz = props[i].EIz;
+            p.EIy = props[i].EIy;
+            p.GJ = props[i].GJ;
+            p.normal_vec << props[i].normal_vec[0], props[i].normal_vec[1], props[i].normal_vec[2];
+        }
+
+        const uint32_t *prop_ids = getSection<uint32_t>(file, table, PROP_IDS_SECTION, num_records);
+        model.job.prop_ids.assign(prop_ids, prop_ids + num_records);
+        if (model.job.prop_ids.empty() && model.job.props.size() != model.job.elems.size()) {
+            throw std::runtime_error("The number of elements in the model file did not match the properties.");
+        }
+        if (!model.job.prop_ids.empty()) {
+            if (model.job.prop_ids.size() != model.job.elems.size()) {
+                throw std::runtime_error("The number of elements in the model file did not match the property ids.");
+            }
+            for (size_t i = 0; i < model.job.prop_ids.size(); ++i) {
+                if (model.job.prop_ids[i] >= model.job.props.size()) {
+                    throw std::runtime_error(
+                            (boost::format("Element %d in the model file refers to property %d, but only %d "
+                                           "properties are stored.") % i % model.job.prop_ids[i]
+                             % model.job.props.size()).str()
+                    );
+                }
+            }
+        }
+
+        const DofValueRecord *bcs = getSection<DofValueRecord>(file, table, BCS_SECTION, num_records);
+        model.bcs.resize(num_records);
+        for (size_t i = 0; i < num_records; ++i) {
+            model.bcs[i] = BC(bcs[i].node, bcs[i].dof, bcs[i].value);
+        }
+
+        size_t num_forces, num_load_case_offsets;
+        const DofValueRecord *forces = getSection<DofValueRecord>(file, table, FORCES_SECTION, num_forces);
+        const uint64_t *load_case_offsets = getSection<uint64_t>(file, table, LOAD_CASE_OFFSETS_SECTION,
+                                                                 num_load_case_offsets);
+        checkOffsets(load_case_offsets, num_load_case_offsets, num_forces, LOAD_CASE_OFFSETS_SECTION);
+        model.load_cases.resize(num_load_case_offsets - 1);
+        for (size_t i = 0; i < model.load_cases.size(); ++i) {
+            model.load_cases[i].reserve(load_case_offsets[i + 1] - load_case_offsets[i]);
+            for (uint64_t j = load_case_offsets[i]; j < load_case_offsets[i + 1]; ++j) {
+                model.load_cases[i].push_back(Force(forces[j].node, forces[j].dof, forces[j].value));
+            }
+        }
+
+        const TieRecord *ties = getSection<TieRecord>(file, table, TIES_SECTION, num_records);
+        model.ties.resize(num_records);
+        for (size_t i = 0; i < num_records; ++i) {
+            model.ties[i] = Tie(ties[i].node_number_1, ties[i].node_number_2, ties[i].lmult, ties[i].rmult);
+        }
+
+        size_t num_terms, num_equation_offsets;
+        const uint64_t *equation_offsets = getSection<uint64_t>(file, table, EQUATION_OFFSETS_SECTION,
+                                                                num_equation_offsets);
+        const DofValueRecord *terms = getSection<DofValueRecord>(file, table, EQUATION_TERMS_SECTION, num_terms);
+        checkOffsets(equation_offsets, num_equation_offsets, num_terms, EQUATION_OFFSETS_SECTION);
+        model.equations.resize(num_equation_offsets - 1);
+        for (size_t i = 0; i < model.equations.size(); ++i) {
+            std::vector<Equation::Term> &eqn_terms = model.equations[i].terms;
+            eqn_terms.reserve(equation_offsets[i + 1] - equation_offsets[i]);
+            for (uint64_t j = equation_offsets[i]; j < equation_offsets[i + 1]; ++j) {
+                eqn_terms.push_back(Equation::Term(terms[j].node, terms[j].dof, terms[j].value));
+            }
+        }
+
+        const char *options_json = getSection<char>(file, table, OPTIONS_SECTION, num_records);
+        rapidjson::Document config_doc;
+        config_doc.Parse(("{\"options\":" + std::string(options_json, num_records) + "}").c_str());
+        if (config_doc.HasParseError() || !config_doc["options"].IsObject()) {
+            throw std::runtime_error(
+                    (boost::format("The options stored in model file %s are not a json object.") % filename).str()
+            );
+        }
+        model.options = createOptionsFromJSON(config_doc);
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        model.input_load_times.push_back(InputLoadTime(
+                "model", filename, std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()));
+        return model;
+    }
+
+    bool isModelFile(const std::string &filename) {
+        std::ifstream file(filename, std::ios::binary);
+        char magic[sizeof(MAGIC)];
+        return file.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+} // namespace fea
@@ -0,0 +1,274 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include "boost/format.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include "options.h"
+#include "result_file.h"
+
+namespace fea {
+
+    namespace {
+        // The header of a .npy file is padded so the data starts at a multiple of this many bytes.
+        const size_t NPY_ALIGNMENT = 64;
+
+        bool isLittleEndian() {
+            const uint16_t one = 1;
+            char first_byte;
+            std::memcpy(&first_byte, &one, 1);
+            return first_byte == 1;
+        }
+
+        // VTK cell type of a line between two points.
+        const uint8_t VTK_LINE = 3;
+
+        // Describes a data array stored in the appended data of a .vtu file.
+        struct VtuArray {
+            std::string type;
+            std::string name;
+            size_t num_components;
+            size_t num_values;
+            size_t value_size;
+
+            size_t numBytes() const { return num_components * num_values * value_size; }
+        };
+
+        // Writes the length of an appended array followed by its values.
+        template<typename T>
+        void writeAppendedArray(std::ofstream &file, const std::vector<T> &values) {
+            const uint64_t num_bytes = values.size() * sizeof(T);
+            file.write(reinterpret_cast<const char *>(&num_bytes), sizeof(num_bytes));
+            if (num_bytes > 0) {
+                file.write(reinterpret_cast<const char *>(values.data()), num_bytes);
+            }
+        }
+
+        // Gathers 3 of the 6 columns of nodal or tie results, starting at first_col, into rows first_row onwards of
+        // an array of num_rows + first_row rows on num_threads threads. The remaining rows are zero.
+        std::vector<double> gatherColumns(const ResultMatrix &results,
+                                          size_t first_row,
+                                          size_t num_rows,
+                                          size_t first_col,
+                                          unsigned int num_threads) {
+            std::vector<double> values(3 * (first_row + num_rows), 0.0);
+            const long num_results = std::min(static_cast<size_t>(results.rows()), num_rows);
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+            for (long i = 0; i < num_results; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    values[3 * (first_row + i) + j] = results(i, first_col + j);
+                }
+            }
+            return values;
+        }
+
+        // Returns the magic string, version, header length and header of a version 1.0 .npy file.
+        std::string createNpyHeader(size_t num_rows, size_t num_cols) {
+            std::string dict = (boost::format("{'descr': '%sf8', 'fortran_order': False, 'shape': (%d, %d), }")
+                                % (isLittleEndian() ? "<" : ">") % num_rows % num_cols).str();
+
+            // magic string (6 bytes), version (2 bytes) and header length (2 bytes) precede the dictionary, which
+            // is padded with spaces and ends with a newline
+            const size_t preamble_size = 10;
+            const size_t unpadded_size = preamble_size + dict.size() + 1;
+            const size_t padded_size = (unpadded_size + NPY_ALIGNMENT - 1) / NPY_ALIGNMENT * NPY_ALIGNMENT;
+            dict.append(padded_size - unpadded_size, ' ');
+            dict += '\n';
+
+            const uint16_t header_length = static_cast<uint16_t>(dict.size());
+            std::string header("\x93NUMPY\x01\x00", 8);
+            header += static_cast<char>(header_length & 0xff);
+            header += static_cast<char>(header_length >> 8);
+            return header + dict;
+        }
+    }
+
+    void writeNpyFile(const std::string &filename, const double *data, size_t num_rows, size_t num_cols) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s") % filename).str()
+            );
+        }
+
+        const std::string header = createNpyHeader(num_rows, num_cols);
+        file.write(header.data(), header.size());
+        if (num_rows * num_cols > 0) {
+            file.write(reinterpret_cast<const char *>(data), num_rows * num_cols * sizeof(double));
+        }
+
+        file.close();
+        if (!file) {
+            throw std::runtime_error(
+                    (boost::format("Error writing file %s") % filename).str()
+            );
+        }
+    }
+
+    void writeNpyFile(const std::string &filename, const ResultMatrix &results) {
+        writeNpyFile(filename, results.data(), results.rows(), results.cols());
+    }
+
+    void writeVtuFile(const std::string &filename,
+                      const Job &job,
+                      const std::vector<Tie> &ties,
+                      const Summary &summary,
+                      unsigned int num_threads) {
+        const size_t num_points = job.nodes.size();
+        const size_t num_elems = job.elems.size();
+        const size_t num_cells = num_elems + ties.size();
+
+        if (summary.nodal_displacements.rows() != static_cast<long>(num_points)
+            || summary.nodal_forces.rows() != static_cast<long>(num_points)) {
+            throw std::runtime_error(
+                    (boost::format("The results written to %s do not match the %d nodes of the model.")
+                     % filename % num_points).str()
+            );
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error(
+                    (boost::format("Error opening file %s") % filename).str()
+            );
+        }
+
+        // the arrays in the order they are appended
+        const VtuArray point_arrays[] = {{"Float64", "displacement", 3, num_points, sizeof(double)},
+                                         {"Float64", "rotation",     3, num_points, sizeof(double)},
+                                         {"Float64", "force",        3, num_points, sizeof(double)},
+                                         {"Float64", "moment",       3, num_points, sizeof(double)}};
+        const VtuArray cell_arrays[] = {{"UInt8",   "cell_set",   1, num_cells, sizeof(uint8_t)},
+                                        {"Float64", "tie_force",  3, num_cells, sizeof(double)},
+                                        {"Float64", "tie_moment", 3, num_cells, sizeof(double)}};
+        const VtuArray points = {"Float64", "Points", 3, num_points, sizeof(double)};
+        // VTK only reads cell arrays with a single component, so the connectivity lists both nodes of every cell
+        const VtuArray grid_cell_arrays[] = {{"Int64", "connectivity", 1, 2 * num_cells, sizeof(int64_t)},
+                                             {"Int64", "offsets",      1, num_cells,     sizeof(int64_t)},
+                                             {"UInt8", "types",        1, num_cells,     sizeof(uint8_t)}};
+
+        size_t offset = 0;
+        boost::format data_array("        <DataArray type=\"%s\" Name=\"%s\" NumberOfComponents=\"%d\" "
+                                 "format=\"appended\" offset=\"%d\"/>\n");
+        std::string xml = (boost::format("<?xml version=\"1.0\"?>\n"
+                                         "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"%s\" "
+                                         "header_type=\"UInt64\">\n"
+                                         "  <UnstructuredGrid>\n"
+                                         "    <Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n"
+                                         "      <PointData Vectors=\"displacement\">\n")
+                           % (isLittleEndian() ? "LittleEndian" : "BigEndian") % num_points % num_cells).str();
+        for (size_t i = 0; i < 4; ++i) {
+            xml += (boost::format(data_array) % point_arrays[i].type % point_arrays[i].name
+                    % point_arrays[i].num_components % offset).str();
+            offset += sizeof(uint64_t) + point_arrays[i].numBytes();
+        }
+        xml += "      </PointData>\n      <CellData Scalars=\"cell_set\">\n";
+        for (size_t i = 0; i < 3; ++i) {
+            xml += (boost::format(data_array) % cell_arrays[i].type % cell_arrays[i].name
+                    % cell_arrays[i].num_components % offset).str();
+            offset += sizeof(uint64_t) + cell_arrays[i].numBytes();
+        }
+        xml += "      </CellData>\n      <Points>\n";
+        xml += (boost::format(data_array) % points.type % points.name % points.num_components % offset).str();
+        offset += sizeof(uint64_t) + points.numBytes();
+        xml += "      </Points>\n      <Cells>\n";
+        for (size_t i = 0; i < 3; ++i) {
+            xml += (boost::format(data_array) % grid_cell_arrays[i].type % grid_cell_arrays[i].name
+                    % grid_cell_arrays[i].num_components % offset).str();
+            offset += sizeof(uint64_t) + grid_cell_arrays[i].numBytes();
+        }
+        xml += "      </Cells>\n"
+                "    </Piece>\n"
+                "  </UnstructuredGrid>\n"
+                "  <AppendedData encoding=\"raw\">\n   _";
+        file.write(xml.data(), xml.size());
+
+        // point data
+        writeAppendedArray(file, gatherColumns(summary.nodal_displacements, 0, num_points, 0, num_threads));
+        writeAppendedArray(file, gatherColumns(summary.nodal_displacements, 0, num_points, 3, num_threads));
+        writeAppendedArray(file, gatherColumns(summary.nodal_forces, 0, num_points, 0, num_threads));
+        writeAppendedArray(file, gatherColumns(summary.nodal_forces, 0, num_points, 3, num_threads));
+
+        // cell data
+        {
+            std::vector<uint8_t> cell_set(num_cells, 0);
+            std::fill(cell_set.begin() + num_elems, cell_set.end(), 1);
+            writeAppendedArray(file, cell_set);
+        }
+        writeAppendedArray(file, gatherColumns(summary.tie_forces, num_elems, ties.size(), 0, num_threads));
+        writeAppendedArray(file, gatherColumns(summary.tie_forces, num_elems, ties.size(), 3, num_threads));
+
+        // points
+        {
+            std::vector<double> coords(3 * num_points);
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+            for (long i = 0; i < static_cast<long>(num_points); ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    coords[3 * i + j] = job.nodes[i](j);
+                }
+            }
+            writeAppendedArray(file, coords);
+        }
+
+        // cells
+        {
+            std::vector<int64_t> connectivity(2 * num_cells);
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+            for (long i = 0; i < static_cast<long>(num_elems); ++i) {
+                connectivity[2 * i] = job.elems[i](0);
+                connectivity[2 * i + 1] = job.elems[i](1);
+            }
+            for (size_t i = 0; i < ties.size(); ++i) {
+                connectivity[2 * (num_elems + i)] = ties[i].node_number_1;
+                connectivity[2 * (num_elems + i) + 1] = ties[i].node_number_2;
+            }
+            writeAppendedArray(file, connectivity);
+        }
+        {
+            std::vector<int64_t> offsets(num_cells);
+            for (size_t i = 0; i < num_cells; ++i) {
+                offsets[i] = 2 * (i + 1);
+            }
+            writeAppendedArray(file, offsets);
+        }
+        writeAppendedArray(file, std::vector<uint8_t>(num_cells, VTK_LINE));
+
+        const std::string footer = "\n  </AppendedData>\n</VTKFile>\n";
+        file.write(footer.data(), footer.size());
+
+        file.close();
+        if (!file) {
+            throw std::runtime_error(
+                    (boost::format("Error writing file %s") % filename).str()
+            );
+        }
+    }
+
+} // namespace fea
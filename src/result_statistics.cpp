@@ -0,0 +1,181 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <cmath>
+#include "options.h"
+#include "result_statistics.h"
+
+namespace fea {
+
+    namespace {
+        // Number of rows processed by one task.
+        const long STATISTICS_CHUNK_ROWS = 4096;
+
+        // Orders values by decreasing magnitude, rows with equal magnitudes by increasing row.
+        bool hasLargerMagnitude(const RowValue &a, const RowValue &b) {
+            const double abs_a = std::abs(a.value);
+            const double abs_b = std::abs(b.value);
+            return abs_a > abs_b || (abs_a == abs_b && a.row < b.row);
+        }
+
+        // Statistics of one column gathered from a chunk of rows.
+        struct ColumnAccumulator {
+            ColumnAccumulator() : sum(0.0), sum_of_squares(0.0) { };
+
+            RowValue min;
+            RowValue max;
+            double sum;
+            double sum_of_squares;
+            // heap whose front is the smallest of the kept magnitudes
+            std::vector<RowValue> largest;
+        };
+
+        // Gathers the statistics of the rows [begin, end) of a column.
+        void accumulateColumn(const ResultMatrix &results, long col, long begin, long end, unsigned int num_largest,
+                              ColumnAccumulator &acc) {
+            acc.min = RowValue(begin, results(begin, col));
+            acc.max = acc.min;
+            acc.largest.reserve(num_largest);
+            for (long i = begin; i < end; ++i) {
+                const double value = results(i, col);
+                if (value < acc.min.value) {
+                    acc.min = RowValue(i, value);
+                }
+                if (value > acc.max.value) {
+                    acc.max = RowValue(i, value);
+                }
+                acc.sum += value;
+                acc.sum_of_squares += value * value;
+
+                if (num_largest == 0) {
+                    continue;
+                }
+                const RowValue row_value(i, value);
+                if (acc.largest.size() < num_largest) {
+                    acc.largest.push_back(row_value);
+                    std::push_heap(acc.largest.begin(), acc.largest.end(), hasLargerMagnitude);
+                }
+                else if (hasLargerMagnitude(row_value, acc.largest.front())) {
+                    std::pop_heap(acc.largest.begin(), acc.largest.end(), hasLargerMagnitude);
+                    acc.largest.back() = row_value;
+                    std::push_heap(acc.largest.begin(), acc.largest.end(), hasLargerMagnitude);
+                }
+            }
+        }
+
+        // Returns the histogram bin of a value between min and max.
+        size_t histogramBin(double value, double min, double max, unsigned int num_bins) {
+            if (!(max > min)) {
+                return 0;
+            }
+            const double position = (value - min) / (max - min) * num_bins;
+            return std::min(static_cast<size_t>(std::max(position, 0.0)), static_cast<size_t>(num_bins - 1));
+        }
+    }
+
+    ResultStatistics computeResultStatistics(const ResultMatrix &results, unsigned int num_largest,
+                                             unsigned int num_bins, unsigned int num_threads) {
+        ResultStatistics statistics;
+        const long num_rows = results.rows();
+        const long num_cols = results.cols();
+        statistics.num_rows = num_rows;
+        if (num_rows == 0) {
+            return statistics;
+        }
+
+        const int max_threads = resolveNumThreads(num_threads);
+        const long num_chunks = (num_rows + STATISTICS_CHUNK_ROWS - 1) / STATISTICS_CHUNK_ROWS;
+        std::vector<ColumnAccumulator> accumulators(num_chunks * num_cols);
+#pragma omp parallel for num_threads(max_threads)
+        for (long c = 0; c < num_chunks; ++c) {
+            const long begin = c * STATISTICS_CHUNK_ROWS;
+            const long end = std::min(begin + STATISTICS_CHUNK_ROWS, num_rows);
+            for (long j = 0; j < num_cols; ++j) {
+                accumulateColumn(results, j, begin, end, num_largest, accumulators[c * num_cols + j]);
+            }
+        }
+
+        // merge the chunks in order, so the first row holding an extremum is kept
+        statistics.columns.resize(num_cols);
+        for (long j = 0; j < num_cols; ++j) {
+            ColumnStatistics &column = statistics.columns[j];
+            column.min = accumulators[j].min;
+            column.max = accumulators[j].max;
+            double sum = 0.0;
+            double sum_of_squares = 0.0;
+            for (long c = 0; c < num_chunks; ++c) {
+                const ColumnAccumulator &acc = accumulators[c * num_cols + j];
+                if (acc.min.value < column.min.value) {
+                    column.min = acc.min;
+                }
+                if (acc.max.value > column.max.value) {
+                    column.max = acc.max;
+                }
+                sum += acc.sum;
+                sum_of_squares += acc.sum_of_squares;
+                column.largest.insert(column.largest.end(), acc.largest.begin(), acc.largest.end());
+            }
+            column.mean = sum / num_rows;
+            column.rms = std::sqrt(sum_of_squares / num_rows);
+            std::sort(column.largest.begin(), column.largest.end(), hasLargerMagnitude);
+            if (column.largest.size() > num_largest) {
+                column.largest.resize(num_largest);
+            }
+            column.histogram_min = column.min.value;
+            column.histogram_max = column.max.value;
+        }
+
+        if (num_bins == 0) {
+            return statistics;
+        }
+
+        std::vector<unsigned long> counts(num_chunks * num_cols * num_bins, 0);
+#pragma omp parallel for num_threads(max_threads)
+        for (long c = 0; c < num_chunks; ++c) {
+            const long begin = c * STATISTICS_CHUNK_ROWS;
+            const long end = std::min(begin + STATISTICS_CHUNK_ROWS, num_rows);
+            unsigned long *chunk_counts = &counts[c * num_cols * num_bins];
+            for (long i = begin; i < end; ++i) {
+                for (long j = 0; j < num_cols; ++j) {
+                    const ColumnStatistics &column = statistics.columns[j];
+                    ++chunk_counts[j * num_bins + histogramBin(results(i, j), column.histogram_min,
+                                                                column.histogram_max, num_bins)];
+                }
+            }
+        }
+        for (long j = 0; j < num_cols; ++j) {
+            std::vector<unsigned long> &histogram = statistics.columns[j].histogram;
+            histogram.assign(num_bins, 0);
+            for (long c = 0; c < num_chunks; ++c) {
+                for (unsigned int b = 0; b < num_bins; ++b) {
+                    histogram[b] += counts[(c * num_cols + j) * num_bins + b];
+                }
+            }
+        }
+        return statistics;
+    }
+
+} // namespace fea
@@ -25,192 +25,954 @@
 
 
 #include "boost/format.hpp"
+#include <rapidjson/error/en.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <exception>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
 #include "setup.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace fea {
 
     namespace {
-        template<typename T>
-        void createVectorFromJSON(const rapidjson::Document &config_doc,
-                                  const std::string &variable,
-                                  std::vector< std::vector<T> > &data) {
+        const rapidjson::Value &getRowsFromJSON(const rapidjson::Document &config_doc, const std::string &variable) {
             if (!config_doc.HasMember(variable.c_str())) {
                 throw std::runtime_error(
                         (boost::format("Configuration file does not have requested member variable %s.") %
                          variable).str()
                 );
             }
-            if (!config_doc[variable.c_str()].IsString()) {
+            const rapidjson::Value &value = config_doc[variable.c_str()];
+            if (!value.IsString() && !value.IsArray()) {
                 throw std::runtime_error(
-                        (boost::format("Value associated with variable %s is not a string.") % variable).str()
+                        (boost::format("Value associated with variable %s is not a string or an array.") %
+                         variable).str()
                 );
             }
-            CSVParser csv;
-            std::string filename(config_doc[variable.c_str()].GetString());
-            csv.parseToVector(filename, data);
-            if (data.size() == 0) {
+            return value;
+        }
+
+        void throwInvalidRow(const std::string &variable, size_t row) {
+            throw std::runtime_error(
+                    (boost::format("Row %d in %s is not an array of numbers.") % row % variable).str()
+            );
+        }
+
+        /**
+         * Appends a row to the rows that `sink` has received so far.
+         */
+        template<typename RowSink>
+        void appendRow(RowSink sink, size_t row, const std::vector<double> &values) {
+            sink.resize(row + 1);
+            sink.setRow(row, values.data(), values.size());
+        }
+
+        /**
+         * Forwards the rows to `sink` and records how many there are.
+         */
+        template<typename RowSink>
+        struct CountingSink {
+            RowSink &sink;
+            size_t num_rows;
+
+            void resize(size_t _num_rows) {
+                num_rows = _num_rows;
+                sink.resize(num_rows);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                sink.setRow(row, values, num_values);
+            }
+        };
+
+        /**
+         * Parses the rows associated with `variable` directly into the storage held by `sink`. The rows are either
+         * given inline as an array of arrays or in the csv file named by the value of `variable`.
+         */
+        template<typename RowSink>
+        void parseRowsFromJSON(const rapidjson::Document &config_doc, const std::string &variable, RowSink &sink) {
+            const rapidjson::Value &value = getRowsFromJSON(config_doc, variable);
+            CountingSink<RowSink> counting_sink = {sink, 0};
+
+            if (value.IsString()) {
+                CSVParser csv;
+                csv.parseRows(value.GetString(), counting_sink);
+            }
+            else {
+                counting_sink.resize(value.Size());
+                std::vector<double> values;
+                for (rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+                    if (!value[i].IsArray()) {
+                        throwInvalidRow(variable, i);
+                    }
+                    values.clear();
+                    for (rapidjson::SizeType j = 0; j < value[i].Size(); ++j) {
+                        if (!value[i][j].IsNumber()) {
+                            throwInvalidRow(variable, i);
+                        }
+                        values.push_back(value[i][j].GetDouble());
+                    }
+                    counting_sink.setRow(i, values.data(), values.size());
+                }
+            }
+
+            if (counting_sink.num_rows == 0) {
                 throw std::runtime_error(
                         (boost::format("No data was loaded for variable %s.") % variable).str()
                 );
             }
         }
-    }
 
-    rapidjson::Document parseJSONConfig(const std::string &config_filename) {
-        rapidjson::Document config_doc;
+        struct NodeSink {
+            std::vector<Node> &nodes;
 
-        FILE *config_file_ptr = fopen(config_filename.c_str(), "r");
+            void resize(size_t num_rows) {
+                nodes.resize(num_rows);
+            }
 
-        if (!config_file_ptr) {
-            throw std::runtime_error(
-                    (boost::format("Cannot open configuration input file %s.") % config_filename).str()
-            );
-        }
-        char readBuffer[65536];
-        rapidjson::FileReadStream config_stream(config_file_ptr, readBuffer, sizeof(readBuffer));
-        config_doc.ParseStream(config_stream);
-        fclose(config_file_ptr);
-        return config_doc;
-    }
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values != 3) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in nodes does not specify x, y and z coordinates.") % row).str()
+                    );
+                }
+                nodes[row] << values[0], values[1], values[2];
+            }
+        };
 
-    std::vector<Node> createNodeVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > nodes_vec;
-        fea::createVectorFromJSON(config_doc, "nodes", nodes_vec);
+        struct ElemSink {
+            std::vector<Eigen::Vector2i> &elems;
 
-        std::vector<Node> nodes_out(nodes_vec.size());
-        Node n;
+            void resize(size_t num_rows) {
+                elems.resize(num_rows);
+            }
 
-        for (size_t i = 0; i < nodes_vec.size(); ++i) {
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values != 2) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in elems does not specify 2 nodal indices [nn1,nn2].") % row).str()
+                    );
+                }
+                elems[row] << (unsigned int) values[0], (unsigned int) values[1];
+            }
+        };
 
-            if (nodes_vec[i].size() != 3) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in nodes does not specify x, y and z coordinates.") % i).str()
-                );
+        struct PropsSink {
+            std::vector<Props> &props;
+
+            void resize(size_t num_rows) {
+                props.resize(num_rows);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values != 7) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d  in props does not specify the 7 property values "
+                                                   "[EA, EIz, EIy, GJ, nx, ny, nz]") % row).str()
+                    );
+                }
+                Props &p = props[row];
+                p.EA = values[0];
+                p.EIz = values[1];
+                p.EIy = values[2];
+                p.GJ = values[3];
+                p.normal_vec << values[4], values[5], values[6];
+            }
+        };
+
+        struct PropIdSink {
+            std::vector<unsigned int> &prop_ids;
+
+            void resize(size_t num_rows) {
+                prop_ids.resize(num_rows);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values != 1 || values[0] < 0 || values[0] != std::floor(values[0])) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in prop_ids does not specify a single row index of props.") %
+                             row).str()
+                    );
+                }
+                prop_ids[row] = (unsigned int) values[0];
+            }
+        };
+
+        struct BCSink {
+            std::vector<BC> &bcs;
+
+            void resize(size_t num_rows) {
+                bcs.resize(num_rows);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values != 3) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in bcs does not specify [node number,DOF,value].") % row).str()
+                    );
+                }
+                bcs[row] = BC((unsigned int) values[0], (unsigned int) values[1], values[2]);
+            }
+        };
+
+        /**
+         * Stores each force together with its load case, which defaults to 0 if `allow_load_cases` is true.
+         */
+        struct ForceSink {
+            std::vector<Force> &forces;
+            std::vector<size_t> &load_case_ids;
+            bool allow_load_cases;
+
+            void resize(size_t num_rows) {
+                forces.resize(num_rows);
+                load_case_ids.resize(num_rows, 0);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (!allow_load_cases && num_values != 3) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in forces does not specify [node number,DOF,value].") % row).str()
+                    );
+                }
+                if (num_values != 3 && num_values != 4) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in forces does not specify [node number,DOF,value] or "
+                                           "[node number,DOF,value,load case].") % row).str()
+                    );
+                }
+                if (num_values == 4) {
+                    if (values[3] < 0 || values[3] != std::floor(values[3])) {
+                        throw std::runtime_error(
+                                (boost::format("Row %d in forces specifies load case %s, which is not a non-negative "
+                                               "integer.") % row % values[3]).str()
+                        );
+                    }
+                    load_case_ids[row] = (size_t) values[3];
+                }
+                forces[row] = Force((unsigned int) values[0], (unsigned int) values[1], values[2]);
+            }
+        };
+
+        struct TieSink {
+            std::vector<Tie> &ties;
+
+            void resize(size_t num_rows) {
+                ties.resize(num_rows);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values != 4) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in ties does not specify [node number 1,node number 2,lmult,rmult].") %
+                             row).str()
+                    );
+                }
+                ties[row] = Tie((unsigned int) values[0], (unsigned int) values[1], values[2], values[3]);
+            }
+        };
+
+        struct EquationSink {
+            std::vector<Equation> &eqns;
+
+            void resize(size_t num_rows) {
+                eqns.resize(num_rows);
+            }
+
+            void setRow(size_t row, const double *values, size_t num_values) {
+                if (num_values % 3 != 0) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in equations does not specify [node number,dof,coefficient,...] for each term.") %
+                             row).str()
+                    );
+                }
+
+                std::vector<Equation::Term> &terms = eqns[row].terms;
+                terms.reserve(num_values / 3);
+                for (size_t j = 0; j < num_values / 3; ++j) {
+                    terms.push_back(Equation::Term(
+                        (unsigned int) values[3 * j],
+                        (unsigned int) values[3 * j + 1],
+                        values[3 * j + 2]));
+                }
+            }
+        };
+
+        /**
+         * Checks that each element has a row in props, either the row with the same index or the row given in
+         * prop_ids.
+         */
+        void checkElemProps(size_t num_elems, size_t num_props, const std::vector<unsigned int> &prop_ids,
+                            bool has_prop_ids) {
+            if (!has_prop_ids) {
+                if (num_elems != num_props) {
+                    throw std::runtime_error("The number of rows in elems did not match props.");
+                }
+                return;
+            }
+            if (num_elems != prop_ids.size()) {
+                throw std::runtime_error("The number of rows in elems did not match prop_ids.");
+            }
+            for (size_t i = 0; i < prop_ids.size(); ++i) {
+                if (prop_ids[i] >= num_props) {
+                    throw std::runtime_error(
+                            (boost::format("Row %d in prop_ids refers to row %d of props, but props only has %d "
+                                           "rows.") % i % prop_ids[i] % num_props).str()
+                    );
+                }
             }
-            n << nodes_vec[i][0], nodes_vec[i][1], nodes_vec[i][2];
-            nodes_out[i] = n;
         }
-        return nodes_out;
-    }
 
-    std::vector<Elem> createElemVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<unsigned int> > elems_vec;
-        std::vector< std::vector<double> > props_vec;
-        fea::createVectorFromJSON(config_doc, "elems", elems_vec);
-        fea::createVectorFromJSON(config_doc, "props", props_vec);
+        void parseElemsAndPropsFromJSON(const rapidjson::Document &config_doc,
+                                        std::vector<Eigen::Vector2i> &elems,
+                                        std::vector<Props> &props,
+                                        std::vector<unsigned int> &prop_ids) {
+            ElemSink elem_sink = {elems};
+            fea::parseRowsFromJSON(config_doc, "elems", elem_sink);
+            PropsSink props_sink = {props};
+            fea::parseRowsFromJSON(config_doc, "props", props_sink);
 
-        if (elems_vec.size() != props_vec.size()) {
-            throw std::runtime_error("The number of rows in elems did not match props.");
+            const bool has_prop_ids = config_doc.HasMember("prop_ids");
+            if (has_prop_ids) {
+                PropIdSink prop_id_sink = {prop_ids};
+                fea::parseRowsFromJSON(config_doc, "prop_ids", prop_id_sink);
+            }
+            fea::checkElemProps(elems.size(), props.size(), prop_ids, has_prop_ids);
         }
 
-        std::vector<Elem> elems_out(elems_vec.size());
-        Props p;
-        for (size_t i = 0; i < elems_vec.size(); ++i) {
-            if (elems_vec[i].size() != 2) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in elems does not specify 2 nodal indices [nn1,nn2].") % i).str()
-                );
+        std::vector<std::vector<Force> > groupLoadCases(const std::vector<Force> &forces,
+                                                        const std::vector<size_t> &load_case_ids) {
+            // size each load case up front so the forces are only copied once
+            std::vector<size_t> num_forces(1, 0);
+            for (size_t i = 0; i < forces.size(); ++i) {
+                if (load_case_ids[i] >= num_forces.size()) {
+                    num_forces.resize(load_case_ids[i] + 1, 0);
+                }
+                ++num_forces[load_case_ids[i]];
+            }
+
+            std::vector<std::vector<Force> > load_cases(num_forces.size());
+            for (size_t i = 0; i < load_cases.size(); ++i) {
+                load_cases[i].reserve(num_forces[i]);
             }
-            if (props_vec[i].size() != 7) {
+            for (size_t i = 0; i < forces.size(); ++i) {
+                load_cases[load_case_ids[i]].push_back(forces[i]);
+            }
+            return load_cases;
+        }
+
+        Eigen::Vector3d getLatticeVector(const rapidjson::Value &lattice, const char *name) {
+            const rapidjson::Value &value = lattice[name];
+            if (!value.IsArray() || value.Size() != 3
+                || !value[0].IsNumber() || !value[1].IsNumber() || !value[2].IsNumber()) {
                 throw std::runtime_error(
-                        (boost::format("Row %d  in props does not specify the 7 property values "
-                                               "[EA, EIz, EIy, GJ, nx, ny, nz]") % i).str()
+                        (boost::format("%s provided in lattice configuration is not an array of 3 numbers.")
+                         % name).str()
                 );
             }
-            p.EA = props_vec[i][0];
-            p.EIz = props_vec[i][1];
-            p.EIy = props_vec[i][2];
-            p.GJ = props_vec[i][3];
-            p.normal_vec << props_vec[i][4], props_vec[i][5], props_vec[i][6];
-            elems_out[i] = Elem(elems_vec[i][0], elems_vec[i][1], p);
+            return Eigen::Vector3d(value[0].GetDouble(), value[1].GetDouble(), value[2].GetDouble());
         }
-        return elems_out;
-    }
 
-    std::vector<BC> createBCVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > bcs_vec;
-        fea::createVectorFromJSON(config_doc, "bcs", bcs_vec);
+        BoxFace getLatticeFace(const rapidjson::Value &lattice, const char *name) {
+            const char *const face_names[6] = {"x_min", "x_max", "y_min", "y_max", "z_min", "z_max"};
+            if (lattice[name].IsString()) {
+                const std::string face = lattice[name].GetString();
+                for (int i = 0; i < 6; ++i) {
+                    if (face == face_names[i]) {
+                        return static_cast<BoxFace>(i);
+                    }
+                }
+            }
+            throw std::runtime_error(
+                    (boost::format("%s provided in lattice configuration must be one of \"x_min\", \"x_max\", "
+                                   "\"y_min\", \"y_max\", \"z_min\" or \"z_max\".") % name).str()
+            );
+        }
 
-        std::vector<BC> bcs_out(bcs_vec.size());
+        /**
+         * Generates the mesh described by the "lattice" member. The boundary conditions and forces it describes are
+         * appended to `bcs` and `forces`.
+         */
+        void createLatticeFromJSON(const rapidjson::Value &lattice,
+                                   Job &job,
+                                   std::vector<BC> &bcs,
+                                   std::vector<Force> &forces) {
+            if (!lattice.IsObject()) {
+                throw std::runtime_error("lattice provided in configuration is not a json object.");
+            }
 
-        for (size_t i = 0; i < bcs_vec.size(); ++i) {
-            if (bcs_vec[i].size() != 3) {
+            if (!lattice.HasMember("unit_cell") || !lattice["unit_cell"].IsString()) {
+                throw std::runtime_error("unit_cell provided in lattice configuration is not a string.");
+            }
+            const std::string unit_cell = lattice["unit_cell"].GetString();
+            UnitCellType type;
+            if (unit_cell == "cubic") {
+                type = CUBIC_CELL;
+            }
+            else if (unit_cell == "octet") {
+                type = OCTET_CELL;
+            }
+            else if (unit_cell == "kelvin") {
+                type = KELVIN_CELL;
+            }
+            else {
                 throw std::runtime_error(
-                        (boost::format("Row %d in bcs does not specify [node number,DOF,value].") % i).str()
+                        (boost::format("unit_cell provided in lattice configuration must be \"cubic\", \"octet\" "
+                                       "or \"kelvin\", not \"%s\".") % unit_cell).str()
                 );
             }
-            bcs_out[i] = BC((unsigned int) bcs_vec[i][0], (unsigned int) bcs_vec[i][1], bcs_vec[i][2]);
-        }
-        return bcs_out;
-    }
 
-    std::vector<Force> createForceVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > forces_vec;
-        fea::createVectorFromJSON(config_doc, "forces", forces_vec);
+            if (!lattice.HasMember("cells")) {
+                throw std::runtime_error("Lattice configuration does not have requested member variable cells.");
+            }
+            const Eigen::Vector3d cells = fea::getLatticeVector(lattice, "cells");
+            if (cells != cells.array().round().matrix()) {
+                throw std::runtime_error("cells provided in lattice configuration must hold whole numbers.");
+            }
 
-        std::vector<Force> forces_out(forces_vec.size());
+            Eigen::Vector3d cell_size = Eigen::Vector3d::Ones();
+            if (lattice.HasMember("cell_size")) {
+                cell_size = fea::getLatticeVector(lattice, "cell_size");
+            }
 
-        for (size_t i = 0; i < forces_vec.size(); ++i) {
-            if (forces_vec[i].size() != 3) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in forces does not specify [node number,DOF,value].") % i).str()
-                );
+            if (!lattice.HasMember("section")) {
+                throw std::runtime_error("Lattice configuration does not have requested member variable section.");
+            }
+            const rapidjson::Value &section_value = lattice["section"];
+            if (!section_value.IsArray() || section_value.Size() != 4) {
+                throw std::runtime_error("section provided in lattice configuration is not an array of 4 numbers.");
+            }
+            double stiffnesses[4];
+            for (rapidjson::SizeType i = 0; i < 4; ++i) {
+                if (!section_value[i].IsNumber()) {
+                    throw std::runtime_error(
+                            "section provided in lattice configuration is not an array of 4 numbers.");
+                }
+                stiffnesses[i] = section_value[i].GetDouble();
+            }
+            const Props section(stiffnesses[0], stiffnesses[1], stiffnesses[2], stiffnesses[3], {0, 0, 0});
+
+            job = createLatticeJob(createUnitCell(type), cells.cast<int>(), cell_size, section);
+
+            if (lattice.HasMember("fixed_face")) {
+                const std::vector<BC> face_bcs =
+                        createFixedBCs(findFaceNodes(job, fea::getLatticeFace(lattice, "fixed_face")));
+                bcs.insert(bcs.end(), face_bcs.begin(), face_bcs.end());
+            }
+
+            if (lattice.HasMember("loaded_face") != lattice.HasMember("face_force")) {
+                throw std::runtime_error("loaded_face and face_force must be provided together in lattice "
+                                                 "configuration.");
+            }
+            if (lattice.HasMember("loaded_face")) {
+                const std::vector<Force> face_forces =
+                        createDistributedForces(findFaceNodes(job, fea::getLatticeFace(lattice, "loaded_face")),
+                                                fea::getLatticeVector(lattice, "face_force"));
+                forces.insert(forces.end(), face_forces.begin(), face_forces.end());
             }
-            forces_out[i] = Force((unsigned int) forces_vec[i][0], (unsigned int) forces_vec[i][1], forces_vec[i][2]);
         }
-        return forces_out;
-    }
 
-    std::vector<Tie> createTieVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > ties_vec;
-        fea::createVectorFromJSON(config_doc, "ties", ties_vec);
+        // Members of the configuration whose rows can be given inline.
+        enum RowMember {
+            NODES_MEMBER,
+            ELEMS_MEMBER,
+            PROPS_MEMBER,
+            PROP_IDS_MEMBER,
+            BCS_MEMBER,
+            FORCES_MEMBER,
+            TIES_MEMBER,
+            EQUATIONS_MEMBER,
+            NUM_ROW_MEMBERS
+        };
 
-        std::vector<Tie> ties_out(ties_vec.size());
+        const char *const ROW_MEMBER_NAMES[NUM_ROW_MEMBERS] = {"nodes", "elems", "props", "prop_ids", "bcs", "forces",
+                                                               "ties", "equations"};
 
-        for (size_t i = 0; i < ties_vec.size(); ++i) {
-            if (ties_vec[i].size() != 4) {
-                throw std::runtime_error(
-                        (boost::format("Row %d in ties does not specify [node number 1,node number 2,lmult,rmult].") %
-                         i).str()
-                );
+        /**
+         * Receives the rows of the inline arrays and writes them into the model.
+         */
+        struct StreamedRows {
+            explicit StreamedRows(Model &_model) : model(_model), forces(), load_case_ids() {
+                std::fill(is_streamed, is_streamed + NUM_ROW_MEMBERS, false);
+                std::fill(num_rows, num_rows + NUM_ROW_MEMBERS, 0);
+            }
+
+            Model &model;
+            std::vector<Force> forces;
+            std::vector<size_t> load_case_ids;
+            bool is_streamed[NUM_ROW_MEMBERS];
+            size_t num_rows[NUM_ROW_MEMBERS];
+
+            void append(RowMember member, const std::vector<double> &values) {
+                const size_t row = num_rows[member]++;
+                switch (member) {
+                    case NODES_MEMBER:
+                        fea::appendRow(NodeSink{model.job.nodes}, row, values);
+                        break;
+                    case ELEMS_MEMBER:
+                        fea::appendRow(ElemSink{model.job.elems}, row, values);
+                        break;
+                    case PROPS_MEMBER:
+                        fea::appendRow(PropsSink{model.job.props}, row, values);
+                        break;
+                    case PROP_IDS_MEMBER:
+                        fea::appendRow(PropIdSink{model.job.prop_ids}, row, values);
+                        break;
+                    case BCS_MEMBER:
+                        fea::appendRow(BCSink{model.bcs}, row, values);
+                        break;
+                    case FORCES_MEMBER:
+                        fea::appendRow(ForceSink{forces, load_case_ids, true}, row, values);
+                        break;
+                    case TIES_MEMBER:
+                        fea::appendRow(TieSink{model.ties}, row, values);
+                        break;
+                    default:
+                        fea::appendRow(EquationSink{model.equations}, row, values);
+                        break;
+                }
+            }
+        };
+
+        /**
+         * SAX handler that streams the inline arrays of the top level row members into `rows` one row at a time
+         * and forwards everything else, e.g. file names and options, to a `rapidjson::Document`.
+         */
+        class ConfigHandler {
+        public:
+            ConfigHandler(rapidjson::Document &_doc, StreamedRows &_rows)
+                    : doc(_doc), rows(_rows), depth(0), has_pending_key(false), pending_member(NODES_MEMBER),
+                      is_streaming(false), member(NODES_MEMBER), row_depth(0), num_streamed_members(0) { };
+
+            bool Null() { return beginValue() && doc.Null(); }
+
+            bool Bool(bool b) { return beginValue() && doc.Bool(b); }
+
+            bool Int(int i) { return is_streaming ? addNumber(i) : beginValue() && doc.Int(i); }
+
+            bool Uint(unsigned int i) { return is_streaming ? addNumber(i) : beginValue() && doc.Uint(i); }
+
+            bool Int64(int64_t i) { return is_streaming ? addNumber(i) : beginValue() && doc.Int64(i); }
+
+            bool Uint64(uint64_t i) { return is_streaming ? addNumber(i) : beginValue() && doc.Uint64(i); }
+
+            bool Double(double d) { return is_streaming ? addNumber(d) : beginValue() && doc.Double(d); }
+
+            bool RawNumber(const char *str, rapidjson::SizeType length, bool copy) {
+                return beginValue() && doc.RawNumber(str, length, copy);
+            }
+
+            bool String(const char *str, rapidjson::SizeType length, bool copy) {
+                return beginValue() && doc.String(str, length, copy);
+            }
+
+            bool StartObject() {
+                ++depth;
+                return beginValue() && doc.StartObject();
+            }
+
+            bool Key(const char *str, rapidjson::SizeType length, bool copy) {
+                if (depth == 1) {
+                    for (int i = 0; i < NUM_ROW_MEMBERS; ++i) {
+                        if (std::string(str, length) == ROW_MEMBER_NAMES[i]) {
+                            // hold the key back until it is known whether the value is streamed
+                            has_pending_key = true;
+                            pending_member = static_cast<RowMember>(i);
+                            return true;
+                        }
+                    }
+                }
+                return doc.Key(str, length, copy);
+            }
+
+            bool EndObject(rapidjson::SizeType member_count) {
+                --depth;
+                return doc.EndObject(depth == 0 ? member_count - num_streamed_members : member_count);
             }
-            ties_out[i] = Tie((unsigned int) ties_vec[i][0], (unsigned int) ties_vec[i][1], ties_vec[i][2],
-                              ties_vec[i][3]);
+
+            bool StartArray() {
+                if (is_streaming) {
+                    if (row_depth != 0) {
+                        fea::throwInvalidRow(ROW_MEMBER_NAMES[member], rows.num_rows[member]);
+                    }
+                    row_depth = 1;
+                    values.clear();
+                    return true;
+                }
+                if (has_pending_key) {
+                    has_pending_key = false;
+                    is_streaming = true;
+                    member = pending_member;
+                    rows.is_streamed[member] = true;
+                    return true;
+                }
+                ++depth;
+                return doc.StartArray();
+            }
+
+            bool EndArray(rapidjson::SizeType element_count) {
+                if (is_streaming) {
+                    if (row_depth == 1) {
+                        rows.append(member, values);
+                        row_depth = 0;
+                    }
+                    else {
+                        is_streaming = false;
+                        ++num_streamed_members;
+                    }
+                    return true;
+                }
+                --depth;
+                return doc.EndArray(element_count);
+            }
+
+        private:
+            /**
+             * Forwards the key that was held back if the value is not an inline array.
+             */
+            bool beginValue() {
+                if (is_streaming) {
+                    fea::throwInvalidRow(ROW_MEMBER_NAMES[member], rows.num_rows[member]);
+                }
+                if (has_pending_key) {
+                    has_pending_key = false;
+                    const char *name = ROW_MEMBER_NAMES[pending_member];
+                    return doc.Key(name, static_cast<rapidjson::SizeType>(std::strlen(name)), true);
+                }
+                return true;
+            }
+
+            bool addNumber(double value) {
+                if (row_depth != 1) {
+                    fea::throwInvalidRow(ROW_MEMBER_NAMES[member], rows.num_rows[member]);
+                }
+                values.push_back(value);
+                return true;
+            }
+
+            rapidjson::Document &doc;
+            StreamedRows &rows;
+            int depth;
+            bool has_pending_key;
+            RowMember pending_member;
+            bool is_streaming;
+            RowMember member;
+            int row_depth;
+            rapidjson::SizeType num_streamed_members;
+            std::vector<double> values;
+        };
+
+        struct ConfigGenerator {
+            rapidjson::FileReadStream &stream;
+            rapidjson::Reader &reader;
+            StreamedRows &rows;
+
+            bool operator()(rapidjson::Document &doc) {
+                ConfigHandler handler(doc, rows);
+                return !reader.Parse<rapidjson::kParseFullPrecisionFlag>(stream, handler).IsError();
+            }
+        };
+
+        /**
+         * Loads the rows of one member. Members that were streamed from an inline array are only checked.
+         */
+        struct LoadTask {
+            RowMember member;
+            std::function<void()> load;
+        };
+
+        template<typename RowSink>
+        LoadTask makeLoadTask(const rapidjson::Document &config_doc,
+                              const StreamedRows &rows,
+                              RowMember member,
+                              RowSink sink) {
+            LoadTask task;
+            task.member = member;
+            task.load = [&config_doc, &rows, member, sink]() mutable {
+                if (!rows.is_streamed[member]) {
+                    fea::parseRowsFromJSON(config_doc, ROW_MEMBER_NAMES[member], sink);
+                }
+                else if (rows.num_rows[member] == 0) {
+                    throw std::runtime_error(
+                            (boost::format("No data was loaded for variable %s.") % ROW_MEMBER_NAMES[member]).str()
+                    );
+                }
+            };
+            return task;
         }
-        return ties_out;
-    }
 
-    std::vector<Equation> createEquationVecFromJSON(const rapidjson::Document &config_doc) {
-        std::vector< std::vector<double> > eqns_vec;
-        fea::createVectorFromJSON(config_doc, "equations", eqns_vec);
+        bool hasRows(const rapidjson::Document &config_doc, const StreamedRows &rows, RowMember member) {
+            return rows.is_streamed[member] || config_doc.HasMember(ROW_MEMBER_NAMES[member]);
+        }
+
+        /**
+         * Loads the rows of all members of the configuration into `model`. The members are independent, so they are
+         * loaded by a pool of at most one worker per core, which share the OpenMP threads. All workers are joined before
+         * the rows are checked against each other, and the load time of each csv file is added to `model.input_load_times`.
+         */
+        void loadRowsConcurrently(const rapidjson::Document &config_doc, StreamedRows &rows, Model &model) {
+            const bool has_lattice = config_doc.HasMember("lattice");
+            if (has_lattice && (fea::hasRows(config_doc, rows, NODES_MEMBER)
+                                || fea::hasRows(config_doc, rows, ELEMS_MEMBER)
+                                || fea::hasRows(config_doc, rows, PROPS_MEMBER)
+                                || fea::hasRows(config_doc, rows, PROP_IDS_MEMBER))) {
+                throw std::runtime_error("The lattice member cannot be combined with nodes, elems, props or "
+                                                 "prop_ids.");
+            }
+
+            std::vector<LoadTask> tasks;
+            if (!has_lattice) {
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, NODES_MEMBER, NodeSink{model.job.nodes}));
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, ELEMS_MEMBER, ElemSink{model.job.elems}));
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, PROPS_MEMBER, PropsSink{model.job.props}));
+            }
+            if (fea::hasRows(config_doc, rows, PROP_IDS_MEMBER)) {
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, PROP_IDS_MEMBER, PropIdSink{model.job.prop_ids}));
+            }
+            if (fea::hasRows(config_doc, rows, TIES_MEMBER)) {
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, TIES_MEMBER, TieSink{model.ties}));
+            }
+            if (fea::hasRows(config_doc, rows, BCS_MEMBER)) {
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, BCS_MEMBER, BCSink{model.bcs}));
+            }
+            if (fea::hasRows(config_doc, rows, FORCES_MEMBER)) {
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, FORCES_MEMBER,
+                                                  ForceSink{rows.forces, rows.load_case_ids, true}));
+            }
+            if (fea::hasRows(config_doc, rows, EQUATIONS_MEMBER)) {
+                tasks.push_back(fea::makeLoadTask(config_doc, rows, EQUATIONS_MEMBER,
+                                                  EquationSink{model.equations}));
+            }
+
+            // a bounded pool of workers takes the files one at a time. The cores are shared between the workers, so
+            // the parallel parsing of each file does not oversubscribe the machine.
+            const size_t num_workers = std::min<size_t>(tasks.size(),
+                                                        std::max(1u, std::thread::hardware_concurrency()));
+            int threads_per_worker = 1;
+#ifdef _OPENMP
+            if (num_workers > 0) {
+                threads_per_worker = std::max(1, omp_get_max_threads() / static_cast<int>(num_workers));
+            }
+#endif
+            std::vector<long long> load_times(tasks.size(), 0);
+            std::vector<std::exception_ptr> errors(tasks.size());
+            std::atomic<size_t> next_task(0);
+            auto work = [&]() {
+#ifdef _OPENMP
+                omp_set_num_threads(threads_per_worker);
+#endif
+                for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+                    try {
+                        auto start_time = std::chrono::high_resolution_clock::now();
+                        tasks[i].load();
+                        auto end_time = std::chrono::high_resolution_clock::now();
+                        load_times[i] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                end_time - start_time).count();
+                    }
+                    catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                }
+            };
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < num_workers; ++i) {
+                workers.push_back(std::thread(work));
+            }
+            for (size_t i = 0; i < workers.size(); ++i) {
+                workers[i].join();
+            }
 
-        std::vector<Equation> eqns_out(eqns_vec.size());
+            // every file was loaded before rethrowing, so the error of the first member is reported
+            std::exception_ptr error;
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                if (errors[i]) {
+                    if (!error) {
+                        error = errors[i];
+                    }
+                    continue;
+                }
+                const char *name = ROW_MEMBER_NAMES[tasks[i].member];
+                if (!rows.is_streamed[tasks[i].member] && config_doc[name].IsString()) {
+                    model.input_load_times.push_back(InputLoadTime(name, config_doc[name].GetString(), load_times[i]));
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
 
-        for (size_t i = 0; i < eqns_vec.size(); ++i) {
-            if (eqns_vec[i].size() % 3 != 0) {
+            if (has_lattice) {
+                // the lattice is generated in memory once the files are loaded, its forces belong to the first load
+                // case
+                auto start_time = std::chrono::high_resolution_clock::now();
+                std::vector<Force> lattice_forces;
+                fea::createLatticeFromJSON(config_doc["lattice"], model.job, model.bcs, lattice_forces);
+                rows.forces.insert(rows.forces.end(), lattice_forces.begin(), lattice_forces.end());
+                rows.load_case_ids.resize(rows.forces.size(), 0);
+                auto end_time = std::chrono::high_resolution_clock::now();
+                model.input_load_times.push_back(InputLoadTime(
+                        "lattice", std::string(config_doc["lattice"]["unit_cell"].GetString()) + " unit cell",
+                        std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()));
+            }
+            else {
+                fea::checkElemProps(model.job.elems.size(), model.job.props.size(), model.job.prop_ids,
+                                    fea::hasRows(config_doc, rows, PROP_IDS_MEMBER));
+            }
+            if (!rows.forces.empty() || fea::hasRows(config_doc, rows, FORCES_MEMBER)) {
+                model.load_cases = fea::groupLoadCases(rows.forces, rows.load_case_ids);
+            }
+        }
+
+        /**
+         * Reads the configuration file with a SAX parser. Inline arrays are written straight into `model`, while
+         * the rest of the configuration is kept in `config_doc`.
+         */
+        void loadModelFromJSONFile(const std::string &config_filename, Model &model, rapidjson::Document &config_doc) {
+            auto start_time = std::chrono::high_resolution_clock::now();
+
+            FILE *config_file_ptr = fopen(config_filename.c_str(), "r");
+            if (!config_file_ptr) {
                 throw std::runtime_error(
-                        (boost::format("Row %d in equations does not specify [node number,dof,coefficient,...] for each term.") %
-                         i).str()
+                        (boost::format("Cannot open configuration input file %s.") % config_filename).str()
                 );
             }
 
-            Equation eqn;
-            for (size_t j = 0; j < eqns_vec[i].size() / 3; ++j) {
-                eqn.terms.push_back(Equation::Term(
-                    (unsigned int) eqns_vec[i][3 * j],
-                    (unsigned int) eqns_vec[i][3 * j + 1],
-                    eqns_vec[i][3 * j + 2]));
+            char readBuffer[65536];
+            rapidjson::FileReadStream config_stream(config_file_ptr, readBuffer, sizeof(readBuffer));
+            rapidjson::Reader reader;
+            StreamedRows rows(model);
+            ConfigGenerator generator = {config_stream, reader, rows};
+            try {
+                config_doc.Populate(generator);
+            }
+            catch (...) {
+                fclose(config_file_ptr);
+                throw;
+            }
+            fclose(config_file_ptr);
+
+            if (reader.HasParseError()) {
+                throw std::runtime_error(
+                        (boost::format("Error parsing configuration file %s at offset %d: %s")
+                         % config_filename % reader.GetErrorOffset()
+                         % rapidjson::GetParseError_En(reader.GetParseErrorCode())).str()
+                );
             }
-            eqns_out[i] = eqn;
+            if (!config_doc.IsObject()) {
+                throw std::runtime_error(
+                        (boost::format("Configuration file %s is not a json object.") % config_filename).str()
+                );
+            }
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            model.input_load_times.push_back(InputLoadTime(
+                    "config", config_filename,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()));
+
+            fea::loadRowsConcurrently(config_doc, rows, model);
+            model.options = createOptionsFromJSON(config_doc);
+        }
+    }
+
+    rapidjson::Document parseJSONConfig(const std::string &config_filename) {
+        rapidjson::Document config_doc;
+
+        FILE *config_file_ptr = fopen(config_filename.c_str(), "r");
+
+        if (!config_file_ptr) {
+            throw std::runtime_error(
+                    (boost::format("Cannot open configuration input file %s.") % config_filename).str()
+            );
+        }
+        char readBuffer[65536];
+        rapidjson::FileReadStream config_stream(config_file_ptr, readBuffer, sizeof(readBuffer));
+        config_doc.ParseStream<rapidjson::kParseFullPrecisionFlag>(config_stream);
+        fclose(config_file_ptr);
+        return config_doc;
+    }
+
+    std::vector<Node> createNodeVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<Node> nodes_out;
+        NodeSink sink = {nodes_out};
+        fea::parseRowsFromJSON(config_doc, "nodes", sink);
+        return nodes_out;
+    }
+
+    std::vector<Elem> createElemVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<Eigen::Vector2i> elems;
+        std::vector<Props> props;
+        std::vector<unsigned int> prop_ids;
+        fea::parseElemsAndPropsFromJSON(config_doc, elems, props, prop_ids);
+
+        std::vector<Elem> elems_out(elems.size());
+        for (size_t i = 0; i < elems.size(); ++i) {
+            elems_out[i].node_numbers = elems[i];
+            elems_out[i].props = props[prop_ids.empty() ? i : prop_ids[i]];
         }
+        return elems_out;
+    }
+
+    std::vector<BC> createBCVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<BC> bcs_out;
+        BCSink sink = {bcs_out};
+        fea::parseRowsFromJSON(config_doc, "bcs", sink);
+        return bcs_out;
+    }
+
+    std::vector<Force> createForceVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<Force> forces_out;
+        std::vector<size_t> load_case_ids;
+        ForceSink sink = {forces_out, load_case_ids, false};
+        fea::parseRowsFromJSON(config_doc, "forces", sink);
+        return forces_out;
+    }
+
+    std::vector<std::vector<Force> > createLoadCasesFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<Force> forces;
+        std::vector<size_t> load_case_ids;
+        ForceSink sink = {forces, load_case_ids, true};
+        fea::parseRowsFromJSON(config_doc, "forces", sink);
+
+        return fea::groupLoadCases(forces, load_case_ids);
+    }
+
+    std::vector<Tie> createTieVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<Tie> ties_out;
+        TieSink sink = {ties_out};
+        fea::parseRowsFromJSON(config_doc, "ties", sink);
+        return ties_out;
+    }
+
+    std::vector<Equation> createEquationVecFromJSON(const rapidjson::Document &config_doc) {
+        std::vector<Equation> eqns_out;
+        EquationSink sink = {eqns_out};
+        fea::parseRowsFromJSON(config_doc, "equations", sink);
         return eqns_out;
     }
 
     Job createJobFromJSON(const rapidjson::Document &config_doc) {
-        std::vector<Node> nodes = createNodeVecFromJSON(config_doc);
-        std::vector<Elem> elems = createElemVecFromJSON(config_doc);
-        return Job(nodes, elems);
+        Job job;
+        if (config_doc.HasMember("lattice")) {
+            std::vector<BC> bcs;
+            std::vector<Force> forces;
+            fea::createLatticeFromJSON(config_doc["lattice"], job, bcs, forces);
+            return job;
+        }
+
+        // parse straight into the job's containers instead of going through std::vector<Elem>
+        NodeSink node_sink = {job.nodes};
+        fea::parseRowsFromJSON(config_doc, "nodes", node_sink);
+        fea::parseElemsAndPropsFromJSON(config_doc, job.elems, job.props, job.prop_ids);
+        return job;
     }
 
     Options createOptionsFromJSON(const rapidjson::Document &config_doc) {
@@ -235,6 +997,24 @@ namespace fea {
                 }
                 options.csv_delimiter = config_doc["options"]["csv_delimiter"].GetString();
             }
+            if (config_doc["options"].HasMember("result_format")) {
+                if (!config_doc["options"]["result_format"].IsString()) {
+                    throw std::runtime_error("result_format provided in options configuration is not a string.");
+                }
+                const std::string result_format = config_doc["options"]["result_format"].GetString();
+                if (result_format == "csv") {
+                    options.result_format = CSV_RESULTS;
+                }
+                else if (result_format == "npy") {
+                    options.result_format = NPY_RESULTS;
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("result_format provided in options configuration must be "
+                                           "\"csv\" or \"npy\", not \"%s\".") % result_format).str()
+                    );
+                }
+            }
             if (config_doc["options"].HasMember("save_nodal_displacements")) {
                 if (!config_doc["options"]["save_nodal_displacements"].IsBool()) {
                     throw std::runtime_error(
@@ -266,6 +1046,157 @@ namespace fea {
                 }
                 options.save_report = config_doc["options"]["save_report"].GetBool();
             }
+            if (config_doc["options"].HasMember("save_vtu")) {
+                if (!config_doc["options"]["save_vtu"].IsBool()) {
+                    throw std::runtime_error("save_vtu provided in options configuration is not a bool.");
+                }
+                options.save_vtu = config_doc["options"]["save_vtu"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_nodal_forces")) {
+                if (!config_doc["options"]["compute_nodal_forces"].IsBool()) {
+                    throw std::runtime_error("compute_nodal_forces provided in options configuration is not a bool.");
+                }
+                options.compute_nodal_forces = config_doc["options"]["compute_nodal_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_reaction_forces")) {
+                if (!config_doc["options"]["compute_reaction_forces"].IsBool()) {
+                    throw std::runtime_error("compute_reaction_forces provided in options configuration is not a bool.");
+                }
+                options.compute_reaction_forces = config_doc["options"]["compute_reaction_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_tie_forces")) {
+                if (!config_doc["options"]["compute_tie_forces"].IsBool()) {
+                    throw std::runtime_error("compute_tie_forces provided in options configuration is not a bool.");
+                }
+                options.compute_tie_forces = config_doc["options"]["compute_tie_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("compute_elem_forces")) {
+                if (!config_doc["options"]["compute_elem_forces"].IsBool()) {
+                    throw std::runtime_error("compute_elem_forces provided in options configuration is not a bool.");
+                }
+                options.compute_elem_forces = config_doc["options"]["compute_elem_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("save_elem_forces")) {
+                if (!config_doc["options"]["save_elem_forces"].IsBool()) {
+                    throw std::runtime_error("save_elem_forces provided in options configuration is not a bool.");
+                }
+                options.save_elem_forces = config_doc["options"]["save_elem_forces"].GetBool();
+            }
+            if (config_doc["options"].HasMember("num_largest_values")) {
+                if (!config_doc["options"]["num_largest_values"].IsUint()) {
+                    throw std::runtime_error(
+                            "num_largest_values provided in options configuration is not a non-negative integer.");
+                }
+                options.num_largest_values = config_doc["options"]["num_largest_values"].GetUint();
+            }
+            if (config_doc["options"].HasMember("num_histogram_bins")) {
+                if (!config_doc["options"]["num_histogram_bins"].IsUint()) {
+                    throw std::runtime_error(
+                            "num_histogram_bins provided in options configuration is not a non-negative integer.");
+                }
+                options.num_histogram_bins = config_doc["options"]["num_histogram_bins"].GetUint();
+            }
+            if (config_doc["options"].HasMember("num_threads")) {
+                if (!config_doc["options"]["num_threads"].IsUint()) {
+                    throw std::runtime_error(
+                            "num_threads provided in options configuration is not a non-negative integer.");
+                }
+                options.num_threads = config_doc["options"]["num_threads"].GetUint();
+            }
+            if (config_doc["options"].HasMember("use_sparsity_pattern")) {
+                if (!config_doc["options"]["use_sparsity_pattern"].IsBool()) {
+                    throw std::runtime_error("use_sparsity_pattern provided in options configuration is not a bool.");
+                }
+                options.use_sparsity_pattern = config_doc["options"]["use_sparsity_pattern"].GetBool();
+            }
+            if (config_doc["options"].HasMember("linear_solver")) {
+                if (!config_doc["options"]["linear_solver"].IsString()) {
+                    throw std::runtime_error("linear_solver provided in options configuration is not a string.");
+                }
+                const std::string linear_solver = config_doc["options"]["linear_solver"].GetString();
+                if (linear_solver == "lu") {
+                    options.linear_solver = SPARSE_LU;
+                }
+                else if (linear_solver == "ldlt") {
+                    options.linear_solver = SPARSE_LDLT;
+                }
+                else if (linear_solver == "cg") {
+                    options.linear_solver = CONJUGATE_GRADIENT;
+                }
+                else if (linear_solver == "minres") {
+                    options.linear_solver = MINRES;
+                }
+                else if (linear_solver == "gmres") {
+                    options.linear_solver = GMRES;
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("linear_solver provided in options configuration must be \"lu\", "
+                                           "\"ldlt\", \"cg\", \"minres\" or \"gmres\", not \"%s\".")
+                             % linear_solver).str()
+                    );
+                }
+            }
+            if (config_doc["options"].HasMember("preconditioner")) {
+                if (!config_doc["options"]["preconditioner"].IsString()) {
+                    throw std::runtime_error("preconditioner provided in options configuration is not a string.");
+                }
+                const std::string preconditioner = config_doc["options"]["preconditioner"].GetString();
+                if (preconditioner == "block_jacobi") {
+                    options.preconditioner = BLOCK_JACOBI;
+                }
+                else if (preconditioner == "incomplete_cholesky") {
+                    options.preconditioner = INCOMPLETE_CHOLESKY;
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("preconditioner provided in options configuration must be "
+                                           "\"block_jacobi\" or \"incomplete_cholesky\", not \"%s\".")
+                             % preconditioner).str()
+                    );
+                }
+            }
+            if (config_doc["options"].HasMember("tolerance")) {
+                if (!config_doc["options"]["tolerance"].IsNumber()) {
+                    throw std::runtime_error("tolerance provided in options configuration is not a number.");
+                }
+                options.tolerance = config_doc["options"]["tolerance"].GetDouble();
+            }
+            if (config_doc["options"].HasMember("max_iterations")) {
+                if (!config_doc["options"]["max_iterations"].IsUint()) {
+                    throw std::runtime_error(
+                            "max_iterations provided in options configuration is not a non-negative integer.");
+                }
+                options.max_iterations = config_doc["options"]["max_iterations"].GetUint();
+            }
+            if (config_doc["options"].HasMember("node_ordering")) {
+                if (!config_doc["options"]["node_ordering"].IsString()) {
+                    throw std::runtime_error("node_ordering provided in options configuration is not a string.");
+                }
+                const std::string node_ordering = config_doc["options"]["node_ordering"].GetString();
+                if (node_ordering == "original") {
+                    options.node_ordering = ORIGINAL_ORDER;
+                }
+                else if (node_ordering == "rcm") {
+                    options.node_ordering = REVERSE_CUTHILL_MCKEE;
+                }
+                else if (node_ordering == "hilbert") {
+                    options.node_ordering = HILBERT_CURVE;
+                }
+                else {
+                    throw std::runtime_error(
+                            (boost::format("node_ordering provided in options configuration must be "
+                                           "\"original\", \"rcm\" or \"hilbert\", not \"%s\".")
+                             % node_ordering).str()
+                    );
+                }
+            }
+            if (config_doc["options"].HasMember("eliminate_bcs")) {
+                if (!config_doc["options"]["eliminate_bcs"].IsBool()) {
+                    throw std::runtime_error("eliminate_bcs provided in options configuration is not a bool.");
+                }
+                options.eliminate_bcs = config_doc["options"]["eliminate_bcs"].GetBool();
+            }
             if (config_doc["options"].HasMember("nodal_displacements_filename")) {
                 if (!config_doc["options"]["nodal_displacements_filename"].IsString()) {
                     throw std::runtime_error(
@@ -292,7 +1223,122 @@ namespace fea {
                 }
                 options.report_filename = config_doc["options"]["report_filename"].GetString();
             }
+            if (config_doc["options"].HasMember("elem_forces_filename")) {
+                if (!config_doc["options"]["elem_forces_filename"].IsString()) {
+                    throw std::runtime_error(
+                            "elem_forces_filename provided in options configuration is not a string.");
+                }
+                options.elem_forces_filename = config_doc["options"]["elem_forces_filename"].GetString();
+            }
+            if (config_doc["options"].HasMember("vtu_filename")) {
+                if (!config_doc["options"]["vtu_filename"].IsString()) {
+                    throw std::runtime_error("vtu_filename provided in options configuration is not a string.");
+                }
+                options.vtu_filename = config_doc["options"]["vtu_filename"].GetString();
+            }
         }
         return options;
     }
+
+    std::string createJSONFromOptions(const Options &options) {
+        const char *linear_solvers[] = {"lu", "ldlt", "cg", "minres", "gmres"};
+        const char *preconditioners[] = {"block_jacobi", "incomplete_cholesky"};
+        const char *node_orderings[] = {"original", "rcm", "hilbert"};
+        const char *result_formats[] = {"csv", "npy"};
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("epsilon");
+        writer.Double(options.epsilon);
+        writer.Key("csv_precision");
+        writer.Uint(options.csv_precision);
+        writer.Key("csv_delimiter");
+        writer.String(options.csv_delimiter.c_str());
+        writer.Key("result_format");
+        writer.String(result_formats[options.result_format]);
+        writer.Key("save_nodal_displacements");
+        writer.Bool(options.save_nodal_displacements);
+        writer.Key("save_nodal_forces");
+        writer.Bool(options.save_nodal_forces);
+        writer.Key("save_tie_forces");
+        writer.Bool(options.save_tie_forces);
+        writer.Key("verbose");
+        writer.Bool(options.verbose);
+        writer.Key("save_report");
+        writer.Bool(options.save_report);
+        writer.Key("save_vtu");
+        writer.Bool(options.save_vtu);
+        writer.Key("compute_nodal_forces");
+        writer.Bool(options.compute_nodal_forces);
+        writer.Key("compute_reaction_forces");
+        writer.Bool(options.compute_reaction_forces);
+        writer.Key("compute_tie_forces");
+        writer.Bool(options.compute_tie_forces);
+        writer.Key("compute_elem_forces");
+        writer.Bool(options.compute_elem_forces);
+        writer.Key("save_elem_forces");
+        writer.Bool(options.save_elem_forces);
+        writer.Key("num_largest_values");
+        writer.Uint(options.num_largest_values);
+        writer.Key("num_histogram_bins");
+        writer.Uint(options.num_histogram_bins);
+        writer.Key("num_threads");
+        writer.Uint(options.num_threads);
+        writer.Key("use_sparsity_pattern");
+        writer.Bool(options.use_sparsity_pattern);
+        writer.Key("linear_solver");
+        writer.String(linear_solvers[options.linear_solver]);
+        writer.Key("preconditioner");
+        writer.String(preconditioners[options.preconditioner]);
+        writer.Key("tolerance");
+        writer.Double(options.tolerance);
+        writer.Key("max_iterations");
+        writer.Uint(options.max_iterations);
+        writer.Key("node_ordering");
+        writer.String(node_orderings[options.node_ordering]);
+        writer.Key("eliminate_bcs");
+        writer.Bool(options.eliminate_bcs);
+        writer.Key("nodal_displacements_filename");
+        writer.String(options.nodal_displacements_filename.c_str());
+        writer.Key("nodal_forces_filename");
+        writer.String(options.nodal_forces_filename.c_str());
+        writer.Key("tie_forces_filename");
+        writer.String(options.tie_forces_filename.c_str());
+        writer.Key("report_filename");
+        writer.String(options.report_filename.c_str());
+        writer.Key("elem_forces_filename");
+        writer.String(options.elem_forces_filename.c_str());
+        writer.Key("vtu_filename");
+        writer.String(options.vtu_filename.c_str());
+        writer.EndObject();
+        return buffer.GetString();
+    }
+
+    Model createModelFromJSON(const rapidjson::Document &config_doc) {
+        Model model;
+        StreamedRows rows(model);
+        fea::loadRowsConcurrently(config_doc, rows, model);
+        model.options = createOptionsFromJSON(config_doc);
+        return model;
+    }
+
+    void convertJSONToModelFile(const rapidjson::Document &config_doc, const std::string &model_filename) {
+        writeModelFile(model_filename, createModelFromJSON(config_doc));
+    }
+
+    Model createModelFromJSONFile(const std::string &config_filename) {
+        Model model;
+        rapidjson::Document config_doc;
+        fea::loadModelFromJSONFile(config_filename, model, config_doc);
+        return model;
+    }
+
+    void convertJSONFileToModelFile(const std::string &config_filename, const std::string &model_filename) {
+        Model model;
+        rapidjson::Document config_doc;
+        fea::loadModelFromJSONFile(config_filename, model, config_doc);
+        writeModelFile(model_filename, model);
+    }
+
 } // namespace fea
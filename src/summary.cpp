@@ -25,7 +25,6 @@
 
 #include <iomanip>
 #include <algorithm>
-#include <limits>
 #include "summary.h"
 #include "boost/format.hpp"
 
@@ -36,38 +35,64 @@ namespace fea {
         typedef std::pair<std::string, unsigned int> fe_param_pair;
         typedef std::pair<std::string, long long> timing_param_pair;
 
-        struct Location2D {
-            Location2D() : row(0), col(0) { };
-
-            Location2D(size_t _row, size_t _col) : row(_row), col(_col) { };
-
-            size_t row;
-            size_t col;
-        };
+        // Returns the column holding the smallest or, if find_max is set, the largest value of all columns. Of
+        // several equal values the first in row-major order is taken, as when scanning the results row by row.
+        size_t findExtremeColumn(const ResultStatistics &statistics, bool find_max) {
+            size_t extreme_col = 0;
+            for (size_t j = 1; j < statistics.columns.size(); ++j) {
+                const RowValue &best = find_max ? statistics.columns[extreme_col].max
+                                                : statistics.columns[extreme_col].min;
+                const RowValue &candidate = find_max ? statistics.columns[j].max : statistics.columns[j].min;
+                const bool is_better = find_max ? candidate.value > best.value : candidate.value < best.value;
+                if (is_better || (candidate.value == best.value && candidate.row < best.row)) {
+                    extreme_col = j;
+                }
+            }
+            return extreme_col;
+        }
 
-        template<typename T>
-        std::pair<Location2D, Location2D> findMinMax2D(std::vector<std::vector<T>> input) {
-            Location2D min_elem, max_elem;
-            T min_val = std::numeric_limits<T>::max();
-            T max_val = -std::numeric_limits<T>::max();
+        // Appends the extrema over all degrees of freedom followed by the statistics of each degree of freedom.
+        void appendStatistics(std::string &report,
+                              const std::string &title,
+                              const std::string &row_name,
+                              const ResultStatistics &statistics) {
+            if (statistics.num_rows == 0) {
+                return;
+            }
 
-            const size_t num_cols = input[0].size();
+            const size_t min_col = findExtremeColumn(statistics, false);
+            const size_t max_col = findExtremeColumn(statistics, true);
+            const RowValue &min = statistics.columns[min_col].min;
+            const RowValue &max = statistics.columns[max_col].max;
+            report.append(
+                    (boost::format("\n%s\n\tMinimum : %s %d\tDOF %d\tValue %.3f\n"
+                                   "\tMaximum : %s %d\tDOF %d\tValue %.3f\n")
+                     % title % row_name % min.row % min_col % min.value
+                     % row_name % max.row % max_col % max.value).str()
+            );
 
-            for (size_t i = 0; i < input.size(); ++i) {
-                for (size_t j = 0; j < num_cols; ++j) {
-                    if (input[i][j] > max_val) {
-                        max_elem.row = i;
-                        max_elem.col = j;
-                        max_val = input[i][j];
+            for (size_t j = 0; j < statistics.columns.size(); ++j) {
+                const ColumnStatistics &column = statistics.columns[j];
+                report.append(
+                        (boost::format("\tDOF %d : Mean %.3e\tRMS %.3e\n") % j % column.mean % column.rms).str()
+                );
+                if (!column.largest.empty()) {
+                    report.append("\t\tLargest magnitudes :");
+                    for (size_t k = 0; k < column.largest.size(); ++k) {
+                        report.append((boost::format(" %s %d (%.3e)") % row_name % column.largest[k].row
+                                       % column.largest[k].value).str());
                     }
-                    if (input[i][j] < min_val) {
-                        min_elem.row = i;
-                        min_elem.col = j;
-                        min_val = input[i][j];
+                    report.append("\n");
+                }
+                if (!column.histogram.empty()) {
+                    report.append((boost::format("\t\tHistogram [%.3e, %.3e] :") % column.histogram_min
+                                   % column.histogram_max).str());
+                    for (size_t b = 0; b < column.histogram.size(); ++b) {
+                        report.append((boost::format(" %d") % column.histogram[b]).str());
                     }
+                    report.append("\n");
                 }
             }
-            return std::pair<Location2D, Location2D>(min_elem, max_elem);
         }
 
         template<class T>
@@ -90,6 +115,7 @@ namespace fea {
               solve_time_in_ms(0),
               nodal_forces_solve_time_in_ms(0),
               tie_forces_solve_time_in_ms(0),
+              elem_forces_solve_time_in_ms(0),
               file_save_time_in_ms(0),
               num_nodes(0),
               num_elems(0),
@@ -97,9 +123,11 @@ namespace fea {
               num_forces(0),
               num_ties(0),
               num_eqns(0),
-              nodal_displacements(0),
-              nodal_forces(0),
-              tie_forces(0) {
+              num_stiffness_nonzeros(0),
+              linear_solver(""),
+              iterations(0),
+              residual(0.0),
+              reaction_forces(0) {
 
     }
 
@@ -135,12 +163,19 @@ namespace fea {
             );
         }
 
+        // write how the linear system was solved
+        report.append((boost::format("\nLinear solver\n\t%s : %d nonzeros\n") % linear_solver %
+                       num_stiffness_nonzeros).str());
+        if (iterations > 0) {
+            report.append((boost::format("\t%d iterations, relative residual %.3e\n") % iterations % residual).str());
+        }
+
         // write the total time the analysis took
         report.append((boost::format("\n%s %dms\n") % "Total time" % total_time_in_ms).str());
 
         // define timing data to write to report
         std::vector<timing_param_pair> timing_params;
-        timing_params.reserve(7);
+        timing_params.reserve(8);
         timing_params.push_back(timing_param_pair("Assembly time", assembly_time_in_ms));
         timing_params.push_back(timing_param_pair("Preprocessesing time", preprocessing_time_in_ms));
         timing_params.push_back(timing_param_pair("Factorization time", factorization_time_in_ms));
@@ -149,6 +184,9 @@ namespace fea {
         if (num_ties > 0) {
             timing_params.push_back(timing_param_pair("Ties solve time", tie_forces_solve_time_in_ms));
         }
+        if (elem_forces.rows() > 0) {
+            timing_params.push_back(timing_param_pair("Element forces solve time", elem_forces_solve_time_in_ms));
+        }
         timing_params.push_back(timing_param_pair("File save time", file_save_time_in_ms));
 
         max_digits = 1;
@@ -170,34 +208,10 @@ namespace fea {
             );
         }
 
-        auto minmax = findMinMax2D(nodal_displacements);
-
-        report.append(
-                (boost::format(
-                        "\nNodal displacements\n\tMinimum : Node %d\tDOF %d\tValue %.3f\n\tMaximum : Node %d\tDOF %d\tValue %.3f\n")
-                 % minmax.first.row % minmax.first.col % nodal_displacements[minmax.first.row][minmax.first.col]
-                 % minmax.second.row % minmax.second.col %
-                 nodal_displacements[minmax.second.row][minmax.second.col]).str()
-        );
-
-        minmax = findMinMax2D(nodal_forces);
-
-        report.append(
-                (boost::format(
-                        "\nNodal Forces\n\tMinimum : Node %d\tDOF %d\tValue %.3f\n\tMaximum : Node %d\tDOF %d\tValue %.3f\n")
-                 % minmax.first.row % minmax.first.col % nodal_forces[minmax.first.row][minmax.first.col]
-                 % minmax.second.row % minmax.second.col % nodal_forces[minmax.second.row][minmax.second.col]).str()
-        );
-
+        appendStatistics(report, "Nodal displacements", "Node", nodal_displacement_statistics);
+        appendStatistics(report, "Nodal Forces", "Node", nodal_force_statistics);
         if (num_ties > 0) {
-            minmax = findMinMax2D(tie_forces);
-
-            report.append(
-                    (boost::format(
-                            "\nTie Forces\n\tMinimum : Tie %d\tDOF %d\tValue %.3f\n\tMaximum : Tie %d\tDOF %d\tValue %.3f\n")
-                     % minmax.first.row % minmax.first.col % tie_forces[minmax.first.row][minmax.first.col]
-                     % minmax.second.row % minmax.second.col % tie_forces[minmax.second.row][minmax.second.col]).str()
-            );
+            appendStatistics(report, "Tie Forces", "Tie", tie_force_statistics);
         }
         return report;
     }
@@ -23,14 +23,21 @@
 //
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
+#include <algorithm>
 #include <boost/format.hpp>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "threed_beam_fea.h"
 
@@ -51,17 +58,213 @@ namespace fea {
         }
     }
 
+    namespace {
+        // Number of elements whose end forces are computed by one task. A multiple of the batch size.
+        const size_t ELEM_FORCE_CHUNK_SIZE = 1024;
+
+        // Pointers to the first of W consecutive values of each element quantity.
+        struct ElemLanes {
+            const double *dx, *dy, *dz;
+            const double *EA, *EIz, *EIy, *GJ;
+            const double *nvx, *nvy, *nvz;
+        };
+
+        // Writes the 16 blocks of an elemental stiffness matrix given the distinct entries of its 4 distinct 3x3
+        // blocks. Symmetric blocks are stored as [00, 01, 02, 11, 12, 22], M is stored row-wise.
+        template<int W>
+        inline void setKelemBlocks(LocalMatrix &Kelem, unsigned int l,
+                                   const double (&T)[6][W], const double (&R_same)[6][W],
+                                   const double (&R_opp)[6][W], const double (&M)[9][W]) {
+            static const unsigned int sym_idx[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+
+            for (unsigned int r = 0; r < 3; ++r) {
+                for (unsigned int c = 0; c < 3; ++c) {
+                    const double t = T[sym_idx[r][c]][l];
+                    const double rs = R_same[sym_idx[r][c]][l];
+                    const double ro = R_opp[sym_idx[r][c]][l];
+                    const double m = M[3 * r + c][l];
+                    const double mt = M[3 * c + r][l];
+
+                    // rows and columns are ordered [t1, r1, t2, r2]
+                    Kelem(r, c) = t;
+                    Kelem(r, 3 + c) = m;
+                    Kelem(r, 6 + c) = -t;
+                    Kelem(r, 9 + c) = m;
+
+                    Kelem(3 + r, c) = mt;
+                    Kelem(3 + r, 3 + c) = rs;
+                    Kelem(3 + r, 6 + c) = -mt;
+                    Kelem(3 + r, 9 + c) = ro;
+
+                    Kelem(6 + r, c) = -t;
+                    Kelem(6 + r, 3 + c) = -m;
+                    Kelem(6 + r, 6 + c) = t;
+                    Kelem(6 + r, 9 + c) = -m;
+
+                    Kelem(9 + r, c) = mt;
+                    Kelem(9 + r, 3 + c) = ro;
+                    Kelem(9 + r, 6 + c) = -mt;
+                    Kelem(9 + r, 9 + c) = rs;
+                }
+            }
+        }
+
+        // Computes the elemental stiffness matrices of W elements.
+        //
+        // Every 3x3 block of the local stiffness matrix is either diagonal or only couples the local y- and
+        // z-directions. Rotating a diagonal block diag(a, b, c) to global coordinates gives
+        // a * nx * nx^T + b * ny * ny^T + c * nz * nz^T, and the off-diagonal entries (y, z) = p and (z, y) = q
+        // become p * ny * nz^T + q * nz * ny^T. The 16 blocks of Kelem are therefore formed from only 4 distinct
+        // 3x3 matrices with 27 distinct entries. The loop over the elements is written so the compiler can
+        // vectorize it. The same code is used for a single element (W == 1), so the result does not depend on
+        // whether an element was computed as part of a batch.
+        template<int W>
+        void calcKelemLanes(const ElemLanes &e, LocalMatrix *Kelems) {
+            double T[6][W], R_same[6][W], R_opp[6][W], M[9][W];
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+            for (int l = 0; l < W; ++l) {
+                // calculate the length of the element and the unit normal vector along local x-direction
+                const double length = std::sqrt(e.dx[l] * e.dx[l] + e.dy[l] * e.dy[l] + e.dz[l] * e.dz[l]);
+                const double nx[3] = {e.dx[l] / length, e.dy[l] / length, e.dz[l] / length};
+
+                // calculate unit normal vectors along local y- and z-directions as done in calcAelem
+                const double nv_length = std::sqrt(e.nvx[l] * e.nvx[l] + e.nvy[l] * e.nvy[l] + e.nvz[l] * e.nvz[l]);
+                const double ny[3] = {e.nvx[l] / nv_length, e.nvy[l] / nv_length, e.nvz[l] / nv_length};
+
+                double nz[3] = {nx[1] * ny[2] - nx[2] * ny[1],
+                                nx[2] * ny[0] - nx[0] * ny[2],
+                                nx[0] * ny[1] - nx[1] * ny[0]};
+                const double dlz = nz[0] * nz[0] + nz[1] * nz[1] + nz[2] * nz[2];
+                nz[0] /= dlz;
+                nz[1] /= dlz;
+                nz[2] /= dlz;
+
+                // store the entries in the (local) elemental stiffness matrix as temporary values
+                const double tmpEA = e.EA[l] / length;
+                const double tmpGJ = e.GJ[l] / length;
+
+                const double tmp12z = 12.0 * e.EIz[l] / (length * length * length);
+                const double tmp6z = 6.0 * e.EIz[l] / (length * length);
+                const double tmp1z = e.EIz[l] / length;
+
+                const double tmp12y = 12.0 * e.EIy[l] / (length * length * length);
+                const double tmp6y = 6.0 * e.EIy[l] / (length * length);
+                const double tmp1y = e.EIy[l] / length;
+
+                // distinct entries of the symmetric outer products of the local axes
+                static const unsigned int rows[6] = {0, 0, 0, 1, 1, 2};
+                static const unsigned int cols[6] = {0, 1, 2, 1, 2, 2};
+                for (unsigned int k = 0; k < 6; ++k) {
+                    const double pxx = nx[rows[k]] * nx[cols[k]];
+                    const double pyy = ny[rows[k]] * ny[cols[k]];
+                    const double pzz = nz[rows[k]] * nz[cols[k]];
+
+                    // translation-translation blocks
+                    T[k][l] = tmpEA * pxx + tmp12z * pyy + tmp12y * pzz;
+
+                    // rotation-rotation blocks of the same node and of opposite nodes
+                    R_same[k][l] = tmpGJ * pxx + 4.0 * tmp1y * pyy + 4.0 * tmp1z * pzz;
+                    R_opp[k][l] = -tmpGJ * pxx + 2.0 * tmp1y * pyy + 2.0 * tmp1z * pzz;
+                }
+
+                // translation-rotation blocks
+                for (unsigned int r = 0; r < 3; ++r) {
+                    for (unsigned int c = 0; c < 3; ++c) {
+                        M[3 * r + c][l] = tmp6z * ny[r] * nz[c] - tmp6y * nz[r] * ny[c];
+                    }
+                }
+            }
+
+            for (int l = 0; l < W; ++l) {
+                setKelemBlocks<W>(Kelems[l], l, T, R_same, R_opp, M);
+            }
+        }
+    }
+
+    ElemSoA::ElemSoA(const Job &job, unsigned int num_threads) {
+        const long num_elems = job.elems.size();
+        dx.resize(num_elems);
+        dy.resize(num_elems);
+        dz.resize(num_elems);
+        EA.resize(num_elems);
+        EIz.resize(num_elems);
+        EIy.resize(num_elems);
+        GJ.resize(num_elems);
+        nvx.resize(num_elems);
+        nvy.resize(num_elems);
+        nvz.resize(num_elems);
+
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+        for (long i = 0; i < num_elems; ++i) {
+            const Eigen::Vector3d axis = job.nodes[job.elems[i][1]] - job.nodes[job.elems[i][0]];
+            const Props &props = job.getElemProps(i);
+            dx[i] = axis(0);
+            dy[i] = axis(1);
+            dz[i] = axis(2);
+            EA[i] = props.EA;
+            EIz[i] = props.EIz;
+            EIy[i] = props.EIy;
+            GJ[i] = props.GJ;
+            nvx[i] = props.normal_vec(0);
+            nvy[i] = props.normal_vec(1);
+            nvz[i] = props.normal_vec(2);
+        }
+    }
+
     inline double norm(const Node &n1, const Node &n2) {
         const Node dn = n2 - n1;
         return dn.norm();
     }
 
     void GlobalStiffAssembler::calcKelem(unsigned int i, const Job &job) {
+        // store node indices of current element
+        const int nn1 = job.elems[i][0];
+        const int nn2 = job.elems[i][1];
+
+        const Eigen::Vector3d axis = job.nodes[nn2] - job.nodes[nn1];
+        const Props &props = job.getElemProps(i);
+
+        ElemLanes lanes;
+        lanes.dx = &axis(0);
+        lanes.dy = &axis(1);
+        lanes.dz = &axis(2);
+        lanes.EA = &props.EA;
+        lanes.EIz = &props.EIz;
+        lanes.EIy = &props.EIy;
+        lanes.GJ = &props.GJ;
+        lanes.nvx = &props.normal_vec(0);
+        lanes.nvy = &props.normal_vec(1);
+        lanes.nvz = &props.normal_vec(2);
+
+        calcKelemLanes<1>(lanes, &Kelem);
+    };
+
+    void GlobalStiffAssembler::calcKelemBatch(size_t first, const ElemSoA &elems) {
+        ElemLanes lanes;
+        lanes.dx = &elems.dx[first];
+        lanes.dy = &elems.dy[first];
+        lanes.dz = &elems.dz[first];
+        lanes.EA = &elems.EA[first];
+        lanes.EIz = &elems.EIz[first];
+        lanes.EIy = &elems.EIy[first];
+        lanes.GJ = &elems.GJ[first];
+        lanes.nvx = &elems.nvx[first];
+        lanes.nvy = &elems.nvy[first];
+        lanes.nvz = &elems.nvz[first];
+
+        calcKelemLanes<ELEM_BATCH_SIZE>(lanes, KelemBatch);
+    };
+
+    void GlobalStiffAssembler::calcKelemDense(unsigned int i, const Job &job) {
         // extract element properties
-        const double EA = job.props[i].EA;
-        const double EIz = job.props[i].EIz;
-        const double EIy = job.props[i].EIy;
-        const double GJ = job.props[i].GJ;
+        const Props &props = job.getElemProps(i);
+        const double EA = props.EA;
+        const double EIz = props.EIz;
+        const double EIy = props.EIy;
+        const double GJ = props.GJ;
 
         // store node indices of current element
         const int nn1 = job.elems[i][0];
@@ -129,7 +332,7 @@ namespace fea {
         nx.normalize();
 
         // calculate unit normal vector along y-direction
-        const Eigen::Vector3d ny = job.props[i].normal_vec.normalized();
+        const Eigen::Vector3d ny = props.normal_vec.normalized();
 
         // update rotation matrices
         calcAelem(nx, ny);
@@ -228,70 +431,508 @@ namespace fea {
         AelemT(11, 11) = nz(2);
     };
 
-    void GlobalStiffAssembler::operator()(SparseMat &Kg, const Job &job, const std::vector<Tie> &ties) {
-        int nn1, nn2;
+    namespace {
+        // Adds each 6x6 block of the elemental stiffness matrix to the columns of the corresponding node if that
+        // node lies in [first_node, last_node). If only the upper triangle is stored, blocks of a node with a higher
+        // index than the column's node and the entries below the diagonal of the diagonal blocks are skipped.
+        inline void scatterKelem(const LocalMatrix &K,
+                                 const Eigen::Vector2i &elem,
+                                 const SparseMat::StorageIndex *offsets,
+                                 const SparseMat::StorageIndex *outer,
+                                 double *values,
+                                 bool upper_only,
+                                 size_t first_node,
+                                 size_t last_node) {
+            typedef SparseMat::StorageIndex StorageIndex;
+            const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+            const unsigned int nodes[2] = {static_cast<unsigned int>(elem[0]), static_cast<unsigned int>(elem[1])};
+
+            for (unsigned int b = 0; b < 2; ++b) {
+                if (nodes[b] < first_node || nodes[b] >= last_node) {
+                    continue;
+                }
+                for (unsigned int c = 0; c < dofs_per_elem; ++c) {
+                    const StorageIndex col_start = outer[dofs_per_elem * nodes[b] + c];
+                    for (unsigned int a = 0; a < 2; ++a) {
+                        if (upper_only && nodes[a] > nodes[b]) {
+                            continue;
+                        }
+                        const unsigned int num_rows = upper_only && nodes[a] == nodes[b] ? c + 1 : dofs_per_elem;
+                        double *col_values = values + col_start + offsets[2 * b + a];
+                        for (unsigned int r = 0; r < num_rows; ++r) {
+                            col_values[r] += K(dofs_per_elem * a + r, dofs_per_elem * b + c);
+                        }
+                    }
+                }
+            }
+        }
+
+        inline bool isBelowDiagonal(const Eigen::Triplet<double> &triplet) {
+            return triplet.row() > triplet.col();
+        }
+
+        // Checks if the element is connected to a node in [first_node, last_node).
+        inline bool touchesNodes(const Eigen::Vector2i &elem, size_t first_node, size_t last_node) {
+            return (static_cast<size_t>(elem[0]) >= first_node && static_cast<size_t>(elem[0]) < last_node)
+                   || (static_cast<size_t>(elem[1]) >= first_node && static_cast<size_t>(elem[1]) < last_node);
+        }
+    }
+
+    void GlobalStiffAssembler::appendTriplets(const LocalMatrix &K,
+                                              int nn1,
+                                              int nn2,
+                                              std::vector<Eigen::Triplet<double> > &triplets) {
         unsigned int row, col;
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
 
+        // get sparse representation of the elemental stiffness matrix
+        SparseKelem = K.sparseView();
+
+        for (unsigned int j = 0; j < SparseKelem.outerSize(); ++j) {
+            for (SparseMat::InnerIterator it(SparseKelem, j); it; ++it) {
+                // the top left of the local matrix belongs to the first node and the bottom right to the second
+                row = it.row() < 6 ? dofs_per_elem * nn1 + it.row() : dofs_per_elem * (nn2 - 1) + it.row();
+                col = it.col() < 6 ? dofs_per_elem * nn1 + it.col() : dofs_per_elem * (nn2 - 1) + it.col();
+
+                if (upper_only && row > col) {
+                    continue;
+                }
+                triplets.push_back(Eigen::Triplet<double>(row, col, it.value()));
+            }
+        }
+    };
+
+    void GlobalStiffAssembler::assembleElems(size_t first,
+                                             size_t last,
+                                             const Job &job,
+                                             const ElemSoA &elems,
+                                             std::vector<Eigen::Triplet<double> > &triplets) {
+        size_t i = first;
+
+        // compute full batches of elemental stiffness matrices
+        for (; i + ELEM_BATCH_SIZE <= last; i += ELEM_BATCH_SIZE) {
+            calcKelemBatch(i, elems);
+            for (unsigned int l = 0; l < ELEM_BATCH_SIZE; ++l) {
+                appendTriplets(KelemBatch[l], job.elems[i + l][0], job.elems[i + l][1], triplets);
+            }
+        }
+
+        // compute the remaining elements one at a time
+        for (; i < last; ++i) {
+            calcKelem(i, job);
+            appendTriplets(Kelem, job.elems[i][0], job.elems[i][1], triplets);
+        }
+    };
+
+    void GlobalStiffAssembler::scatterElems(size_t first_node,
+                                            size_t last_node,
+                                            const Job &job,
+                                            const ElemSoA &elems,
+                                            const SparsityPattern &pattern,
+                                            const SparseMat::StorageIndex *outer,
+                                            double *values) {
+        const size_t num_elems = job.elems.size();
+        size_t i = 0;
+
+        // compute full batches of elemental stiffness matrices if any of their elements is connected to the nodes
+        for (; i + ELEM_BATCH_SIZE <= num_elems; i += ELEM_BATCH_SIZE) {
+            bool touches = false;
+            for (unsigned int l = 0; l < ELEM_BATCH_SIZE; ++l) {
+                touches = touches || touchesNodes(job.elems[i + l], first_node, last_node);
+            }
+            if (!touches) {
+                continue;
+            }
+            calcKelemBatch(i, elems);
+            for (unsigned int l = 0; l < ELEM_BATCH_SIZE; ++l) {
+                scatterKelem(KelemBatch[l], job.elems[i + l], &pattern.elem_offsets[4 * (i + l)], outer, values,
+                             pattern.upper_only, first_node, last_node);
+            }
+        }
+
+        // compute the remaining elements one at a time
+        for (; i < num_elems; ++i) {
+            if (!touchesNodes(job.elems[i], first_node, last_node)) {
+                continue;
+            }
+            calcKelem(i, job);
+            scatterKelem(Kelem, job.elems[i], &pattern.elem_offsets[4 * i], outer, values, pattern.upper_only,
+                         first_node, last_node);
+        }
+    };
+
+    void GlobalStiffAssembler::calcElemForces(size_t first,
+                                              size_t last,
+                                              const Job &job,
+                                              const ElemSoA &elems,
+                                              const ResultMatrix &nodal_displacements,
+                                              ElemResultMatrix &elem_forces) {
+        Eigen::Matrix<double, 12, 1> u, global_forces;
+        for (size_t i = first; i < last; ++i) {
+            // compute full batches of elemental stiffness matrices
+            const size_t lane = (i - first) % ELEM_BATCH_SIZE;
+            const bool in_batch = i - lane + ELEM_BATCH_SIZE <= last;
+            if (in_batch && lane == 0) {
+                calcKelemBatch(i, elems);
+            }
+            else if (!in_batch) {
+                calcKelem(i, job);
+            }
+            const LocalMatrix &K = in_batch ? KelemBatch[lane] : Kelem;
+
+            const int nn1 = job.elems[i][0];
+            const int nn2 = job.elems[i][1];
+            u.head<6>() = nodal_displacements.row(nn1).transpose();
+            u.tail<6>() = nodal_displacements.row(nn2).transpose();
+            global_forces.noalias() = K * u;
+
+            // rotate each 3-vector of forces or moments to the local coordinate system
+            const Eigen::Vector3d nx = (job.nodes[nn2] - job.nodes[nn1]).normalized();
+            calcAelem(nx, job.getElemProps(i).normal_vec.normalized());
+            const Eigen::Matrix3d rotation = Aelem.topLeftCorner<3, 3>();
+            for (unsigned int k = 0; k < 4; ++k) {
+                elem_forces.block<1, 3>(i, 3 * k) = (rotation * global_forces.segment<3>(3 * k)).transpose();
+            }
+        }
+    };
+
+    void GlobalStiffAssembler::operator()(SparseMat &Kg, const Job &job, const std::vector<Tie> &ties) {
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        const size_t num_elems = job.elems.size();
+
+        // gather the element data into contiguous arrays for the batched stiffness computation
+        const ElemSoA elems(job, num_threads);
+
         // form vector to hold triplets that will be used to assemble global stiffness matrix
         std::vector<Eigen::Triplet<double> > triplets;
-        triplets.reserve(40 * job.elems.size() + 4 * dofs_per_elem * ties.size());
 
-        for (unsigned int i = 0; i < job.elems.size(); ++i) {
-            // update Kelem with current elemental stiffness matrix
-            calcKelem(i, job);
+        const int max_threads = resolveNumThreads(num_threads);
 
-            // get sparse representation of the current elemental stiffness matrix
-            SparseKelem = Kelem.sparseView();
-
-            // pull out current node indices
-            nn1 = job.elems[i][0];
-            nn2 = job.elems[i][1];
-
-            for (unsigned int j = 0; j < SparseKelem.outerSize(); ++j) {
-                for (SparseMat::InnerIterator it(SparseKelem, j); it; ++it) {
-                    row = it.row();
-                    col = it.col();
-
-                    // check position in local matrix and update corresponding global position
-                    if (row < 6) {
-                        // top left
-                        if (col < 6) {
-                            triplets.push_back(Eigen::Triplet<double>(dofs_per_elem * nn1 + row,
-                                                                      dofs_per_elem * nn1 + col,
-                                                                      it.value()));
-                        }
-                            // top right
-                        else {
-                            triplets.push_back(Eigen::Triplet<double>(dofs_per_elem * nn1 + row,
-                                                                      dofs_per_elem * (nn2 - 1) + col,
-                                                                      it.value()));
-                        }
-                    }
-                    else {
-                        // bottom left
-                        if (col < 6) {
-                            triplets.push_back(Eigen::Triplet<double>(dofs_per_elem * (nn2 - 1) + row,
-                                                                      dofs_per_elem * nn1 + col,
-                                                                      it.value()));
-                        }
-                            // bottom right
-                        else {
-                            triplets.push_back(Eigen::Triplet<double>(dofs_per_elem * (nn2 - 1) + row,
-                                                                      dofs_per_elem * (nn2 - 1) + col,
-                                                                      it.value()));
-                        }
-                    }
-                }
+        if (max_threads <= 1 || num_elems < static_cast<size_t>(max_threads)) {
+            triplets.reserve(40 * num_elems + 4 * dofs_per_elem * ties.size());
+            assembleElems(0, num_elems, job, elems, triplets);
+        }
+        else {
+#ifdef _OPENMP
+            // each thread fills its own list of triplets for a contiguous block of elements
+            std::vector<std::vector<Eigen::Triplet<double> > > thread_triplets(max_threads);
+
+#pragma omp parallel num_threads(max_threads)
+            {
+                const size_t thread_id = omp_get_thread_num();
+                const size_t team_size = omp_get_num_threads();
+                const size_t first = num_elems * thread_id / team_size;
+                const size_t last = num_elems * (thread_id + 1) / team_size;
+
+                // the elemental matrices are scratch space, so every thread needs its own
+                GlobalStiffAssembler thread_assembler;
+                thread_triplets[thread_id].reserve(40 * (last - first));
+                thread_assembler.assembleElems(first, last, job, elems, thread_triplets[thread_id]);
+            }
+
+            // concatenate in thread order so the triplets are in the same order as the serial assembly
+            size_t num_triplets = 4 * dofs_per_elem * ties.size();
+            for (size_t i = 0; i < thread_triplets.size(); ++i) {
+                num_triplets += thread_triplets[i].size();
+            }
+            triplets.reserve(num_triplets);
+
+            for (size_t i = 0; i < thread_triplets.size(); ++i) {
+                triplets.insert(triplets.end(), thread_triplets[i].begin(), thread_triplets[i].end());
+                std::vector<Eigen::Triplet<double> >().swap(thread_triplets[i]);
             }
+#endif
         }
 
+        const size_t num_elem_triplets = triplets.size();
         loadTies(triplets, ties);
+        if (upper_only) {
+            triplets.erase(std::remove_if(triplets.begin() + num_elem_triplets, triplets.end(), isBelowDiagonal),
+                           triplets.end());
+        }
 
         Kg.setFromTriplets(triplets.begin(), triplets.end());
     };
 
-    void loadBCs(SparseMat &Kg, SparseMat &force_vec, const std::vector<BC> &BCs, unsigned int num_nodes) {
+    namespace {
+        // Returns the position of the entry (row, col) in the values of a compressed matrix with the given structure.
+        SparseMat::StorageIndex findEntry(const SparsityPattern &pattern, size_t row, size_t col) {
+            const std::vector<SparseMat::StorageIndex>::const_iterator first =
+                    pattern.inner_index.begin() + pattern.outer_index[col];
+            const std::vector<SparseMat::StorageIndex>::const_iterator last =
+                    pattern.inner_index.begin() + pattern.outer_index[col + 1];
+            return std::lower_bound(first, last, static_cast<SparseMat::StorageIndex>(row))
+                   - pattern.inner_index.begin();
+        }
+    }
+
+    SparsityPattern computeSparsityPattern(const Job &job, const std::vector<Tie> &ties, bool upper_only) {
+        return computeSparsityPattern(job, ties, std::vector<BC>(), std::vector<Equation>(), upper_only);
+    }
+
+    SparsityPattern computeSparsityPattern(const Job &job,
+                                           const std::vector<Tie> &ties,
+                                           const std::vector<BC> &BCs,
+                                           const std::vector<Equation> &equations,
+                                           bool upper_only) {
+        typedef SparseMat::StorageIndex StorageIndex;
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        const size_t num_nodes = job.nodes.size();
+        const size_t num_mults = BCs.size() + equations.size();
+
+        SparsityPattern pattern;
+        pattern.num_dofs = dofs_per_elem * num_nodes;
+        pattern.upper_only = upper_only;
+
+        // gather the node pairs that are connected by an element or tie
+        std::vector<std::pair<unsigned int, unsigned int> > connections;
+        connections.reserve(job.elems.size() + ties.size());
+        for (size_t i = 0; i < job.elems.size(); ++i) {
+            connections.push_back(std::make_pair(job.elems[i][0], job.elems[i][1]));
+        }
+        for (size_t i = 0; i < ties.size(); ++i) {
+            connections.push_back(std::make_pair(ties[i].node_number_1, ties[i].node_number_2));
+        }
+
+        // form the list of connected nodes for each node. Each connection couples both nodes to themselves and
+        // to each other, so every node contributes 2 entries to the lists of both nodes.
+        std::vector<size_t> adj_start(num_nodes + 1, 0);
+        for (size_t i = 0; i < connections.size(); ++i) {
+            adj_start[connections[i].first + 1] += 2;
+            adj_start[connections[i].second + 1] += 2;
+        }
+        for (size_t i = 0; i < num_nodes; ++i) {
+            adj_start[i + 1] += adj_start[i];
+        }
+
+        std::vector<unsigned int> adj(adj_start[num_nodes]);
+        std::vector<size_t> adj_fill(adj_start.begin(), adj_start.end() - 1);
+        for (size_t i = 0; i < connections.size(); ++i) {
+            const unsigned int nn1 = connections[i].first;
+            const unsigned int nn2 = connections[i].second;
+            adj[adj_fill[nn1]++] = nn1;
+            adj[adj_fill[nn1]++] = nn2;
+            adj[adj_fill[nn2]++] = nn1;
+            adj[adj_fill[nn2]++] = nn2;
+        }
+
+        // sort and remove duplicates in place. adj_end marks the end of the unique nodes of each list.
+        std::vector<size_t> adj_end(num_nodes);
+        for (size_t i = 0; i < num_nodes; ++i) {
+            std::sort(adj.begin() + adj_start[i], adj.begin() + adj_start[i + 1]);
+            adj_end[i] = std::unique(adj.begin() + adj_start[i], adj.begin() + adj_start[i + 1]) - adj.begin();
+        }
+
+        // form the list of degrees of freedom constrained by each Lagrange multiplier. The multipliers of the
+        // boundary conditions come first, followed by those of the equations.
+        std::vector<size_t> mult_start(num_mults + 1, 0);
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            mult_start[i + 1] = 1;
+        }
+        for (size_t i = 0; i < equations.size(); ++i) {
+            mult_start[BCs.size() + i + 1] = equations[i].terms.size();
+        }
+        for (size_t i = 0; i < num_mults; ++i) {
+            mult_start[i + 1] += mult_start[i];
+        }
+
+        std::vector<StorageIndex> mult_dofs(mult_start[num_mults]);
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            mult_dofs[mult_start[i]] = dofs_per_elem * BCs[i].node + BCs[i].dof;
+        }
+        for (size_t i = 0; i < equations.size(); ++i) {
+            for (size_t j = 0; j < equations[i].terms.size(); ++j) {
+                const Equation::Term &term = equations[i].terms[j];
+                mult_dofs[mult_start[BCs.size() + i] + j] = dofs_per_elem * term.node_number + term.dof;
+            }
+        }
+
+        std::vector<size_t> mult_end(num_mults);
+        for (size_t i = 0; i < num_mults; ++i) {
+            std::sort(mult_dofs.begin() + mult_start[i], mult_dofs.begin() + mult_start[i + 1]);
+            mult_end[i] = std::unique(mult_dofs.begin() + mult_start[i], mult_dofs.begin() + mult_start[i + 1])
+                          - mult_dofs.begin();
+        }
+
+        // count the multipliers that constrain each degree of freedom. They are mirrored below the node rows of
+        // its column unless only the upper triangle is stored.
+        std::vector<StorageIndex> num_dof_mults(pattern.num_dofs, 0);
+        if (!upper_only) {
+            for (size_t i = 0; i < num_mults; ++i) {
+                for (size_t k = mult_start[i]; k < mult_end[i]; ++k) {
+                    ++num_dof_mults[mult_dofs[k]];
+                }
+            }
+        }
+
+        // all 6 columns of a node have 6 rows for every connected node. In the upper triangle the rows of
+        // connected nodes with a higher index are dropped and the column's own node only contributes the rows up to
+        // and including the diagonal.
+        pattern.outer_index.resize(pattern.num_dofs + num_mults + 1);
+        StorageIndex nnz = 0;
+        for (size_t i = 0; i < num_nodes; ++i) {
+            const size_t num_adj = upper_only
+                                   ? std::upper_bound(adj.begin() + adj_start[i], adj.begin() + adj_end[i], i)
+                                     - (adj.begin() + adj_start[i])
+                                   : adj_end[i] - adj_start[i];
+            for (unsigned int j = 0; j < dofs_per_elem; ++j) {
+                pattern.outer_index[dofs_per_elem * i + j] = nnz;
+                if (upper_only && num_adj > 0) {
+                    nnz += dofs_per_elem * (num_adj - 1) + j + 1;
+                }
+                else {
+                    nnz += dofs_per_elem * num_adj;
+                }
+                nnz += num_dof_mults[dofs_per_elem * i + j];
+            }
+        }
+        for (size_t i = 0; i < num_mults; ++i) {
+            pattern.outer_index[pattern.num_dofs + i] = nnz;
+            nnz += mult_end[i] - mult_start[i];
+        }
+        pattern.outer_index[pattern.num_dofs + num_mults] = nnz;
+
+        pattern.inner_index.resize(nnz);
+        std::vector<StorageIndex> mult_fill(pattern.num_dofs);
+        for (size_t i = 0; i < num_nodes; ++i) {
+            for (unsigned int j = 0; j < dofs_per_elem; ++j) {
+                const size_t dof = dofs_per_elem * i + j;
+                const StorageIndex first_row = pattern.outer_index[dof];
+                const StorageIndex last_row = pattern.outer_index[dof + 1] - num_dof_mults[dof];
+                for (StorageIndex idx = first_row; idx < last_row; ++idx) {
+                    const StorageIndex k = (idx - first_row) / dofs_per_elem;
+                    pattern.inner_index[idx] = dofs_per_elem * adj[adj_start[i] + k] + (idx - first_row) % dofs_per_elem;
+                }
+                mult_fill[dof] = last_row;
+            }
+        }
+        for (size_t i = 0; i < num_mults; ++i) {
+            std::copy(mult_dofs.begin() + mult_start[i], mult_dofs.begin() + mult_end[i],
+                      pattern.inner_index.begin() + pattern.outer_index[pattern.num_dofs + i]);
+            // the multipliers are visited in ascending order, so the mirrored rows are sorted
+            if (!upper_only) {
+                for (size_t k = mult_start[i]; k < mult_end[i]; ++k) {
+                    pattern.inner_index[mult_fill[mult_dofs[k]]++] = pattern.num_dofs + i;
+                }
+            }
+        }
+
+        // store the offset of the rows of each node within the columns of the other node of the connection
+        std::vector<StorageIndex> offsets(4 * connections.size());
+        for (size_t i = 0; i < connections.size(); ++i) {
+            const unsigned int nodes[2] = {connections[i].first, connections[i].second};
+            for (unsigned int b = 0; b < 2; ++b) {
+                const std::vector<unsigned int>::const_iterator first = adj.begin() + adj_start[nodes[b]];
+                const std::vector<unsigned int>::const_iterator last = adj.begin() + adj_end[nodes[b]];
+                for (unsigned int a = 0; a < 2; ++a) {
+                    offsets[4 * i + 2 * b + a] =
+                            dofs_per_elem * (std::lower_bound(first, last, nodes[a]) - first);
+                }
+            }
+        }
+        pattern.elem_offsets.assign(offsets.begin(), offsets.begin() + 4 * job.elems.size());
+        pattern.tie_offsets.assign(offsets.begin() + 4 * job.elems.size(), offsets.end());
+
+        // store where the coefficients of the multipliers are written
+        pattern.bc_slots.resize(2 * BCs.size());
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            const size_t dof = dofs_per_elem * BCs[i].node + BCs[i].dof;
+            const size_t mult = pattern.num_dofs + i;
+            pattern.bc_slots[2 * i] = findEntry(pattern, dof, mult);
+            pattern.bc_slots[2 * i + 1] = upper_only ? -1 : findEntry(pattern, mult, dof);
+        }
+
+        for (size_t i = 0; i < equations.size(); ++i) {
+            const size_t mult = pattern.num_dofs + BCs.size() + i;
+            for (size_t j = 0; j < equations[i].terms.size(); ++j) {
+                const size_t dof = dofs_per_elem * equations[i].terms[j].node_number + equations[i].terms[j].dof;
+                pattern.equation_slots.push_back(findEntry(pattern, dof, mult));
+                pattern.equation_slots.push_back(upper_only ? -1 : findEntry(pattern, mult, dof));
+            }
+        }
+
+        return pattern;
+    }
+
+    void GlobalStiffAssembler::operator()(SparseMat &Kg,
+                                          const Job &job,
+                                          const std::vector<Tie> &ties,
+                                          const SparsityPattern &pattern) {
+        typedef SparseMat::StorageIndex StorageIndex;
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        const StorageIndex nnz = pattern.inner_index.size();
+
+        // set up the structure of Kg if it does not already match the pattern
+        const bool has_pattern = Kg.isCompressed()
+                                 && Kg.nonZeros() == nnz
+                                 && std::equal(pattern.outer_index.begin(), pattern.outer_index.end(),
+                                               Kg.outerIndexPtr())
+                                 && std::equal(pattern.inner_index.begin(), pattern.inner_index.end(),
+                                               Kg.innerIndexPtr());
+        if (!has_pattern) {
+            Kg.resize(Kg.rows(), Kg.cols());
+            Kg.resizeNonZeros(nnz);
+            std::copy(pattern.outer_index.begin(), pattern.outer_index.end(), Kg.outerIndexPtr());
+            std::fill(Kg.outerIndexPtr() + pattern.outer_index.size(), Kg.outerIndexPtr() + Kg.outerSize() + 1, nnz);
+            std::copy(pattern.inner_index.begin(), pattern.inner_index.end(), Kg.innerIndexPtr());
+        }
+
+        double *values = Kg.valuePtr();
+        const StorageIndex *outer = Kg.outerIndexPtr();
+        std::fill(values, values + nnz, 0.0);
+
+        const ElemSoA elems(job, num_threads);
+        const size_t num_nodes = job.nodes.size();
+        const int max_threads = resolveNumThreads(num_threads);
+
+        if (max_threads <= 1 || num_nodes < static_cast<size_t>(max_threads)) {
+            scatterElems(0, num_nodes, job, elems, pattern, outer, values);
+        }
+        else {
+#ifdef _OPENMP
+            // each thread owns the columns of a contiguous block of nodes, so the threads write disjoint values
+#pragma omp parallel num_threads(max_threads)
+            {
+                const size_t thread_id = omp_get_thread_num();
+                const size_t team_size = omp_get_num_threads();
+
+                // the elemental matrices are scratch space, so every thread needs its own
+                GlobalStiffAssembler thread_assembler;
+                thread_assembler.scatterElems(num_nodes * thread_id / team_size,
+                                              num_nodes * (thread_id + 1) / team_size,
+                                              job, elems, pattern, outer, values);
+            }
+#endif
+        }
+
+        // ties only couple identical degrees of freedom, i.e. the diagonal of each 6x6 block. In the upper triangle
+        // only the coupling stored in the column of the node with the higher index is kept.
+        for (size_t i = 0; i < ties.size(); ++i) {
+            const unsigned int nn1 = ties[i].node_number_1;
+            const unsigned int nn2 = ties[i].node_number_2;
+            const StorageIndex *offsets = &pattern.tie_offsets[4 * i];
+
+            for (unsigned int j = 0; j < dofs_per_elem; ++j) {
+                // first 3 DOFs are linear DOFs, second 2 are rotational, last is torsional
+                const double spring_constant = j < 3 ? ties[i].lmult : ties[i].rmult;
+
+                values[outer[dofs_per_elem * nn1 + j] + offsets[0] + j] += spring_constant;
+                values[outer[dofs_per_elem * nn2 + j] + offsets[3] + j] += spring_constant;
+                if (!pattern.upper_only || nn1 < nn2) {
+                    values[outer[dofs_per_elem * nn2 + j] + offsets[2] + j] -= spring_constant;
+                }
+                if (!pattern.upper_only || nn2 < nn1) {
+                    values[outer[dofs_per_elem * nn1 + j] + offsets[1] + j] -= spring_constant;
+                }
+            }
+        }
+    };
+
+    void loadBCs(SparseMat &Kg,
+                 SparseMat &force_vec,
+                 const std::vector<BC> &BCs,
+                 unsigned int num_nodes,
+                 bool upper_only) {
         unsigned int bc_idx;
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
         // calculate the index that marks beginning of Lagrange multiplier coefficients
@@ -302,16 +943,44 @@ namespace fea {
 
             // update global stiffness matrix
             Kg.insert(bc_idx, global_add_idx + i) = 1;
-            Kg.insert(global_add_idx + i, bc_idx) = 1;
+            if (!upper_only) {
+                Kg.insert(global_add_idx + i, bc_idx) = 1;
+            }
+
+            // update force vector of every load case. All values are already zero. Only update if BC if non-zero.
+            if (std::abs(BCs[i].value) > std::numeric_limits<double>::epsilon()) {
+                for (long j = 0; j < force_vec.cols(); ++j) {
+                    force_vec.insert(global_add_idx + i, j) = BCs[i].value;
+                }
+            }
+        }
+    };
+
+    void loadBCs(SparseMat &Kg, SparseMat &force_vec, const std::vector<BC> &BCs, const SparsityPattern &pattern) {
+        double *values = Kg.valuePtr();
+        const unsigned long global_add_idx = pattern.num_dofs;
+
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            // update global stiffness matrix
+            values[pattern.bc_slots[2 * i]] = 1;
+            if (!pattern.upper_only) {
+                values[pattern.bc_slots[2 * i + 1]] = 1;
+            }
 
-            // update force vector. All values are already zero. Only update if BC if non-zero.
+            // update force vector of every load case. All values are already zero. Only update if BC if non-zero.
             if (std::abs(BCs[i].value) > std::numeric_limits<double>::epsilon()) {
-                force_vec.insert(global_add_idx + i, 0) = BCs[i].value;
+                for (long j = 0; j < force_vec.cols(); ++j) {
+                    force_vec.insert(global_add_idx + i, j) = BCs[i].value;
+                }
             }
         }
     };
 
-    void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations, unsigned int num_nodes, unsigned int num_bcs) {
+    void loadEquations(SparseMat &Kg,
+                       const std::vector<Equation> &equations,
+                       unsigned int num_nodes,
+                       unsigned int num_bcs,
+                       bool upper_only) {
         size_t row_idx, col_idx;
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
         const unsigned int global_add_idx = dofs_per_elem * num_nodes + num_bcs;
@@ -320,12 +989,29 @@ namespace fea {
             row_idx = global_add_idx + i;
             for (size_t j = 0; j < equations[i].terms.size(); ++j) {
                 col_idx = dofs_per_elem * equations[i].terms[j].node_number + equations[i].terms[j].dof;
-                Kg.insert(row_idx, col_idx) = equations[i].terms[j].coefficient;
+                if (!upper_only) {
+                    Kg.insert(row_idx, col_idx) = equations[i].terms[j].coefficient;
+                }
                 Kg.insert(col_idx, row_idx) = equations[i].terms[j].coefficient;
             }
         }
     };
 
+    void loadEquations(SparseMat &Kg, const std::vector<Equation> &equations, const SparsityPattern &pattern) {
+        double *values = Kg.valuePtr();
+        size_t slot = 0;
+
+        // a degree of freedom that appears in several terms of an equation receives the sum of their coefficients
+        for (size_t i = 0; i < equations.size(); ++i) {
+            for (size_t j = 0; j < equations[i].terms.size(); ++j, slot += 2) {
+                values[pattern.equation_slots[slot]] += equations[i].terms[j].coefficient;
+                if (!pattern.upper_only) {
+                    values[pattern.equation_slots[slot + 1]] += equations[i].terms[j].coefficient;
+                }
+            }
+        }
+    };
+
     void loadTies(std::vector<Eigen::Triplet<double> > &triplets, const std::vector<Tie> &ties) {
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
         unsigned int nn1, nn2;
@@ -360,13 +1046,12 @@ namespace fea {
         }
     };
 
-    std::vector<std::vector<double> > computeTieForces(const std::vector<Tie> &ties,
-                                                       const std::vector<std::vector<double> > &nodal_displacements) {
+    ResultMatrix computeTieForces(const std::vector<Tie> &ties, const ResultMatrix &nodal_displacements) {
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
         unsigned int nn1, nn2;
         double lmult, rmult, spring_constant, delta1, delta2;
 
-        std::vector<std::vector<double> > tie_forces(ties.size(), std::vector<double>(dofs_per_elem));
+        ResultMatrix tie_forces(ties.size(), dofs_per_elem);
 
         for (size_t i = 0; i < ties.size(); ++i) {
             nn1 = ties[i].node_number_1;
@@ -377,115 +1062,1097 @@ namespace fea {
             for (unsigned int j = 0; j < dofs_per_elem; ++j) {
                 // first 3 DOFs are linear DOFs, second 2 are rotational, last is torsional
                 spring_constant = j < 3 ? lmult : rmult;
-                delta1 = nodal_displacements[nn1][j];
-                delta2 = nodal_displacements[nn2][j];
-                tie_forces[i][j] = spring_constant * (delta2 - delta1);
+                delta1 = nodal_displacements(nn1, j);
+                delta2 = nodal_displacements(nn2, j);
+                tie_forces(i, j) = spring_constant * (delta2 - delta1);
             }
         }
         return tie_forces;
     }
 
-    void loadForces(SparseMat &force_vec, const std::vector<Force> &forces) {
+    ElemResultMatrix computeElemForces(const Job &job, const ElemSoA &elems, const ResultMatrix &nodal_displacements,
+                                       unsigned int num_threads) {
+        if (elems.dx.size() != job.elems.size()) {
+            throw std::runtime_error(
+                    (boost::format("Element data of %d elements was given for %d elements.")
+                     % elems.dx.size() % job.elems.size()).str()
+            );
+        }
+        if (nodal_displacements.rows() != static_cast<long>(job.nodes.size())) {
+            throw std::runtime_error(
+                    (boost::format("%d nodal displacements were given for %d nodes.")
+                     % nodal_displacements.rows() % job.nodes.size()).str()
+            );
+        }
+
+        const long num_elems = job.elems.size();
+        ElemResultMatrix elem_forces(num_elems, 2 * DOF::NUM_DOFS);
+
+        // the elemental matrices are scratch space, so every chunk uses its own assembler
+        const long num_chunks = (num_elems + ELEM_FORCE_CHUNK_SIZE - 1) / ELEM_FORCE_CHUNK_SIZE;
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+        for (long c = 0; c < num_chunks; ++c) {
+            const size_t first = c * ELEM_FORCE_CHUNK_SIZE;
+            const size_t last = std::min(first + ELEM_FORCE_CHUNK_SIZE, static_cast<size_t>(num_elems));
+            GlobalStiffAssembler assembler;
+            assembler.calcElemForces(first, last, job, elems, nodal_displacements, elem_forces);
+        }
+        return elem_forces;
+    }
+
+    ElemStressMatrix computeElemStresses(const ElemResultMatrix &elem_forces,
+                                         const std::vector<SectionModuli> &sections,
+                                         unsigned int num_threads) {
+        const long num_elems = elem_forces.rows();
+        if (sections.size() != 1 && sections.size() != static_cast<size_t>(num_elems)) {
+            throw std::runtime_error(
+                    (boost::format("%d sections were given for %d elements. Provide one section per element or a "
+                                   "single section for all elements.") % sections.size() % num_elems).str()
+            );
+        }
+
+        ElemStressMatrix stresses(num_elems, 8);
+#pragma omp parallel for num_threads(resolveNumThreads(num_threads))
+        for (long i = 0; i < num_elems; ++i) {
+            const SectionModuli &section = sections.size() == 1 ? sections[0] : sections[i];
+            for (unsigned int end = 0; end < 2; ++end) {
+                // internal forces of the element: the end forces of the first node act in the opposite direction
+                const double sign = end == 0 ? -1.0 : 1.0;
+                const double axial = sign * elem_forces(i, 6 * end + DOF::DISPLACEMENT_X) / section.area;
+                const double bending_y = sign * elem_forces(i, 6 * end + DOF::ROTATION_Y) / section.Sy;
+                const double bending_z = sign * elem_forces(i, 6 * end + DOF::ROTATION_Z) / section.Sz;
+                stresses(i, 4 * end) = axial;
+                stresses(i, 4 * end + 1) = bending_y;
+                stresses(i, 4 * end + 2) = bending_z;
+                stresses(i, 4 * end + 3) = std::abs(axial) + std::abs(bending_y) + std::abs(bending_z);
+            }
+        }
+        return stresses;
+    }
+
+    void loadForces(SparseMat &force_vec, const std::vector<Force> &forces, unsigned int load_case) {
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
         unsigned int idx;
 
         for (size_t i = 0; i < forces.size(); ++i) {
             idx = dofs_per_elem * forces[i].node + forces[i].dof;
-            force_vec.insert(idx, 0) = forces[i].value;
+            force_vec.insert(idx, load_case) = forces[i].value;
         }
     };
 
-    Summary solve(const Job &job,
-                  const std::vector<BC> &BCs,
-                  const std::vector<Force> &forces,
-                  const std::vector<Tie> &ties,
-                  const std::vector<Equation> &equations,
-                  const Options &options) {
-        auto initial_start_time = std::chrono::high_resolution_clock::now();
-
-        Summary summary;
-        summary.num_nodes = job.nodes.size();
-        summary.num_elems = job.elems.size();
-        summary.num_bcs = BCs.size();
-        summary.num_ties = ties.size();
-
+    std::vector<long> computeReducedIndices(const std::vector<BC> &BCs, unsigned long size) {
         const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        std::vector<long> reduced_idx(size, 0);
 
-        // calculate size of global stiffness matrix and force vector
-        const unsigned long size = dofs_per_elem * job.nodes.size() + BCs.size() + equations.size();
-
-        // construct global stiffness matrix and force vector
-        SparseMat Kg(size, size);
-        SparseMat force_vec(size, 1);
-        force_vec.reserve(forces.size() + BCs.size());
-
-        // construct global assembler object and assemble global stiffness matrix
-        auto start_time = std::chrono::high_resolution_clock::now();
-        GlobalStiffAssembler assembleK3D = GlobalStiffAssembler();
-        assembleK3D(Kg, job, ties);
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        summary.assembly_time_in_ms = delta_time;
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            const unsigned long idx = dofs_per_elem * BCs[i].node + BCs[i].dof;
+            if (idx >= size) {
+                throw std::runtime_error(
+                        (boost::format("Boundary condition %d refers to node %d, which is not in the job.") % i %
+                         BCs[i].node).str()
+                );
+            }
+            if (reduced_idx[idx] < 0) {
+                throw std::runtime_error(
+                        (boost::format("Degree of freedom %d of node %d is prescribed by more than one boundary "
+                                       "condition.") % BCs[i].dof % BCs[i].node).str()
+                );
+            }
+            reduced_idx[idx] = -1;
+        }
 
-        if (options.verbose)
-            std::cout << "Global stiffness matrix assembled in "
-            << delta_time
-            << " ms.\nNow preprocessing factorization..." << std::endl;
+        long num_free = 0;
+        for (unsigned long i = 0; i < size; ++i) {
+            if (reduced_idx[i] == 0) {
+                reduced_idx[i] = num_free++;
+            }
+        }
+        return reduced_idx;
+    }
 
-        // load prescribed boundary conditions into stiffness matrix and force vector
-        loadBCs(Kg, force_vec, BCs, job.nodes.size());
+    void eliminateBCs(const SparseMat &Kg,
+                      const SparseMat &force_vec,
+                      const std::vector<BC> &BCs,
+                      const std::vector<long> &reduced_idx,
+                      bool upper_only,
+                      SparseMat &Kr,
+                      SparseMat &fr) {
+        typedef SparseMat::StorageIndex StorageIndex;
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        const long size = Kg.cols();
 
-        if (equations.size() > 0) {
-            loadEquations(Kg, equations, job.nodes.size(), BCs.size());
+        std::vector<double> prescribed(size, 0.0);
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            prescribed[dofs_per_elem * BCs[i].node + BCs[i].dof] = BCs[i].value;
         }
 
-        // load prescribed forces into force vector
-        if (forces.size() > 0) {
-            loadForces(force_vec, forces);
+        Eigen::MatrixXd rhs(force_vec);
+        long num_free = 0;
+        StorageIndex nnz = 0;
+        for (long j = 0; j < size; ++j) {
+            if (reduced_idx[j] >= 0) {
+                ++num_free;
+            }
+            for (SparseMat::InnerIterator it(Kg, j); it; ++it) {
+                if (reduced_idx[it.row()] >= 0 && reduced_idx[j] >= 0) {
+                    ++nnz;
+                }
+            }
         }
 
-        // compress global stiffness matrix since all non-zero values have been added.
-        Kg.prune(1.e-14);
-        Kg.makeCompressed();
+        // keep the coefficients between free unknowns and move the prescribed columns to the right hand side. The row
+        // order is preserved since the reduced indices are increasing.
+        Kr.resize(num_free, num_free);
+        Kr.resizeNonZeros(nnz);
+        StorageIndex *outer = Kr.outerIndexPtr();
+        StorageIndex *inner = Kr.innerIndexPtr();
+        double *values = Kr.valuePtr();
+
+        nnz = 0;
+        for (long j = 0; j < size; ++j) {
+            const long col = reduced_idx[j];
+            if (col >= 0) {
+                outer[col] = nnz;
+            }
+            for (SparseMat::InnerIterator it(Kg, j); it; ++it) {
+                const long row = reduced_idx[it.row()];
+                if (row >= 0 && col >= 0) {
+                    inner[nnz] = row;
+                    values[nnz] = it.value();
+                    ++nnz;
+                }
+                else if (row >= 0) {
+                    rhs.row(it.row()) -= Eigen::RowVectorXd::Constant(rhs.cols(), it.value() * prescribed[j]);
+                }
+                else if (col >= 0 && upper_only) {
+                    // the coefficient also stands for its mirror image below the diagonal
+                    rhs.row(j) -= Eigen::RowVectorXd::Constant(rhs.cols(), it.value() * prescribed[it.row()]);
+                }
+            }
+        }
+        outer[num_free] = nnz;
 
-        // initialize solver based on whether MKL should be used
+        Eigen::MatrixXd reduced_rhs(num_free, rhs.cols());
+        for (long i = 0; i < size; ++i) {
+            if (reduced_idx[i] >= 0) {
+                reduced_rhs.row(reduced_idx[i]) = rhs.row(i);
+            }
+        }
+        fr = reduced_rhs.sparseView(0.0, 0.0);
+    };
+
+    namespace {
+        // Builds the sorted adjacency list of each node in the graph formed by the elements and ties.
+        std::vector<std::vector<unsigned int> > buildNodeGraph(const Job &job, const std::vector<Tie> &ties) {
+            const unsigned int num_nodes = job.nodes.size();
+            std::vector<std::vector<unsigned int> > graph(num_nodes);
+
+            for (size_t i = 0; i < job.elems.size(); ++i) {
+                const unsigned int nn1 = job.elems[i](0);
+                const unsigned int nn2 = job.elems[i](1);
+                if (nn1 >= num_nodes || nn2 >= num_nodes) {
+                    throw std::runtime_error(
+                            (boost::format("Element %d refers to node %d, which is not in the job.") % i %
+                             std::max(nn1, nn2)).str()
+                    );
+                }
+                graph[nn1].push_back(nn2);
+                graph[nn2].push_back(nn1);
+            }
+            for (size_t i = 0; i < ties.size(); ++i) {
+                const unsigned int nn1 = ties[i].node_number_1;
+                const unsigned int nn2 = ties[i].node_number_2;
+                if (nn1 >= num_nodes || nn2 >= num_nodes) {
+                    throw std::runtime_error(
+                            (boost::format("Tie %d refers to node %d, which is not in the job.") % i %
+                             std::max(nn1, nn2)).str()
+                    );
+                }
+                graph[nn1].push_back(nn2);
+                graph[nn2].push_back(nn1);
+            }
+
+            for (unsigned int i = 0; i < num_nodes; ++i) {
+                std::sort(graph[i].begin(), graph[i].end());
+                graph[i].erase(std::unique(graph[i].begin(), graph[i].end()), graph[i].end());
+            }
+            return graph;
+        }
+
+        // Visits the component of root breadth first. Returns the visited nodes in queue and the depth of the
+        // search. The levels of the visited nodes are set in level and must be reset by the caller.
+        int breadthFirstDepth(const std::vector<std::vector<unsigned int> > &graph,
+                              unsigned int root,
+                              std::vector<int> &level,
+                              std::vector<unsigned int> &queue) {
+            queue.clear();
+            queue.push_back(root);
+            level[root] = 0;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                const unsigned int u = queue[head];
+                for (size_t k = 0; k < graph[u].size(); ++k) {
+                    const unsigned int v = graph[u][k];
+                    if (level[v] < 0) {
+                        level[v] = level[u] + 1;
+                        queue.push_back(v);
+                    }
+                }
+            }
+            return level[queue.back()];
+        }
+
+        // Finds a node of the component of start that is far from the other nodes, so the levels of a breadth first
+        // search from it are narrow (George and Liu, 1979).
+        unsigned int findPseudoPeripheralNode(const std::vector<std::vector<unsigned int> > &graph,
+                                              unsigned int start,
+                                              std::vector<int> &level,
+                                              std::vector<unsigned int> &queue) {
+            unsigned int root = start;
+            int depth = breadthFirstDepth(graph, root, level, queue);
+            while (true) {
+                // continue from the node with the smallest degree in the last level
+                unsigned int candidate = queue.back();
+                for (size_t k = 0; k < queue.size(); ++k) {
+                    if (level[queue[k]] == depth && graph[queue[k]].size() < graph[candidate].size()) {
+                        candidate = queue[k];
+                    }
+                }
+                for (size_t k = 0; k < queue.size(); ++k) {
+                    level[queue[k]] = -1;
+                }
+
+                const int candidate_depth = breadthFirstDepth(graph, candidate, level, queue);
+                if (candidate_depth <= depth) {
+                    break;
+                }
+                root = candidate;
+                depth = candidate_depth;
+            }
+            for (size_t k = 0; k < queue.size(); ++k) {
+                level[queue[k]] = -1;
+            }
+            return root;
+        }
+
+        // Orders the nodes with the reverse Cuthill-McKee algorithm. Components are started from their node with
+        // the smallest degree.
+        std::vector<unsigned int> orderReverseCuthillMcKee(const std::vector<std::vector<unsigned int> > &graph) {
+            const unsigned int num_nodes = graph.size();
+            std::vector<unsigned int> by_degree(num_nodes);
+            for (unsigned int i = 0; i < num_nodes; ++i) {
+                by_degree[i] = i;
+            }
+            std::stable_sort(by_degree.begin(), by_degree.end(), [&graph](unsigned int a, unsigned int b) {
+                return graph[a].size() < graph[b].size();
+            });
+
+            std::vector<unsigned int> order;
+            order.reserve(num_nodes);
+            std::vector<bool> visited(num_nodes, false);
+            std::vector<int> level(num_nodes, -1);
+            std::vector<unsigned int> queue, neighbours;
+
+            for (unsigned int s = 0; s < num_nodes; ++s) {
+                if (visited[by_degree[s]]) {
+                    continue;
+                }
+                const unsigned int root = findPseudoPeripheralNode(graph, by_degree[s], level, queue);
+
+                // Cuthill-McKee visits the unvisited neighbours of each node by increasing degree
+                size_t head = order.size();
+                order.push_back(root);
+                visited[root] = true;
+                for (; head < order.size(); ++head) {
+                    const unsigned int u = order[head];
+                    neighbours.clear();
+                    for (size_t k = 0; k < graph[u].size(); ++k) {
+                        if (!visited[graph[u][k]]) {
+                            visited[graph[u][k]] = true;
+                            neighbours.push_back(graph[u][k]);
+                        }
+                    }
+                    std::stable_sort(neighbours.begin(), neighbours.end(), [&graph](unsigned int a, unsigned int b) {
+                        return graph[a].size() < graph[b].size();
+                    });
+                    order.insert(order.end(), neighbours.begin(), neighbours.end());
+                }
+            }
+            std::reverse(order.begin(), order.end());
+            return order;
+        }
+
+        // Returns the index of a cell along a 3D Hilbert curve through a grid with 2^bits cells per axis.
+        // Uses the transposed representation of J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707,
+        // 2004.
+        uint64_t hilbertIndex(uint32_t x[3], int bits) {
+            const uint32_t M = 1u << (bits - 1);
+
+            // inverse undo excess work
+            for (uint32_t Q = M; Q > 1; Q >>= 1) {
+                const uint32_t P = Q - 1;
+                for (int i = 0; i < 3; ++i) {
+                    if (x[i] & Q) {
+                        x[0] ^= P;
+                    }
+                    else {
+                        const uint32_t t = (x[0] ^ x[i]) & P;
+                        x[0] ^= t;
+                        x[i] ^= t;
+                    }
+                }
+            }
+
+            // Gray encode
+            for (int i = 1; i < 3; ++i) {
+                x[i] ^= x[i - 1];
+            }
+            uint32_t t = 0;
+            for (uint32_t Q = M; Q > 1; Q >>= 1) {
+                if (x[2] & Q) {
+                    t ^= Q - 1;
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                x[i] ^= t;
+            }
+
+            // interleave the transposed bits, most significant first
+            uint64_t index = 0;
+            for (int b = bits - 1; b >= 0; --b) {
+                for (int i = 0; i < 3; ++i) {
+                    index = (index << 1) | ((x[i] >> b) & 1u);
+                }
+            }
+            return index;
+        }
+
+        // Orders the nodes along a Hilbert curve through the bounding box of their coordinates. All axes share
+        // the same scale so the curve is not distorted.
+        std::vector<unsigned int> orderHilbertCurve(const std::vector<Node> &nodes) {
+            const int bits = 21;
+            const unsigned int num_nodes = nodes.size();
+            std::vector<unsigned int> order(num_nodes);
+            if (num_nodes == 0) {
+                return order;
+            }
+
+            Eigen::Vector3d min_coords = nodes[0];
+            Eigen::Vector3d max_coords = nodes[0];
+            for (unsigned int i = 1; i < num_nodes; ++i) {
+                min_coords = min_coords.cwiseMin(nodes[i]);
+                max_coords = max_coords.cwiseMax(nodes[i]);
+            }
+            const double extent = (max_coords - min_coords).maxCoeff();
+            const double scale = extent > 0.0 ? ((1u << bits) - 1) / extent : 0.0;
+
+            std::vector<uint64_t> keys(num_nodes);
+            for (unsigned int i = 0; i < num_nodes; ++i) {
+                uint32_t x[3];
+                for (int j = 0; j < 3; ++j) {
+                    x[j] = static_cast<uint32_t>((nodes[i](j) - min_coords(j)) * scale);
+                }
+                keys[i] = hilbertIndex(x, bits);
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&keys](unsigned int a, unsigned int b) {
+                return keys[a] < keys[b];
+            });
+            return order;
+        }
+
+        // Returns the new index of a node referred to by the ith entry of a constraint.
+        unsigned int renumberNode(const Renumbering &renumbering,
+                                  unsigned int node,
+                                  const std::string &name,
+                                  size_t i) {
+            if (node >= renumbering.node_index.size()) {
+                throw std::runtime_error(
+                        (boost::format("%s %d refers to node %d, which is not in the job.") % name % i % node).str()
+                );
+            }
+            return renumbering.node_index[node];
+        }
+    }
+
+    Renumbering computeRenumbering(const Job &job, const std::vector<Tie> &ties, NodeOrdering ordering) {
+        const std::vector<std::vector<unsigned int> > graph = buildNodeGraph(job, ties);
+
+        std::vector<unsigned int> order;
+        if (ordering == REVERSE_CUTHILL_MCKEE) {
+            order = orderReverseCuthillMcKee(graph);
+        }
+        else if (ordering == HILBERT_CURVE) {
+            order = orderHilbertCurve(job.nodes);
+        }
+        else {
+            throw std::runtime_error("A renumbering can only be computed for a node ordering other than the input "
+                                     "order.");
+        }
+
+        Renumbering renumbering;
+        renumbering.node_index.resize(order.size());
+        for (unsigned int i = 0; i < order.size(); ++i) {
+            renumbering.node_index[order[i]] = i;
+        }
+
+        // sort the elements by their renumbered nodes
+        const std::vector<unsigned int> &node_index = renumbering.node_index;
+        renumbering.elem_order.resize(job.elems.size());
+        for (unsigned int i = 0; i < job.elems.size(); ++i) {
+            renumbering.elem_order[i] = i;
+        }
+        std::stable_sort(renumbering.elem_order.begin(), renumbering.elem_order.end(),
+                         [&job, &node_index](unsigned int a, unsigned int b) {
+                             const unsigned int a1 = node_index[job.elems[a](0)];
+                             const unsigned int a2 = node_index[job.elems[a](1)];
+                             const unsigned int b1 = node_index[job.elems[b](0)];
+                             const unsigned int b2 = node_index[job.elems[b](1)];
+                             return std::make_pair(std::min(a1, a2), std::max(a1, a2))
+                                    < std::make_pair(std::min(b1, b2), std::max(b1, b2));
+                         });
+        return renumbering;
+    }
+
+    void applyRenumbering(const Renumbering &renumbering,
+                          Job &job,
+                          std::vector<BC> &BCs,
+                          std::vector<Tie> &ties,
+                          std::vector<Equation> &equations) {
+        const std::vector<unsigned int> &node_index = renumbering.node_index;
+
+        std::vector<Node> nodes(job.nodes.size());
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            nodes[node_index[i]] = job.nodes[i];
+        }
+        job.nodes.swap(nodes);
+
+        std::vector<Eigen::Vector2i> elems(job.elems.size());
+        for (size_t i = 0; i < renumbering.elem_order.size(); ++i) {
+            const unsigned int elem = renumbering.elem_order[i];
+            elems[i] << node_index[job.elems[elem](0)], node_index[job.elems[elem](1)];
+        }
+        job.elems.swap(elems);
+
+        // a table of properties stays as is, only the index of each element moves
+        if (job.prop_ids.empty()) {
+            std::vector<Props> props(job.props.size());
+            for (size_t i = 0; i < renumbering.elem_order.size(); ++i) {
+                props[i] = job.props[renumbering.elem_order[i]];
+            }
+            job.props.swap(props);
+        }
+        else {
+            std::vector<unsigned int> prop_ids(job.prop_ids.size());
+            for (size_t i = 0; i < renumbering.elem_order.size(); ++i) {
+                prop_ids[i] = job.prop_ids[renumbering.elem_order[i]];
+            }
+            job.prop_ids.swap(prop_ids);
+        }
+
+        for (size_t i = 0; i < BCs.size(); ++i) {
+            BCs[i].node = renumberNode(renumbering, BCs[i].node, "Boundary condition", i);
+        }
+        for (size_t i = 0; i < ties.size(); ++i) {
+            ties[i].node_number_1 = renumberNode(renumbering, ties[i].node_number_1, "Tie", i);
+            ties[i].node_number_2 = renumberNode(renumbering, ties[i].node_number_2, "Tie", i);
+        }
+        for (size_t i = 0; i < equations.size(); ++i) {
+            for (size_t j = 0; j < equations[i].terms.size(); ++j) {
+                equations[i].terms[j].node_number = renumberNode(renumbering, equations[i].terms[j].node_number,
+                                                                 "Equation", i);
+            }
+        }
+    };
+
+    void applyRenumbering(const Renumbering &renumbering, std::vector<Force> &forces) {
+        for (size_t i = 0; i < forces.size(); ++i) {
+            forces[i].node = renumberNode(renumbering, forces[i].node, "Force", i);
+        }
+    };
+
+    class LinearSystemSolver {
+    public:
+        explicit LinearSystemSolver(const std::string &_name) : name(_name) { };
+
+        virtual ~LinearSystemSolver() { };
+
+        // Computes the ordering and symbolic factorization, or analyzes the preconditioner, from the structure of A.
+        virtual void analyzePattern(const SparseMat &A) = 0;
+
+        // Computes the numerical factorization, or the preconditioner, of A. Returns false if it failed.
+        virtual bool factorize(const SparseMat &A) = 0;
+
+        // Solves for each column of rhs. Iterative solvers record their iterations and residual in the summary.
+        virtual Eigen::MatrixXd solve(const Eigen::MatrixXd &rhs, Summary &summary) = 0;
+
+        const std::string name;
+    };
+
+    namespace {
+        // Direct solver that solves all load cases with one call.
+        template<typename Solver>
+        class DirectSolver : public LinearSystemSolver {
+        public:
+            explicit DirectSolver(const std::string &_name) : LinearSystemSolver(_name) { };
+
+            void analyzePattern(const SparseMat &A) {
+                solver.analyzePattern(A);
+            }
+
+            bool factorize(const SparseMat &A) {
+                solver.factorize(A);
+                return solver.info() == Eigen::Success;
+            }
+
+            Eigen::MatrixXd solve(const Eigen::MatrixXd &rhs, Summary &) {
+                return solver.solve(rhs);
+            }
+
+        private:
+            Solver solver;
+        };
+
+        // Iterative solver with the tolerance and iteration limit of the options. The load cases are solved one at a
+        // time since the solver only reports the convergence of the last right hand side.
+        template<typename Solver>
+        class IterativeSolver : public LinearSystemSolver {
+        public:
+            IterativeSolver(const std::string &_name, const Options &options) : LinearSystemSolver(_name) {
+                solver.setTolerance(options.tolerance);
+                if (options.max_iterations > 0) {
+                    solver.setMaxIterations(options.max_iterations);
+                }
+            };
+
+            typename Solver::Preconditioner &preconditioner() {
+                return solver.preconditioner();
+            }
+
+            void analyzePattern(const SparseMat &A) {
+                solver.analyzePattern(A);
+            }
+
+            bool factorize(const SparseMat &A) {
+                solver.factorize(A);
+                return solver.info() == Eigen::Success;
+            }
+
+            // Records the largest number of iterations and residual over all load cases.
+            Eigen::MatrixXd solve(const Eigen::MatrixXd &rhs, Summary &summary) {
+                Eigen::MatrixXd x(solver.cols(), rhs.cols());
+                for (long j = 0; j < rhs.cols(); ++j) {
+                    x.col(j) = solver.solve(rhs.col(j));
+                    summary.iterations = std::max<unsigned long>(summary.iterations, solver.iterations());
+                    summary.residual = std::max(summary.residual, solver.error());
+
+                    if (solver.info() != Eigen::Success) {
+                        throw std::runtime_error(
+                                (boost::format("%s did not converge within %d iterations for load case %d. The "
+                                               "relative residual is %.3e.") % name % solver.iterations() % j %
+                                 solver.error()).str()
+                        );
+                    }
+                }
+                return x;
+            }
+
+        private:
+            Solver solver;
+        };
+
+        // Creates an iterative solver with the preconditioner requested in the options. Block starts give the first
+        // unknown of each node and each Lagrange multiplier for the block-Jacobi preconditioner.
+        template<template<typename> class SolverWithPreconditioner>
+        std::unique_ptr<LinearSystemSolver> createIterativeSolver(const std::vector<long> &block_starts,
+                                                                  const std::string &name,
+                                                                  const Options &options) {
+            if (options.preconditioner == INCOMPLETE_CHOLESKY) {
+                typedef SolverWithPreconditioner<Eigen::IncompleteCholesky<double, Eigen::Upper> > Solver;
+                return std::unique_ptr<LinearSystemSolver>(
+                        new IterativeSolver<Solver>(name + ", incomplete Cholesky)", options));
+            }
+            typedef SolverWithPreconditioner<NodalBlockJacobiPreconditioner> Solver;
+            IterativeSolver<Solver> *solver = new IterativeSolver<Solver>(name + ", block Jacobi)", options);
+            solver->preconditioner().setBlockStarts(block_starts);
+            solver->preconditioner().setNumThreads(options.num_threads);
+            return std::unique_ptr<LinearSystemSolver>(solver);
+        }
+
+        // Returns the first unknown of each node and of each Lagrange multiplier in the system given by reduced_idx.
+        std::vector<long> computeBlockStarts(unsigned long num_nodes, const std::vector<long> &reduced_idx) {
+            const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+            const unsigned long num_dofs = dofs_per_elem * num_nodes;
+
+            std::vector<long> block_starts;
+            long prev_block = -1;
+            for (unsigned long i = 0; i < reduced_idx.size(); ++i) {
+                if (reduced_idx[i] < 0) {
+                    continue;
+                }
+                const long block = i < num_dofs ? i / dofs_per_elem : num_nodes + (i - num_dofs);
+                if (block != prev_block) {
+                    block_starts.push_back(reduced_idx[i]);
+                    prev_block = block;
+                }
+            }
+            return block_starts;
+        }
+
+        template<typename Preconditioner>
+        using UpperConjugateGradient = Eigen::ConjugateGradient<SparseMat, Eigen::Upper, Preconditioner>;
+
+        template<typename Preconditioner>
+        using UpperMINRES = Eigen::MINRES<SparseMat, Eigen::Upper, Preconditioner>;
+
+        template<typename Preconditioner>
+        using FullGMRES = Eigen::GMRES<SparseMat, Preconditioner>;
+
+        // Creates the solver requested in the options.
+        std::unique_ptr<LinearSystemSolver> createLinearSystemSolver(const std::vector<long> &block_starts,
+                                                                     bool has_multipliers,
+                                                                     const Options &options) {
+            const bool is_iterative = options.linear_solver == CONJUGATE_GRADIENT
+                                      || options.linear_solver == MINRES
+                                      || options.linear_solver == GMRES;
+            if (has_multipliers && (options.linear_solver == CONJUGATE_GRADIENT
+                                    || (is_iterative && options.preconditioner == INCOMPLETE_CHOLESKY))) {
+                throw std::runtime_error(
+                        "The conjugate gradient method and the incomplete Cholesky preconditioner require a positive "
+                        "definite system. Set eliminate_bcs and remove all equations, or use MINRES or GMRES with "
+                        "the block Jacobi preconditioner."
+                );
+            }
+
+            if (options.linear_solver == CONJUGATE_GRADIENT) {
+                return createIterativeSolver<UpperConjugateGradient>(block_starts, "ConjugateGradient (upper triangle",
+                                                                     options);
+            }
+            if (options.linear_solver == MINRES) {
+                return createIterativeSolver<UpperMINRES>(block_starts, "MINRES (upper triangle", options);
+            }
+            if (options.linear_solver == GMRES) {
+                return createIterativeSolver<FullGMRES>(block_starts, "GMRES (full matrix", options);
+            }
+
+            // initialize solver based on the requested method and whether MKL should be used
+            if (options.linear_solver == SPARSE_LDLT) {
 #ifdef EIGEN_USE_MKL_ALL
-        Eigen::PardisoLU<SparseMat> solver;
+                return std::unique_ptr<LinearSystemSolver>(
+                        new DirectSolver<Eigen::PardisoLDLT<SparseMat, Eigen::Upper> >("PardisoLDLT (upper triangle)"));
 #else
-        Eigen::SparseLU<SparseMat> solver;
+                typedef Eigen::SimplicialLDLT<SparseMat, Eigen::Upper,
+                        LagrangeMultiplierOrdering<SparseMat::StorageIndex> > Solver;
+                return std::unique_ptr<LinearSystemSolver>(
+                        new DirectSolver<Solver>("SimplicialLDLT (upper triangle)"));
 #endif
+            }
+#ifdef EIGEN_USE_MKL_ALL
+            return std::unique_ptr<LinearSystemSolver>(new DirectSolver<Eigen::PardisoLU<SparseMat> >("PardisoLU"));
+#else
+            return std::unique_ptr<LinearSystemSolver>(new DirectSolver<Eigen::SparseLU<SparseMat> >("SparseLU"));
+#endif
+        }
+
+        // Checks if two compressed matrices store the same entries.
+        bool haveSameStructure(const SparseMat &a, const SparseMat &b) {
+            return a.rows() == b.rows() && a.cols() == b.cols() && a.nonZeros() == b.nonZeros()
+                   && std::equal(a.outerIndexPtr(), a.outerIndexPtr() + a.outerSize() + 1, b.outerIndexPtr())
+                   && std::equal(a.innerIndexPtr(), a.innerIndexPtr() + a.nonZeros(), b.innerIndexPtr());
+        }
+
+        // Converts one column of a matrix with the nodal values of all load cases into one row per node in the input
+        // numbering. Values smaller than options.epsilon are rounded to 0.0.
+        ResultMatrix toNodalValues(const Eigen::MatrixXd &values,
+                                   long load_case,
+                                   unsigned long num_nodes,
+                                   const Renumbering &renumbering,
+                                   const Options &options) {
+            const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+            const double epsilon = options.epsilon;
+            ResultMatrix nodal_values(num_nodes, dofs_per_elem);
+#pragma omp parallel for num_threads(resolveNumThreads(options.num_threads))
+            for (long i = 0; i < static_cast<long>(num_nodes); ++i) {
+                const size_t node = renumbering.node_index.empty() ? i : renumbering.node_index[i];
+                for (unsigned int j = 0; j < dofs_per_elem; ++j) {
+                    const double value = values(dofs_per_elem * node + j, load_case);
+                    nodal_values(i, j) = std::abs(value) < epsilon ? 0.0 : value;
+                }
+            }
+            return nodal_values;
+        }
+
+        // Multiplies the coefficient matrix, of which only the upper triangle may be stored, with the columns of x.
+        Eigen::MatrixXd multiplySystemMatrix(const SparseMat &K, bool upper_only, const Eigen::MatrixXd &x) {
+            if (upper_only) {
+                return K.selfadjointView<Eigen::Upper>() * x;
+            }
+            return K * x;
+        }
+
+        // Appends "_case<load_case>" to the file name before its extension.
+        std::string loadCaseFilename(const std::string &filename, size_t load_case) {
+            const std::string suffix = (boost::format("_case%d") % load_case).str();
+            const size_t dot = filename.find_last_of('.');
+            const size_t slash = filename.find_last_of("/\\");
+            if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+                return filename + suffix;
+            }
+            return filename.substr(0, dot) + suffix + filename.substr(dot);
+        }
 
-        //Compute the ordering permutation vector from the structural pattern of Kg
-        start_time = std::chrono::high_resolution_clock::now();
-        solver.analyzePattern(Kg);
-        end_time = std::chrono::high_resolution_clock::now();
-        delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        // Returns the name of the result file of a load case, with the extension of the result format.
+        std::string resultFilename(const std::string &filename, const Options &options, size_t load_case,
+                                   size_t num_cases) {
+            std::string result_filename = filename;
+            const std::string csv_extension = ".csv";
+            if (options.result_format == NPY_RESULTS && result_filename.size() > csv_extension.size()
+                && result_filename.compare(result_filename.size() - csv_extension.size(), csv_extension.size(),
+                                           csv_extension) == 0) {
+                result_filename.replace(result_filename.size() - csv_extension.size(), csv_extension.size(), ".npy");
+            }
+            return num_cases > 1 ? loadCaseFilename(result_filename, load_case) : result_filename;
+        }
 
-        summary.preprocessing_time_in_ms = delta_time;
+        // Saves nodal, tie or element results in the format given by the options.
+        template<typename Matrix>
+        void saveResults(const std::string &filename, const Matrix &results, const Options &options) {
+            if (options.result_format == NPY_RESULTS) {
+                writeNpyFile(filename, results.data(), results.rows(), results.cols());
+            }
+            else {
+                CSVParser csv;
+                csv.write(filename, results, options.csv_precision, options.csv_delimiter, options.num_threads);
+            }
+        }
+
+        // Returns the nodes and elements of the job and the ties in the input numbering. The properties are left out.
+        void restoreInputNumbering(const Renumbering &renumbering,
+                                   const Job &job,
+                                   const std::vector<Tie> &ties,
+                                   Job &input_job,
+                                   std::vector<Tie> &input_ties) {
+            const std::vector<unsigned int> &node_index = renumbering.node_index;
+            std::vector<unsigned int> input_node(node_index.size());
+            input_job.nodes.resize(job.nodes.size());
+            for (size_t i = 0; i < node_index.size(); ++i) {
+                input_node[node_index[i]] = i;
+                input_job.nodes[i] = job.nodes[node_index[i]];
+            }
+
+            input_job.elems.resize(job.elems.size());
+            for (size_t i = 0; i < renumbering.elem_order.size(); ++i) {
+                input_job.elems[renumbering.elem_order[i]] << input_node[job.elems[i](0)],
+                        input_node[job.elems[i](1)];
+            }
+
+            input_ties = ties;
+            for (size_t i = 0; i < ties.size(); ++i) {
+                input_ties[i].node_number_1 = input_node[ties[i].node_number_1];
+                input_ties[i].node_number_2 = input_node[ties[i].node_number_2];
+            }
+        }
+
+        // Checks that every element has properties, either its own or an entry of the table of properties.
+        void checkProps(const Job &job) {
+            if (job.prop_ids.empty()) {
+                if (job.props.size() != job.elems.size()) {
+                    throw std::runtime_error(
+                            (boost::format("%d properties were given for %d elements.") % job.props.size() %
+                             job.elems.size()).str()
+                    );
+                }
+                return;
+            }
+            if (job.prop_ids.size() != job.elems.size()) {
+                throw std::runtime_error(
+                        (boost::format("%d property ids were given for %d elements.") % job.prop_ids.size() %
+                         job.elems.size()).str()
+                );
+            }
+            for (size_t i = 0; i < job.prop_ids.size(); ++i) {
+                if (job.prop_ids[i] >= job.props.size()) {
+                    throw std::runtime_error(
+                            (boost::format("Element %d refers to property %d, but only %d properties were given.")
+                             % i % job.prop_ids[i] % job.props.size()).str()
+                    );
+                }
+            }
+        }
+    }
+
+    Analysis::Analysis(const Job &_job,
+                       const std::vector<BC> &_BCs,
+                       const std::vector<Tie> &_ties,
+                       const std::vector<Equation> &_equations,
+                       const Options &_options)
+            : job(&_job),
+              BCs(&_BCs),
+              ties(&_ties),
+              equations(&_equations),
+              options(_options),
+              upper_only(storesUpperTriangle(_options)),
+              is_assembled(false),
+              is_analyzed(false),
+              is_factorized(false) {
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+
+        checkProps(_job);
+
+        // renumber a copy of the model internally. The results are mapped back to the input numbering.
+        if (options.node_ordering != ORIGINAL_ORDER) {
+            renumbering = computeRenumbering(_job, _ties, options.node_ordering);
+            job_copy = _job;
+            BCs_copy = _BCs;
+            ties_copy = _ties;
+            equations_copy = _equations;
+            applyRenumbering(renumbering, job_copy, BCs_copy, ties_copy, equations_copy);
+            job = &job_copy;
+            BCs = &BCs_copy;
+            ties = &ties_copy;
+            equations = &equations_copy;
+        }
+
+        // calculate size of global stiffness matrix and force vector. Boundary conditions only add Lagrange
+        // multipliers if they are not eliminated.
+        const unsigned long num_bc_multipliers = options.eliminate_bcs ? 0 : BCs->size();
+        size = dofs_per_elem * job->nodes.size() + num_bc_multipliers + equations->size();
+
+        if (options.eliminate_bcs) {
+            system_idx = computeReducedIndices(*BCs, size);
+        }
+        else {
+            system_idx.resize(size);
+            for (unsigned long i = 0; i < size; ++i) {
+                system_idx[i] = i;
+            }
+        }
+
+        phase_summary.num_nodes = job->nodes.size();
+        phase_summary.num_elems = job->elems.size();
+        phase_summary.num_bcs = BCs->size();
+        phase_summary.num_ties = ties->size();
+        phase_summary.num_eqns = equations->size();
+    };
+
+    Analysis::~Analysis() { };
+
+    void Analysis::setProps(const std::vector<Props> &props) {
+        if (props.size() != job->elems.size()) {
+            throw std::runtime_error(
+                    (boost::format("%d properties were given for %d elements.") % props.size() %
+                     job->elems.size()).str()
+            );
+        }
+        // the input job is left untouched, so the properties are replaced in a copy
+        if (job != &job_copy) {
+            job_copy = *job;
+            job = &job_copy;
+        }
+
+        // the new properties are stored per element, replacing a table of properties
+        job_copy.prop_ids.clear();
+        if (renumbering.elem_order.empty()) {
+            job_copy.props = props;
+        }
+        else {
+            job_copy.props.resize(props.size());
+            for (size_t i = 0; i < renumbering.elem_order.size(); ++i) {
+                job_copy.props[i] = props[renumbering.elem_order[i]];
+            }
+        }
+        is_assembled = false;
+        is_factorized = false;
+    };
+
+    void Analysis::assemble() {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        // construct global assembler object and assemble global stiffness matrix
+        SparseMat K;
+        GlobalStiffAssembler assembleK3D = GlobalStiffAssembler(options);
+        SparseMat bc_rhs(size, 1);
+        if (options.use_sparsity_pattern) {
+            // the pattern only depends on the topology and the constraints, so it is computed once. Kg keeps its
+            // structure and only its values are updated in place, without pruning, so repeated assemblies do not
+            // allocate and the symbolic analysis of the system stays valid.
+            const std::vector<BC> no_bcs;
+            const std::vector<BC> &multiplier_bcs = options.eliminate_bcs ? no_bcs : *BCs;
+            if (pattern.outer_index.empty()) {
+                pattern = computeSparsityPattern(*job, *ties, multiplier_bcs, *equations, upper_only);
+                Kg.resize(size, size);
+            }
+            assembleK3D(Kg, *job, *ties, pattern);
+            loadBCs(Kg, bc_rhs, multiplier_bcs, pattern);
+            loadEquations(Kg, *equations, pattern);
+        }
+        else {
+            K.resize(size, size);
+            assembleK3D(K, *job, *ties);
+
+            // load prescribed boundary conditions into stiffness matrix and the right hand side shared by all load
+            // cases
+            if (!options.eliminate_bcs) {
+                loadBCs(K, bc_rhs, *BCs, job->nodes.size(), upper_only);
+            }
+
+            if (equations->size() > 0) {
+                loadEquations(K, *equations, job->nodes.size(), options.eliminate_bcs ? 0 : BCs->size(), upper_only);
+            }
+
+            // compress global stiffness matrix since all non-zero values have been added.
+            K.prune(1.e-14);
+            K.makeCompressed();
+        }
+
+        // the symbolic analysis stays valid as long as the structure of the solved system is unchanged
+        if (options.eliminate_bcs) {
+            // remove the prescribed degrees of freedom
+            SparseMat K_reduced, f_reduced;
+            eliminateBCs(options.use_sparsity_pattern ? Kg : K, bc_rhs, *BCs, system_idx, upper_only, K_reduced,
+                         f_reduced);
+            is_analyzed = is_analyzed && haveSameStructure(Kr, K_reduced);
+            Kr.swap(K_reduced);
+            base_rhs = Eigen::VectorXd(f_reduced);
+        }
+        else {
+            // with a sparsity pattern Kg was updated in place, so its structure is unchanged
+            is_analyzed = is_analyzed && (options.use_sparsity_pattern || haveSameStructure(Kg, K));
+            base_rhs = Eigen::VectorXd(bc_rhs);
+        }
+        if (!options.use_sparsity_pattern) {
+            Kg.swap(K);
+        }
+        is_assembled = true;
+        is_factorized = false;
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        phase_summary.assembly_time_in_ms = delta_time;
+        phase_summary.num_stiffness_nonzeros = getSystemMatrix().nonZeros();
+
+        if (options.verbose)
+            std::cout << "Global stiffness matrix assembled in "
+            << delta_time
+            << " ms.\nNow preprocessing factorization..." << std::endl;
+    };
+
+    void Analysis::analyzePattern() {
+        if (!is_assembled) {
+            assemble();
+        }
+
+        if (!solver) {
+            const unsigned long num_dofs = DOF::NUM_DOFS * job->nodes.size();
+            const bool has_multipliers = options.eliminate_bcs ? equations->size() > 0 : size > num_dofs;
+            solver = createLinearSystemSolver(computeBlockStarts(job->nodes.size(), system_idx), has_multipliers,
+                                              options);
+            phase_summary.linear_solver = solver->name;
+        }
+
+        //Compute the ordering permutation vector from the structural pattern of the system
+        auto start_time = std::chrono::high_resolution_clock::now();
+        solver->analyzePattern(getSystemMatrix());
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+        phase_summary.preprocessing_time_in_ms = delta_time;
+        is_analyzed = true;
+        is_factorized = false;
 
         if (options.verbose)
             std::cout << "Preprocessing step of factorization completed in "
             << delta_time
             << " ms.\nNow factorizing global stiffness matrix..." << std::endl;
+    };
+
+    void Analysis::factorize() {
+        if (!is_assembled) {
+            assemble();
+        }
+        if (!is_analyzed) {
+            analyzePattern();
+        }
 
         // Compute the numerical factorization
-        start_time = std::chrono::high_resolution_clock::now();
-        solver.factorize(Kg);
-        end_time = std::chrono::high_resolution_clock::now();
+        auto start_time = std::chrono::high_resolution_clock::now();
+        const bool success = solver->factorize(getSystemMatrix());
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        if (!success) {
+            throw std::runtime_error(
+                    (boost::format("Factorization of the global stiffness matrix with %s failed. "
+                                   "Check that the model is sufficiently constrained.") % solver->name).str()
+            );
+        }
 
-        delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        summary.factorization_time_in_ms = delta_time;
+        auto delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        phase_summary.factorization_time_in_ms = delta_time;
+        is_factorized = true;
 
         if (options.verbose)
             std::cout << "Factorization completed in "
             << delta_time
             << " ms. Now solving system..." << std::endl;
+    };
+
+    Summary Analysis::solve(const std::vector<Force> &forces) {
+        const std::vector<std::vector<Force> > load_cases(1, forces);
+        return solve(load_cases)[0];
+    };
+
+    std::vector<Summary> Analysis::solve(const std::vector<std::vector<Force> > &load_cases) {
+        if (load_cases.empty()) {
+            throw std::runtime_error("At least one load case must be specified.");
+        }
+
+        auto initial_start_time = std::chrono::high_resolution_clock::now();
+
+        if (!is_factorized) {
+            factorize();
+        }
+
+        // results shared by all load cases
+        Summary summary = phase_summary;
+
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        const unsigned long num_dofs = dofs_per_elem * job->nodes.size();
+        const long num_cases = load_cases.size();
+
+        // construct the prescribed forces with one column per load case
+        SparseMat force_vec(size, num_cases);
+        size_t num_forces = 0;
+        for (long i = 0; i < num_cases; ++i) {
+            num_forces += load_cases[i].size();
+        }
+        force_vec.reserve(num_forces);
+        for (long i = 0; i < num_cases; ++i) {
+            if (load_cases[i].size() > 0 && !renumbering.node_index.empty()) {
+                std::vector<Force> forces = load_cases[i];
+                applyRenumbering(renumbering, forces);
+                loadForces(force_vec, forces, i);
+            }
+            else if (load_cases[i].size() > 0) {
+                loadForces(force_vec, load_cases[i], i);
+            }
+        }
+        force_vec.makeCompressed();
+
+        // add the forces to the right hand side of the solved system. Forces on eliminated degrees of freedom only
+        // affect the reactions.
+        Eigen::MatrixXd rhs = base_rhs.replicate(1, num_cases);
+        for (long j = 0; j < num_cases; ++j) {
+            for (SparseMat::InnerIterator it(force_vec, j); it; ++it) {
+                if (system_idx[it.row()] >= 0) {
+                    rhs(system_idx[it.row()], j) += it.value();
+                }
+            }
+        }
 
         //Use the factors to solve the linear system
-        start_time = std::chrono::high_resolution_clock::now();
-        SparseMat dispSparse = solver.solve(force_vec);
-        end_time = std::chrono::high_resolution_clock::now();
-        delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        auto start_time = std::chrono::high_resolution_clock::now();
+        const Eigen::MatrixXd solution = solver->solve(rhs, summary);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
 
         summary.solve_time_in_ms = delta_time;
 
@@ -494,88 +2161,251 @@ namespace fea {
             << delta_time
             << " ms.\n" << std::endl;
 
-        // convert to dense matrix
-        Eigen::VectorXd disp(dispSparse);
-
-        // convert from Eigen vector to std vector
-        std::vector<std::vector<double> > disp_vec(job.nodes.size(), std::vector<double>(dofs_per_elem));
-        for (size_t i = 0; i < disp_vec.size(); ++i) {
-            for (unsigned int j = 0; j < dofs_per_elem; ++j)
-                // round all values close to 0.0
-                disp_vec[i][j] =
-                        std::abs(disp(dofs_per_elem * i + j)) < options.epsilon ? 0.0 : disp(dofs_per_elem * i + j);
-        }
-        summary.nodal_displacements = disp_vec;
-
-        // [calculate nodal forces
-        start_time = std::chrono::high_resolution_clock::now();
-
-        Kg = Kg.topLeftCorner(dofs_per_elem * job.nodes.size(), dofs_per_elem * job.nodes.size());
-        dispSparse = dispSparse.topRows(dofs_per_elem * job.nodes.size());
+        Eigen::MatrixXd disp;
+        Eigen::MatrixXd reactions;
+        if (options.eliminate_bcs) {
+            // expand to all unknowns. Prescribed degrees of freedom take the value of their boundary condition.
+            disp.setZero(size, num_cases);
+            for (unsigned long i = 0; i < size; ++i) {
+                if (system_idx[i] >= 0) {
+                    disp.row(i) = solution.row(system_idx[i]);
+                }
+            }
+            for (size_t i = 0; i < BCs->size(); ++i) {
+                disp.row(dofs_per_elem * (*BCs)[i].node + (*BCs)[i].dof).setConstant((*BCs)[i].value);
+            }
 
-        SparseMat nodal_forces_sparse = Kg * dispSparse;
+            // the reaction of each boundary condition balances the residual of the unreduced system
+            if (options.compute_reaction_forces) {
+                Eigen::MatrixXd residual = multiplySystemMatrix(Kg, upper_only, disp);
+                residual -= Eigen::MatrixXd(force_vec);
 
-        Eigen::VectorXd nodal_forces_dense(nodal_forces_sparse);
+                reactions.resize(BCs->size(), num_cases);
+                for (size_t i = 0; i < BCs->size(); ++i) {
+                    reactions.row(i) = residual.row(dofs_per_elem * (*BCs)[i].node + (*BCs)[i].dof);
+                }
+            }
+        }
+        else {
+            disp = solution;
 
-        std::vector<std::vector<double> > nodal_forces_vec(job.nodes.size(), std::vector<double>(dofs_per_elem));
-        for (size_t i = 0; i < nodal_forces_vec.size(); ++i) {
-            for (unsigned int j = 0; j < dofs_per_elem; ++j)
-                // round all values close to 0.0
-                nodal_forces_vec[i][j] = std::abs(nodal_forces_dense(dofs_per_elem * i + j)) < options.epsilon ? 0.0
-                                                                                                               : nodal_forces_dense(
-                                dofs_per_elem * i + j);
+            // the Lagrange multiplier of each boundary condition is the negated reaction
+            if (options.compute_reaction_forces) {
+                reactions = -disp.middleRows(num_dofs, BCs->size());
+            }
         }
-        summary.nodal_forces = nodal_forces_vec;
 
-        end_time = std::chrono::high_resolution_clock::now();
+        // the Lagrange multipliers of the equations follow those of the boundary conditions
+        const unsigned long num_bc_multipliers = options.eliminate_bcs ? 0 : BCs->size();
+        const Eigen::MatrixXd equation_forces = -disp.middleRows(num_dofs + num_bc_multipliers, equations->size());
 
-        summary.nodal_forces_solve_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                end_time - start_time).count();
-        //]
+        // results that are neither requested nor written to a file are skipped
+        const bool needs_nodal_forces = options.compute_nodal_forces || options.save_nodal_forces || options.save_vtu;
+        const bool needs_tie_forces = options.compute_tie_forces || options.save_tie_forces || options.save_vtu;
+        const bool needs_elem_forces = options.compute_elem_forces || options.save_elem_forces;
 
-        // [ calculate forces associated with ties
-        if (ties.size() > 0) {
+        // [calculate nodal forces of all load cases. The Lagrange multipliers are set to zero so only the
+        // stiffness of the elements and ties contributes.
+        Eigen::MatrixXd nodal_forces_dense;
+        if (needs_nodal_forces) {
             start_time = std::chrono::high_resolution_clock::now();
-            summary.tie_forces = computeTieForces(ties, disp_vec);
+
+            Eigen::MatrixXd nodal_disp = disp;
+            nodal_disp.bottomRows(size - num_dofs).setZero();
+            nodal_forces_dense = multiplySystemMatrix(Kg, upper_only, nodal_disp);
+
             end_time = std::chrono::high_resolution_clock::now();
-            summary.tie_forces_solve_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            summary.nodal_forces_solve_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                     end_time - start_time).count();
         }
-        // ]
+        //]
 
-        // [save files specified in options
-        CSVParser csv;
-        start_time = std::chrono::high_resolution_clock::now();
-        if (options.save_nodal_displacements) {
-            csv.write(options.nodal_displacements_filename, disp_vec, options.csv_precision, options.csv_delimiter);
+        // the vtu files show the model in the input numbering
+        Job input_job;
+        std::vector<Tie> input_ties;
+        if (options.save_vtu && !renumbering.node_index.empty()) {
+            restoreInputNumbering(renumbering, *job, *ties, input_job, input_ties);
         }
+        const Job &vtu_job = renumbering.node_index.empty() ? *job : input_job;
+        const std::vector<Tie> &vtu_ties = renumbering.node_index.empty() ? *ties : input_ties;
 
-        if (options.save_nodal_forces) {
-            csv.write(options.nodal_forces_filename, nodal_forces_vec, options.csv_precision, options.csv_delimiter);
+        // the element data is gathered once for the element forces of all load cases
+        std::unique_ptr<ElemSoA> elems;
+        if (needs_elem_forces) {
+            elems.reset(new ElemSoA(*job, options.num_threads));
         }
 
-        if (options.save_tie_forces) {
-            csv.write(options.tie_forces_filename, summary.tie_forces, options.csv_precision, options.csv_delimiter);
-        }
+        std::vector<Summary> summaries(num_cases, summary);
+        for (long c = 0; c < num_cases; ++c) {
+            Summary &case_summary = summaries[c];
+            case_summary.num_forces = load_cases[c].size();
+
+            // convert the columns of the load case to one row per node
+            case_summary.nodal_displacements = toNodalValues(disp, c, job->nodes.size(), renumbering, options);
+            if (needs_nodal_forces) {
+                case_summary.nodal_forces = toNodalValues(nodal_forces_dense, c, job->nodes.size(), renumbering,
+                                                          options);
+            }
+
+            if (options.compute_reaction_forces) {
+                case_summary.reaction_forces.resize(BCs->size());
+                for (size_t i = 0; i < BCs->size(); ++i) {
+                    case_summary.reaction_forces[i] = reactions(i, c);
+                }
+            }
+
+            case_summary.equation_forces.resize(equations->size());
+            for (size_t i = 0; i < equations->size(); ++i) {
+                case_summary.equation_forces[i] = equation_forces(i, c);
+            }
 
-        end_time = std::chrono::high_resolution_clock::now();
-        summary.file_save_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                end_time - start_time).count();
-        // ]
+            // the ties and elements refer to the internal numbering of the nodes
+            ResultMatrix internal_displacements;
+            if (!renumbering.node_index.empty() && ((ties->size() > 0 && needs_tie_forces) || needs_elem_forces)) {
+                internal_displacements = toNodalValues(disp, c, job->nodes.size(), Renumbering(), options);
+            }
+            const ResultMatrix &job_displacements = renumbering.node_index.empty() ? case_summary.nodal_displacements
+                                                                                   : internal_displacements;
+
+            // [ calculate forces associated with ties.
+            if (ties->size() > 0 && needs_tie_forces) {
+                start_time = std::chrono::high_resolution_clock::now();
+                case_summary.tie_forces = computeTieForces(*ties, job_displacements);
+                end_time = std::chrono::high_resolution_clock::now();
+                case_summary.tie_forces_solve_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        end_time - start_time).count();
+            }
+            // ]
+
+            // [ calculate the local end forces of the elements in the input order of the elements.
+            if (needs_elem_forces) {
+                start_time = std::chrono::high_resolution_clock::now();
+                ElemResultMatrix elem_forces = computeElemForces(*job, *elems, job_displacements, options.num_threads);
+                if (renumbering.elem_order.empty()) {
+                    case_summary.elem_forces.swap(elem_forces);
+                }
+                else {
+                    const long num_elems = elem_forces.rows();
+                    case_summary.elem_forces.resize(num_elems, elem_forces.cols());
+#pragma omp parallel for num_threads(resolveNumThreads(options.num_threads))
+                    for (long i = 0; i < num_elems; ++i) {
+                        case_summary.elem_forces.row(renumbering.elem_order[i]) = elem_forces.row(i);
+                    }
+                }
+                end_time = std::chrono::high_resolution_clock::now();
+                case_summary.elem_forces_solve_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        end_time - start_time).count();
+            }
+            // ]
+
+            // [gather the statistics of the results, so the report only has to format them
+            case_summary.nodal_displacement_statistics = computeResultStatistics(
+                    case_summary.nodal_displacements, options.num_largest_values, options.num_histogram_bins,
+                    options.num_threads);
+            case_summary.nodal_force_statistics = computeResultStatistics(
+                    case_summary.nodal_forces, options.num_largest_values, options.num_histogram_bins,
+                    options.num_threads);
+            case_summary.tie_force_statistics = computeResultStatistics(
+                    case_summary.tie_forces, options.num_largest_values, options.num_histogram_bins,
+                    options.num_threads);
+            // ]
+
+            // [save files specified in options. Each load case gets its own files if there are several.
+            start_time = std::chrono::high_resolution_clock::now();
+            if (options.save_nodal_displacements) {
+                saveResults(resultFilename(options.nodal_displacements_filename, options, c, num_cases),
+                            case_summary.nodal_displacements, options);
+            }
+
+            if (options.save_nodal_forces) {
+                saveResults(resultFilename(options.nodal_forces_filename, options, c, num_cases),
+                            case_summary.nodal_forces, options);
+            }
+
+            if (options.save_tie_forces) {
+                saveResults(resultFilename(options.tie_forces_filename, options, c, num_cases),
+                            case_summary.tie_forces, options);
+            }
+
+            if (options.save_elem_forces) {
+                saveResults(resultFilename(options.elem_forces_filename, options, c, num_cases),
+                            case_summary.elem_forces, options);
+            }
+
+            if (options.save_vtu) {
+                const std::string filename = num_cases > 1 ? loadCaseFilename(options.vtu_filename, c)
+                                                           : options.vtu_filename;
+                writeVtuFile(filename, vtu_job, vtu_ties, case_summary, options.num_threads);
+            }
+
+            end_time = std::chrono::high_resolution_clock::now();
+            case_summary.file_save_time_in_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    end_time - start_time).count();
+            // ]
+        }
 
         auto final_end_time = std::chrono::high_resolution_clock::now();
 
         delta_time = std::chrono::duration_cast<std::chrono::milliseconds>(final_end_time - initial_start_time).count();
-        summary.total_time_in_ms = delta_time;
+        for (long c = 0; c < num_cases; ++c) {
+            summaries[c].total_time_in_ms = delta_time;
 
-        if (options.save_report) {
-            writeStringToTxt(options.report_filename, summary.FullReport());
+            if (options.save_report) {
+                const std::string filename = num_cases > 1 ? loadCaseFilename(options.report_filename, c)
+                                                           : options.report_filename;
+                writeStringToTxt(filename, summaries[c].FullReport());
+            }
+
+            if (options.verbose)
+                std::cout << summaries[c].FullReport();
         }
 
-        if (options.verbose)
-            std::cout << summary.FullReport();
+        return summaries;
+    };
+
+    ResultMatrix Analysis::computeNodalForces(const Summary &summary) const {
+        if (!is_assembled) {
+            throw std::runtime_error("The nodal forces can only be computed with the assembled stiffness matrix of "
+                                     "the solved system.");
+        }
+        if (summary.nodal_displacements.rows() != static_cast<long>(job->nodes.size())) {
+            throw std::runtime_error(
+                    (boost::format("%d nodal displacements were given for %d nodes.")
+                     % summary.nodal_displacements.rows() % job->nodes.size()).str()
+            );
+        }
+
+        // scatter the displacements to the internal numbering. The Lagrange multipliers stay zero.
+        const unsigned int dofs_per_elem = DOF::NUM_DOFS;
+        Eigen::MatrixXd nodal_disp = Eigen::MatrixXd::Zero(size, 1);
+        for (size_t i = 0; i < job->nodes.size(); ++i) {
+            const size_t node = renumbering.node_index.empty() ? i : renumbering.node_index[i];
+            for (unsigned int j = 0; j < dofs_per_elem; ++j) {
+                nodal_disp(dofs_per_elem * node + j, 0) = summary.nodal_displacements(i, j);
+            }
+        }
+        return toNodalValues(multiplySystemMatrix(Kg, upper_only, nodal_disp), 0, job->nodes.size(), renumbering,
+                             options);
+    };
+
+    Summary solve(const Job &job,
+                  const std::vector<BC> &BCs,
+                  const std::vector<Force> &forces,
+                  const std::vector<Tie> &ties,
+                  const std::vector<Equation> &equations,
+                  const Options &options) {
+        Analysis analysis(job, BCs, ties, equations, options);
+        return analysis.solve(forces);
+    };
 
-        return summary;
+    std::vector<Summary> solve(const Job &job,
+                               const std::vector<BC> &BCs,
+                               const std::vector<std::vector<Force> > &load_cases,
+                               const std::vector<Tie> &ties,
+                               const std::vector<Equation> &equations,
+                               const Options &options) {
+        Analysis analysis(job, BCs, ties, equations, options);
+        return analysis.solve(load_cases);
     };
 
 } // namespace fea
@@ -24,10 +24,57 @@
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
 #include "threed_beam_fea.h"
+#include <random>
 #include <gtest/gtest.h>
 
 using namespace fea;
 
+namespace {
+    // Builds an n x n x n grid of slightly skewed beams with diagonal braces in the x-y plane.
+    Job createGridJob(unsigned int n) {
+        std::vector<double> normal_vec = {1.0, 1.0, 1.0};
+        Props props(10.0, 2.0, 3.0, 4.0, normal_vec);
+
+        std::vector<Node> nodes;
+        for (unsigned int k = 0; k < n; ++k) {
+            for (unsigned int j = 0; j < n; ++j) {
+                for (unsigned int i = 0; i < n; ++i) {
+                    nodes.push_back(Node(i + 0.1 * j, j + 0.05 * k, k + 0.01 * i));
+                }
+            }
+        }
+
+        std::vector<Elem> elems;
+        for (unsigned int k = 0; k < n; ++k) {
+            for (unsigned int j = 0; j < n; ++j) {
+                for (unsigned int i = 0; i < n; ++i) {
+                    const unsigned int nn = (k * n + j) * n + i;
+                    if (i + 1 < n) elems.push_back(Elem(nn, nn + 1, props));
+                    if (j + 1 < n) elems.push_back(Elem(nn, nn + n, props));
+                    if (k + 1 < n) elems.push_back(Elem(nn, nn + n * n, props));
+                    if (i + 1 < n && j + 1 < n) elems.push_back(Elem(nn, nn + n + 1, props));
+                }
+            }
+        }
+        return Job(nodes, elems);
+    }
+
+    // Checks that both matrices store the same entries with bitwise equal values.
+    void expectIdenticalValues(const SparseMat &expected, const SparseMat &actual) {
+        ASSERT_EQ(expected.rows(), actual.rows());
+        ASSERT_EQ(expected.cols(), actual.cols());
+        ASSERT_EQ(expected.nonZeros(), actual.nonZeros());
+        for (int j = 0; j < expected.outerSize(); ++j) {
+            SparseMat::InnerIterator it_actual(actual, j);
+            for (SparseMat::InnerIterator it_expected(expected, j); it_expected; ++it_expected, ++it_actual) {
+                ASSERT_TRUE(it_actual);
+                EXPECT_EQ(it_expected.row(), it_actual.row());
+                EXPECT_EQ(it_expected.value(), it_actual.value());
+            }
+        }
+    }
+}
+
 class beamFEATest : public testing::Test {
 protected:
     beamFEATest() : JOB_L_BRACKET(), BCS_L_BRACKET(0), FORCES_L_BRACKET(0),
@@ -134,6 +181,73 @@ TEST_F(beamFEATest, AssemblesElementalStiffness) {
     }
 }
 
+TEST_F(beamFEATest, ClosedFormKelemMatchesDenseProduct) {
+    Job job = createGridJob(4);
+
+    GlobalStiffAssembler dense_assembler;
+    for (unsigned int i = 0; i < job.elems.size(); ++i) {
+        assembleK3D.calcKelem(i, job);
+        dense_assembler.calcKelemDense(i, job);
+        LocalMatrix Kelem = assembleK3D.getKelem();
+        LocalMatrix expected = dense_assembler.getKelem();
+
+        const double tol = 1e-13 * expected.cwiseAbs().maxCoeff();
+        for (size_t j = 0; j < expected.size(); ++j) {
+            EXPECT_NEAR(expected(j), Kelem(j), tol);
+        }
+        // the closed form result is exactly symmetric
+        EXPECT_TRUE(Kelem == Kelem.transpose());
+    }
+}
+
+TEST_F(beamFEATest, BatchedKelemMatchesScalar) {
+    Job job = createGridJob(4);
+    const ElemSoA elems(job);
+
+    GlobalStiffAssembler batch_assembler;
+    for (unsigned int first = 0; first + ELEM_BATCH_SIZE <= job.elems.size(); first += ELEM_BATCH_SIZE) {
+        batch_assembler.calcKelemBatch(first, elems);
+        for (unsigned int l = 0; l < ELEM_BATCH_SIZE; ++l) {
+            assembleK3D.calcKelem(first + l, job);
+            EXPECT_TRUE(batch_assembler.getKelemBatch(l) == assembleK3D.getKelem());
+        }
+    }
+}
+
+// The closed form, the batched closed form and the dense triple product
+// agree over a grid whose element count is not a multiple of the batch
+// size. The timings of the kernels are measured by benchmarkKelem.
+TEST_F(beamFEATest, KelemKernelsAgreeOnGrid) {
+    Job job = createGridJob(12);
+
+    GlobalStiffAssembler dense_assembler;
+    double dense_sum = 0.0;
+    double closed_form_sum = 0.0;
+    for (unsigned int i = 0; i < job.elems.size(); ++i) {
+        dense_assembler.calcKelemDense(i, job);
+        dense_sum += dense_assembler.getKelem()(1, 5);
+        assembleK3D.calcKelem(i, job);
+        closed_form_sum += assembleK3D.getKelem()(1, 5);
+    }
+
+    const ElemSoA elems(job);
+    const size_t num_batched = job.elems.size() - job.elems.size() % ELEM_BATCH_SIZE;
+    double batch_sum = 0.0;
+    for (unsigned int first = 0; first < num_batched; first += ELEM_BATCH_SIZE) {
+        assembleK3D.calcKelemBatch(first, elems);
+        for (unsigned int l = 0; l < ELEM_BATCH_SIZE; ++l) {
+            batch_sum += assembleK3D.getKelemBatch(l)(1, 5);
+        }
+    }
+    for (size_t i = num_batched; i < job.elems.size(); ++i) {
+        assembleK3D.calcKelem(i, job);
+        batch_sum += assembleK3D.getKelem()(1, 5);
+    }
+
+    EXPECT_NEAR(dense_sum, closed_form_sum, 1e-9 * std::abs(dense_sum));
+    EXPECT_NEAR(dense_sum, batch_sum, 1e-9 * std::abs(dense_sum));
+}
+
 TEST_F(beamFEATest, AssemblesGlobalStiffness) {
 
     unsigned int dofs_per_elem = 6;
@@ -183,6 +297,874 @@ TEST_F(beamFEATest, AssemblesGlobalStiffness) {
     }
 }
 
+TEST_F(beamFEATest, ParallelAssemblyMatchesSerial) {
+    Job job = createGridJob(6);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 20, 1.0, 2.0)};
+
+    const size_t size = DOF::NUM_DOFS * job.nodes.size();
+    SparseMat Kg_serial(size, size);
+    assembleK3D(Kg_serial, job, ties);
+
+    Options opts;
+    opts.num_threads = 4;
+    GlobalStiffAssembler parallel_assembler(opts);
+    SparseMat Kg_parallel(size, size);
+    parallel_assembler(Kg_parallel, job, ties);
+
+    expectIdenticalValues(Kg_serial, Kg_parallel);
+}
+
+TEST_F(beamFEATest, PatternAssemblyMatchesTriplets) {
+    Job job = createGridJob(5);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 20, 1.0, 2.0)};
+
+    // add space for Lagrange multipliers to check the additional columns are left empty
+    const size_t size = DOF::NUM_DOFS * job.nodes.size() + 3;
+    SparseMat Kg_triplets(size, size);
+    assembleK3D(Kg_triplets, job, ties);
+
+    SparsityPattern pattern = computeSparsityPattern(job, ties);
+    SparseMat Kg_pattern(size, size);
+    assembleK3D(Kg_pattern, job, ties, pattern);
+
+    // both matrices may store explicit zeros in different places, so only compare the nonzero values
+    SparseMat Kg_pruned = Kg_pattern;
+    Kg_pruned.prune(0.0, 0.0);
+    Kg_triplets.prune(0.0, 0.0);
+    expectIdenticalValues(Kg_triplets, Kg_pruned);
+
+    // a second assembly on the same pattern only updates the values
+    const double *values = Kg_pattern.valuePtr();
+    job.props[0].EA *= 2.0;
+    assembleK3D(Kg_pattern, job, ties, pattern);
+    assembleK3D(Kg_triplets, job, ties);
+    EXPECT_EQ(values, Kg_pattern.valuePtr());
+
+    Kg_pruned = Kg_pattern;
+    Kg_pruned.prune(0.0, 0.0);
+    Kg_triplets.prune(0.0, 0.0);
+    expectIdenticalValues(Kg_triplets, Kg_pruned);
+}
+
+TEST_F(beamFEATest, PatternAssemblySolvesLBracket) {
+    std::vector<Tie> ties;
+    std::vector<Equation> equations;
+    Options opts;
+    Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties, equations, opts);
+
+    opts.use_sparsity_pattern = true;
+    Summary summary = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties, equations, opts);
+
+    // the pattern keeps explicit zeros, so the factorization may round differently
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-12);
+            EXPECT_NEAR(expected.nodal_forces(i, j), summary.nodal_forces(i, j), 1e-12);
+        }
+    }
+}
+
+TEST_F(beamFEATest, UpperAssemblyMatchesUpperTriangle) {
+    Job job = createGridJob(5);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(20, 10, 1.0, 2.0)};
+
+    const size_t size = DOF::NUM_DOFS * job.nodes.size();
+    SparseMat Kg(size, size);
+    assembleK3D(Kg, job, ties);
+    SparseMat expected = Kg.triangularView<Eigen::Upper>();
+    expected.prune(0.0, 0.0);
+
+    Options opts;
+    opts.linear_solver = SPARSE_LDLT;
+    GlobalStiffAssembler upper_assembler(opts);
+    SparseMat Kg_upper(size, size);
+    upper_assembler(Kg_upper, job, ties);
+    Kg_upper.prune(0.0, 0.0);
+    expectIdenticalValues(expected, Kg_upper);
+
+    SparsityPattern pattern = computeSparsityPattern(job, ties, true);
+    SparseMat Kg_pattern(size, size);
+    upper_assembler(Kg_pattern, job, ties, pattern);
+    for (int j = 0; j < Kg_pattern.outerSize(); ++j) {
+        for (SparseMat::InnerIterator it(Kg_pattern, j); it; ++it) {
+            EXPECT_LE(it.row(), it.col());
+        }
+    }
+    Kg_pattern.prune(0.0, 0.0);
+    expectIdenticalValues(expected, Kg_pattern);
+}
+
+TEST_F(beamFEATest, PatternAssemblyIncludesConstraints) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+    std::vector<BC> bcs = {BC(0, DOF::DISPLACEMENT_X, 0.0), BC(0, DOF::ROTATION_Z, 0.0), BC(12, DOF::DISPLACEMENT_Z, 0.1)};
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(6, DOF::DISPLACEMENT_Y, 1.0));
+    eqn.terms.push_back(Equation::Term(7, DOF::DISPLACEMENT_Y, -1.0));
+    std::vector<Equation> equations = {eqn};
+
+    const size_t size = DOF::NUM_DOFS * job.nodes.size() + bcs.size() + equations.size();
+    for (int linear_solver = SPARSE_LU; linear_solver <= SPARSE_LDLT; ++linear_solver) {
+        Options opts;
+        opts.linear_solver = static_cast<LinearSolver>(linear_solver);
+        const bool upper_only = storesUpperTriangle(opts);
+        GlobalStiffAssembler assembler(opts);
+
+        SparseMat expected(size, size), f_expected(size, 1);
+        assembler(expected, job, ties);
+        loadBCs(expected, f_expected, bcs, job.nodes.size(), upper_only);
+        loadEquations(expected, equations, job.nodes.size(), bcs.size(), upper_only);
+        expected.makeCompressed();
+        expected.prune(0.0, 0.0);
+
+        SparsityPattern pattern = computeSparsityPattern(job, ties, bcs, equations, upper_only);
+        SparseMat Kg(size, size), f(size, 1);
+        assembler(Kg, job, ties, pattern);
+        loadBCs(Kg, f, bcs, pattern);
+        loadEquations(Kg, equations, pattern);
+        ASSERT_EQ(static_cast<long>(pattern.inner_index.size()), Kg.nonZeros());
+
+        SparseMat Kg_pruned = Kg;
+        Kg_pruned.prune(0.0, 0.0);
+        expectIdenticalValues(expected, Kg_pruned);
+        expectIdenticalValues(f_expected, f);
+    }
+}
+
+TEST_F(beamFEATest, ParallelPatternAssemblyMatchesSerial) {
+    Job job = createGridJob(6);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 20, 1.0, 2.0)};
+    SparsityPattern pattern = computeSparsityPattern(job, ties);
+
+    const size_t size = DOF::NUM_DOFS * job.nodes.size();
+    SparseMat Kg_serial(size, size);
+    assembleK3D(Kg_serial, job, ties, pattern);
+
+    Options opts;
+    opts.num_threads = 4;
+    GlobalStiffAssembler parallel_assembler(opts);
+    SparseMat Kg_parallel(size, size);
+    parallel_assembler(Kg_parallel, job, ties, pattern);
+
+    expectIdenticalValues(Kg_serial, Kg_parallel);
+}
+
+TEST_F(beamFEATest, PatternAnalysisReassemblesInPlace) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties;
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+    }
+    std::vector<Equation> equations;
+    std::vector<Force> forces = {Force(15, DOF::DISPLACEMENT_X, 1.0)};
+
+    Options opts;
+    opts.use_sparsity_pattern = true;
+    Analysis analysis(job, bcs, ties, equations, opts);
+    analysis.solve(forces);
+    const double *values = analysis.getSystemMatrix().valuePtr();
+    const long num_nonzeros = analysis.getSystemMatrix().nonZeros();
+
+    Job stiff_job = job;
+    stiff_job.props[0].EA *= 2.0;
+    analysis.setProps(stiff_job.props);
+    Summary summary = analysis.solve(forces);
+    EXPECT_EQ(values, analysis.getSystemMatrix().valuePtr());
+    EXPECT_EQ(num_nonzeros, analysis.getSystemMatrix().nonZeros());
+
+    Summary expected = solve(stiff_job, bcs, forces, ties, equations, opts);
+    for (size_t i = 0; i < job.nodes.size(); ++i) {
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-12);
+        }
+    }
+}
+
+TEST_F(beamFEATest, LDLTSolvesLBracket) {
+    std::vector<Tie> ties;
+    std::vector<Equation> equations;
+    Options opts;
+    Summary expected = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties, equations, opts);
+
+    opts.linear_solver = SPARSE_LDLT;
+    Summary summary = solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties, equations, opts);
+
+    EXPECT_LT(summary.num_stiffness_nonzeros, expected.num_stiffness_nonzeros);
+    EXPECT_NE(std::string::npos, summary.linear_solver.find("LDLT"));
+
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-12);
+            EXPECT_NEAR(expected.nodal_forces(i, j), summary.nodal_forces(i, j), 1e-12);
+        }
+    }
+}
+
+TEST_F(beamFEATest, LDLTMatchesLUWithTiesAndEquations) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(3, j, 0.0));
+    }
+    bcs.push_back(BC(12, DOF::DISPLACEMENT_Z, 0.1));
+
+    std::vector<Force> forces = {Force(15, DOF::DISPLACEMENT_X, 1.0), Force(9, DOF::ROTATION_Y, -2.0)};
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(6, DOF::DISPLACEMENT_Y, 1.0));
+    eqn.terms.push_back(Equation::Term(7, DOF::DISPLACEMENT_Y, -1.0));
+    std::vector<Equation> equations = {eqn};
+
+    Options opts;
+    Summary expected = solve(job, bcs, forces, ties, equations, opts);
+
+    opts.linear_solver = SPARSE_LDLT;
+    Summary summary = solve(job, bcs, forces, ties, equations, opts);
+
+    opts.use_sparsity_pattern = true;
+    Summary pattern_summary = solve(job, bcs, forces, ties, equations, opts);
+
+    for (size_t i = 0; i < job.nodes.size(); ++i) {
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+            EXPECT_NEAR(expected.nodal_forces(i, j), summary.nodal_forces(i, j), 1e-9);
+            EXPECT_NEAR(expected.nodal_displacements(i, j), pattern_summary.nodal_displacements(i, j), 1e-10);
+        }
+    }
+    for (size_t i = 0; i < ties.size(); ++i) {
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_NEAR(expected.tie_forces(i, j), summary.tie_forces(i, j), 1e-10);
+        }
+    }
+}
+
+TEST_F(beamFEATest, EliminatedBCsMatchLagrangeMultipliers) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(3, j, 0.0));
+    }
+    bcs.push_back(BC(12, DOF::DISPLACEMENT_Z, 0.1));
+
+    std::vector<Force> forces = {Force(15, DOF::DISPLACEMENT_X, 1.0), Force(9, DOF::ROTATION_Y, -2.0)};
+    std::vector<Equation> equations;
+
+    Options opts;
+    Summary expected = solve(job, bcs, forces, ties, equations, opts);
+
+    for (int linear_solver = SPARSE_LU; linear_solver <= SPARSE_LDLT; ++linear_solver) {
+        opts.linear_solver = static_cast<LinearSolver>(linear_solver);
+        opts.eliminate_bcs = true;
+        Summary summary = solve(job, bcs, forces, ties, equations, opts);
+
+        EXPECT_LT(summary.num_stiffness_nonzeros, expected.num_stiffness_nonzeros);
+
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+                EXPECT_NEAR(expected.nodal_forces(i, j), summary.nodal_forces(i, j), 1e-9);
+            }
+        }
+
+        // none of the constrained degrees of freedom are loaded, so the reactions equal the nodal forces and the
+        // Lagrange multipliers
+        ASSERT_EQ(bcs.size(), summary.reaction_forces.size());
+        ASSERT_EQ(bcs.size(), expected.reaction_forces.size());
+        for (size_t i = 0; i < bcs.size(); ++i) {
+            EXPECT_NEAR(summary.nodal_forces(bcs[i].node, bcs[i].dof), summary.reaction_forces[i], 1e-9);
+            EXPECT_NEAR(expected.reaction_forces[i], summary.reaction_forces[i], 1e-9);
+        }
+    }
+}
+
+TEST_F(beamFEATest, EliminatedBCsWithEquationsCantileverBeam) {
+    std::vector<BC> bcs = {BC(0, 0, 0.1),
+                           BC(0, 1, 0.0),
+                           BC(0, 2, 0.0),
+                           BC(0, 3, 0.0),
+                           BC(0, 4, 0.0),
+                           BC(0, 5, 0.0)};
+
+    std::vector<Tie> ties;
+    std::vector<Force> forces;
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(0, 0, 1));
+    eqn.terms.push_back(Equation::Term(1, 0, 1));
+    std::vector<Equation> equations = {eqn};
+
+    Options opts;
+    opts.eliminate_bcs = true;
+
+    std::vector<std::vector<double> > expected = {{0.1,  0., 0., 0., 0., 0.},
+                                                  {-0.1, 0., 0., 0., 0., 0.}};
+
+    for (int linear_solver = SPARSE_LU; linear_solver <= SPARSE_LDLT; ++linear_solver) {
+        opts.linear_solver = static_cast<LinearSolver>(linear_solver);
+        Summary summary = solve(JOB_CANTILEVER, bcs, forces, ties, equations, opts);
+
+        for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+            for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j)
+                EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1e-14);
+        }
+    }
+
+    // the nodal force of each constrained degree of freedom is the sum of its reaction and its equation force
+    for (int eliminate_bcs = 0; eliminate_bcs < 2; ++eliminate_bcs) {
+        opts.linear_solver = SPARSE_LU;
+        opts.eliminate_bcs = eliminate_bcs == 1;
+        Summary summary = solve(JOB_CANTILEVER, bcs, forces, ties, equations, opts);
+
+        ASSERT_EQ(1u, summary.equation_forces.size());
+        ASSERT_EQ(bcs.size(), summary.reaction_forces.size());
+        EXPECT_LT(1e-3, std::abs(summary.equation_forces[0]));
+        EXPECT_NEAR(summary.nodal_forces(1, 0), summary.equation_forces[0], 1e-9);
+        EXPECT_NEAR(summary.nodal_forces(0, 0), summary.reaction_forces[0] + summary.equation_forces[0], 1e-9);
+        for (size_t i = 1; i < bcs.size(); ++i) {
+            EXPECT_NEAR(summary.nodal_forces(0, bcs[i].dof), summary.reaction_forces[i], 1e-9);
+        }
+    }
+}
+
+TEST_F(beamFEATest, EliminatedBCsRejectDuplicates) {
+    std::vector<BC> bcs = {BC(0, 0, 0.0), BC(0, 0, 0.1)};
+    EXPECT_THROW(computeReducedIndices(bcs, 12), std::runtime_error);
+}
+
+TEST_F(beamFEATest, BlockJacobiInvertsBlockDiagonal) {
+    // 2 nodes followed by a Lagrange multiplier with a zero diagonal
+    std::vector<Eigen::Triplet<double> > triplets;
+    for (unsigned int b = 0; b < 2; ++b) {
+        for (unsigned int i = 0; i < DOF::NUM_DOFS; ++i) {
+            for (unsigned int j = i; j < DOF::NUM_DOFS; ++j) {
+                const double value = i == j ? 10.0 + i + b : 1.0 / (1.0 + i + j);
+                triplets.push_back(Eigen::Triplet<double>(6 * b + i, 6 * b + j, value));
+            }
+        }
+    }
+    triplets.push_back(Eigen::Triplet<double>(0, 12, 1.0));
+    SparseMat mat(13, 13);
+    mat.setFromTriplets(triplets.begin(), triplets.end());
+
+    NodalBlockJacobiPreconditioner precond;
+    precond.setBlockStarts({0, 6, 12});
+    precond.compute(mat);
+
+    Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(13, 1.0, 13.0);
+    Eigen::VectorXd x = precond.solve(b);
+
+    // the multiplier block does not couple to the nodes and is not positive definite, so it is left unchanged
+    SparseMat full = mat.selfadjointView<Eigen::Upper>();
+    Eigen::MatrixXd nodes = Eigen::MatrixXd(full).topLeftCorner(12, 12);
+    EXPECT_TRUE((nodes * x.head(12)).isApprox(b.head(12), 1e-12));
+    EXPECT_DOUBLE_EQ(b(12), x(12));
+}
+
+TEST_F(beamFEATest, IterativeSolversMatchDirect) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(3, j, 0.0));
+    }
+    bcs.push_back(BC(12, DOF::DISPLACEMENT_Z, 0.1));
+
+    std::vector<Force> forces = {Force(15, DOF::DISPLACEMENT_X, 1.0), Force(9, DOF::ROTATION_Y, -2.0)};
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(6, DOF::DISPLACEMENT_Y, 1.0));
+    eqn.terms.push_back(Equation::Term(7, DOF::DISPLACEMENT_Y, -1.0));
+    std::vector<Equation> no_equations;
+    std::vector<Equation> equations = {eqn};
+
+    struct Case {
+        LinearSolver linear_solver;
+        Preconditioner preconditioner;
+        bool eliminate_bcs;
+        bool use_equations;
+    };
+    std::vector<Case> cases = {{CONJUGATE_GRADIENT, BLOCK_JACOBI,        true,  false},
+                               {CONJUGATE_GRADIENT, INCOMPLETE_CHOLESKY, true,  false},
+                               {MINRES,             BLOCK_JACOBI,        false, true},
+                               {MINRES,             BLOCK_JACOBI,        true,  true},
+                               {GMRES,              BLOCK_JACOBI,        true,  true}};
+
+    for (size_t c = 0; c < cases.size(); ++c) {
+        const std::vector<Equation> &eqns = cases[c].use_equations ? equations : no_equations;
+        Options opts;
+        Summary expected = solve(job, bcs, forces, ties, eqns, opts);
+
+        opts.linear_solver = cases[c].linear_solver;
+        opts.preconditioner = cases[c].preconditioner;
+        opts.eliminate_bcs = cases[c].eliminate_bcs;
+        opts.tolerance = 1e-13;
+        Summary summary = solve(job, bcs, forces, ties, eqns, opts);
+
+        EXPECT_GT(summary.iterations, 0u) << summary.linear_solver;
+        EXPECT_LE(summary.residual, 1e-13) << summary.linear_solver;
+
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-8)
+                                    << summary.linear_solver;
+            }
+        }
+    }
+}
+
+TEST_F(beamFEATest, ConjugateGradientRejectsLagrangeMultipliers) {
+    std::vector<Tie> ties;
+    std::vector<Equation> equations;
+    Options opts;
+    opts.linear_solver = CONJUGATE_GRADIENT;
+    EXPECT_THROW(solve(JOB_L_BRACKET, BCS_L_BRACKET, FORCES_L_BRACKET, ties, equations, opts), std::runtime_error);
+}
+
+TEST_F(beamFEATest, LoadCasesMatchSeparateSolves) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(3, j, 0.0));
+    }
+    bcs.push_back(BC(12, DOF::DISPLACEMENT_Z, 0.1));
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(6, DOF::DISPLACEMENT_Y, 1.0));
+    eqn.terms.push_back(Equation::Term(7, DOF::DISPLACEMENT_Y, -1.0));
+    std::vector<Equation> equations = {eqn};
+
+    std::vector<std::vector<Force> > load_cases = {
+            {Force(15, DOF::DISPLACEMENT_X, 1.0), Force(9, DOF::ROTATION_Y, -2.0)},
+            {},
+            {Force(5, DOF::DISPLACEMENT_Z, -3.0)}};
+
+    struct Case {
+        LinearSolver linear_solver;
+        bool eliminate_bcs;
+    };
+    std::vector<Case> cases = {{SPARSE_LU,   false},
+                               {SPARSE_LDLT, false},
+                               {SPARSE_LU,   true},
+                               {MINRES,      true}};
+
+    for (size_t c = 0; c < cases.size(); ++c) {
+        Options opts;
+        opts.linear_solver = cases[c].linear_solver;
+        opts.eliminate_bcs = cases[c].eliminate_bcs;
+        opts.tolerance = 1e-13;
+        std::vector<Summary> summaries = solve(job, bcs, load_cases, ties, equations, opts);
+        ASSERT_EQ(load_cases.size(), summaries.size());
+
+        for (size_t k = 0; k < load_cases.size(); ++k) {
+            Summary expected = solve(job, bcs, load_cases[k], ties, equations, opts);
+            EXPECT_EQ(load_cases[k].size(), summaries[k].num_forces);
+
+            for (size_t i = 0; i < job.nodes.size(); ++i) {
+                for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                    EXPECT_NEAR(expected.nodal_displacements(i, j), summaries[k].nodal_displacements(i, j), 1e-10)
+                                        << summaries[k].linear_solver;
+                    EXPECT_NEAR(expected.nodal_forces(i, j), summaries[k].nodal_forces(i, j), 1e-8)
+                                        << summaries[k].linear_solver;
+                }
+            }
+            for (size_t i = 0; i < ties.size(); ++i) {
+                for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                    EXPECT_NEAR(expected.tie_forces(i, j), summaries[k].tie_forces(i, j), 1e-8)
+                                        << summaries[k].linear_solver;
+                }
+            }
+            ASSERT_EQ(expected.reaction_forces.size(), summaries[k].reaction_forces.size());
+            for (size_t i = 0; i < expected.reaction_forces.size(); ++i) {
+                EXPECT_NEAR(expected.reaction_forces[i], summaries[k].reaction_forces[i], 1e-8)
+                                    << summaries[k].linear_solver;
+            }
+        }
+    }
+}
+
+TEST_F(beamFEATest, AnalysisReusesPhasesAcrossSolves) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(3, j, 0.0));
+    }
+    bcs.push_back(BC(12, DOF::DISPLACEMENT_Z, 0.1));
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(6, DOF::DISPLACEMENT_Y, 1.0));
+    eqn.terms.push_back(Equation::Term(7, DOF::DISPLACEMENT_Y, -1.0));
+    std::vector<Equation> equations = {eqn};
+
+    std::vector<Force> forces_a = {Force(15, DOF::DISPLACEMENT_X, 1.0), Force(9, DOF::ROTATION_Y, -2.0)};
+    std::vector<Force> forces_b = {Force(5, DOF::DISPLACEMENT_Z, -3.0)};
+
+    // stiffen every other element
+    Job stiff_job = job;
+    for (size_t i = 0; i < stiff_job.props.size(); i += 2) {
+        stiff_job.props[i].EA *= 2.0;
+        stiff_job.props[i].EIz *= 3.0;
+        stiff_job.props[i].GJ *= 0.5;
+    }
+
+    std::vector<LinearSolver> solvers = {SPARSE_LU, SPARSE_LDLT, MINRES};
+    for (size_t c = 0; c < solvers.size(); ++c) {
+        Options opts;
+        opts.linear_solver = solvers[c];
+        opts.eliminate_bcs = solvers[c] == MINRES;
+        opts.tolerance = 1e-13;
+
+        Analysis analysis(job, bcs, ties, equations, opts);
+        analysis.assemble();
+        analysis.analyzePattern();
+        analysis.factorize();
+
+        std::vector<Summary> actual = {analysis.solve(forces_a), analysis.solve(forces_b)};
+        analysis.setProps(stiff_job.props);
+        actual.push_back(analysis.solve(forces_a));
+
+        std::vector<Summary> expected = {solve(job, bcs, forces_a, ties, equations, opts),
+                                         solve(job, bcs, forces_b, ties, equations, opts),
+                                         solve(stiff_job, bcs, forces_a, ties, equations, opts)};
+
+        for (size_t k = 0; k < expected.size(); ++k) {
+            for (size_t i = 0; i < job.nodes.size(); ++i) {
+                for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                    EXPECT_NEAR(expected[k].nodal_displacements(i, j), actual[k].nodal_displacements(i, j), 1e-10)
+                                        << actual[k].linear_solver;
+                    EXPECT_NEAR(expected[k].nodal_forces(i, j), actual[k].nodal_forces(i, j), 1e-8)
+                                        << actual[k].linear_solver;
+                }
+            }
+        }
+
+        EXPECT_THROW(analysis.setProps(std::vector<Props>(1)), std::runtime_error);
+    }
+}
+
+TEST_F(beamFEATest, RenumberedNodesMatchInputOrder) {
+    Job job = createGridJob(5);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(4, j, 0.0));
+    }
+    bcs.push_back(BC(12, DOF::DISPLACEMENT_Z, 0.1));
+
+    Equation eqn;
+    eqn.terms.push_back(Equation::Term(6, DOF::DISPLACEMENT_Y, 1.0));
+    eqn.terms.push_back(Equation::Term(7, DOF::DISPLACEMENT_Y, -1.0));
+    std::vector<Equation> equations = {eqn};
+
+    std::vector<Force> forces = {Force(124, DOF::DISPLACEMENT_X, 1.0), Force(9, DOF::ROTATION_Y, -2.0)};
+
+    // scatter the node numbers like a mesh generator would
+    Renumbering shuffle;
+    for (unsigned int i = 0; i < job.nodes.size(); ++i) {
+        shuffle.node_index.push_back(i);
+    }
+    std::mt19937 rng(42);
+    std::shuffle(shuffle.node_index.begin(), shuffle.node_index.end(), rng);
+    for (unsigned int i = 0; i < job.elems.size(); ++i) {
+        shuffle.elem_order.push_back(i);
+    }
+    applyRenumbering(shuffle, job, bcs, ties, equations);
+    applyRenumbering(shuffle, forces);
+
+    // the reverse Cuthill-McKee ordering reduces the bandwidth
+    Renumbering rcm = computeRenumbering(job, ties, REVERSE_CUTHILL_MCKEE);
+    int bandwidth = 0;
+    int rcm_bandwidth = 0;
+    for (size_t i = 0; i < job.elems.size(); ++i) {
+        bandwidth = std::max(bandwidth, std::abs(job.elems[i](0) - job.elems[i](1)));
+        rcm_bandwidth = std::max(rcm_bandwidth, std::abs(static_cast<int>(rcm.node_index[job.elems[i](0)]) -
+                                                         static_cast<int>(rcm.node_index[job.elems[i](1)])));
+    }
+    EXPECT_LT(2 * rcm_bandwidth, bandwidth);
+
+    struct Case {
+        NodeOrdering node_ordering;
+        LinearSolver linear_solver;
+        bool eliminate_bcs;
+    };
+    std::vector<Case> cases = {{REVERSE_CUTHILL_MCKEE, SPARSE_LU,   false},
+                               {REVERSE_CUTHILL_MCKEE, SPARSE_LDLT, true},
+                               {HILBERT_CURVE,         SPARSE_LU,   true},
+                               {HILBERT_CURVE,         SPARSE_LDLT, false}};
+
+    for (size_t c = 0; c < cases.size(); ++c) {
+        Options opts;
+        opts.linear_solver = cases[c].linear_solver;
+        opts.eliminate_bcs = cases[c].eliminate_bcs;
+        Summary expected = solve(job, bcs, forces, ties, equations, opts);
+
+        opts.node_ordering = cases[c].node_ordering;
+        Summary summary = solve(job, bcs, forces, ties, equations, opts);
+
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+                EXPECT_NEAR(expected.nodal_forces(i, j), summary.nodal_forces(i, j), 1e-8);
+            }
+        }
+        for (size_t i = 0; i < ties.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_NEAR(expected.tie_forces(i, j), summary.tie_forces(i, j), 1e-8);
+            }
+        }
+        ASSERT_EQ(expected.reaction_forces.size(), summary.reaction_forces.size());
+        for (size_t i = 0; i < expected.reaction_forces.size(); ++i) {
+            EXPECT_NEAR(expected.reaction_forces[i], summary.reaction_forces[i], 1e-8);
+        }
+
+        // properties are given in the input order of the elements
+        std::vector<Props> props = job.props;
+        props[3].EA *= 4.0;
+        Job stiff_job = job;
+        stiff_job.props = props;
+        opts.node_ordering = ORIGINAL_ORDER;
+        expected = solve(stiff_job, bcs, forces, ties, equations, opts);
+
+        opts.node_ordering = cases[c].node_ordering;
+        Analysis analysis(job, bcs, ties, equations, opts);
+        analysis.setProps(props);
+        summary = analysis.solve(forces);
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+            }
+        }
+    }
+}
+
+TEST_F(beamFEATest, SkipsUnrequestedResults) {
+    Job job = createGridJob(4);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0), Tie(10, 5, 1.0, 2.0)};
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(3, j, 0.0));
+    }
+    std::vector<Equation> equations;
+    std::vector<Force> forces = {Force(15, DOF::DISPLACEMENT_Z, 1.0), Force(9, DOF::ROTATION_Y, -2.0)};
+
+    for (int eliminate_bcs = 0; eliminate_bcs < 2; ++eliminate_bcs) {
+        Options opts;
+        opts.eliminate_bcs = eliminate_bcs == 1;
+        opts.linear_solver = SPARSE_LDLT;
+        opts.node_ordering = REVERSE_CUTHILL_MCKEE;
+        Summary expected = solve(job, bcs, forces, ties, equations, opts);
+
+        opts.compute_nodal_forces = false;
+        opts.compute_reaction_forces = false;
+        opts.compute_tie_forces = false;
+        Analysis analysis(job, bcs, ties, equations, opts);
+        Summary summary = analysis.solve(forces);
+        EXPECT_EQ(0, summary.nodal_forces.rows());
+        EXPECT_EQ(0, summary.tie_forces.rows());
+        EXPECT_TRUE(summary.reaction_forces.empty());
+        EXPECT_EQ(0u, summary.nodal_force_statistics.num_rows);
+        EXPECT_EQ(std::string::npos, summary.FullReport().find("Nodal Forces"));
+
+        // the skipped results can be recovered from the displacements
+        const ResultMatrix nodal_forces = analysis.computeNodalForces(summary);
+        ASSERT_EQ(expected.nodal_forces.rows(), nodal_forces.rows());
+        for (long i = 0; i < nodal_forces.rows(); ++i) {
+            for (long j = 0; j < nodal_forces.cols(); ++j) {
+                EXPECT_NEAR(expected.nodal_forces(i, j), nodal_forces(i, j), 1e-8);
+                EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+            }
+        }
+        const ResultMatrix tie_forces = computeTieForces(ties, summary.nodal_displacements);
+        ASSERT_EQ(expected.tie_forces.rows(), tie_forces.rows());
+        for (long i = 0; i < tie_forces.rows(); ++i) {
+            for (long j = 0; j < tie_forces.cols(); ++j) {
+                EXPECT_NEAR(expected.tie_forces(i, j), tie_forces(i, j), 1e-8);
+            }
+        }
+
+        analysis.setProps(job.props);
+        EXPECT_THROW(analysis.computeNodalForces(summary), std::runtime_error);
+    }
+}
+
+TEST_F(beamFEATest, ElemForcesMatchCantileverStatics) {
+    // cantilever along x made of 10 elements, loaded at its tip in y
+    const unsigned int num_elems = 10;
+    const double tip_force = 2.0;
+    std::vector<double> normal_vec = {0.0, 1.0, 0.0};
+    Job job;
+    for (unsigned int i = 0; i <= num_elems; ++i) {
+        job.nodes.push_back(Node(i, 0.0, 0.0));
+    }
+    for (unsigned int i = 0; i < num_elems; ++i) {
+        job.elems.push_back(Eigen::Vector2i(i, i + 1));
+        job.props.push_back(Props(100.0, 50.0, 60.0, 70.0, normal_vec));
+    }
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+    }
+    std::vector<Force> forces = {Force(num_elems, DOF::DISPLACEMENT_Y, tip_force)};
+    std::vector<Tie> ties;
+    std::vector<Equation> equations;
+
+    Options opts;
+    opts.compute_elem_forces = true;
+    Summary summary = solve(job, bcs, forces, ties, equations, opts);
+    ASSERT_EQ(num_elems, summary.elem_forces.rows());
+    for (unsigned int i = 0; i < num_elems; ++i) {
+        // the shear is constant and the moment grows linearly towards the clamped end
+        EXPECT_NEAR(-tip_force, summary.elem_forces(i, 1), 1e-9);
+        EXPECT_NEAR(tip_force, summary.elem_forces(i, 7), 1e-9);
+        EXPECT_NEAR(-tip_force * (num_elems - i), summary.elem_forces(i, 5), 1e-9);
+        EXPECT_NEAR(tip_force * (num_elems - i - 1), summary.elem_forces(i, 11), 1e-9);
+        EXPECT_NEAR(0.0, summary.elem_forces(i, 0), 1e-9);
+        EXPECT_NEAR(0.0, summary.elem_forces(i, 2), 1e-9);
+    }
+
+    const std::vector<SectionModuli> sections = {SectionModuli(0.5, 0.25, 0.1)};
+    const ElemStressMatrix stresses = computeElemStresses(summary.elem_forces, sections);
+    ASSERT_EQ(num_elems, stresses.rows());
+    EXPECT_NEAR(tip_force * num_elems / 0.1, stresses(0, 2), 1e-7);
+    EXPECT_NEAR(tip_force * num_elems / 0.1, stresses(0, 3), 1e-7);
+    EXPECT_NEAR(0.0, stresses(num_elems - 1, 6), 1e-7);
+    EXPECT_THROW(computeElemStresses(summary.elem_forces, std::vector<SectionModuli>(2)), std::runtime_error);
+
+    // a single inclined element in tension
+    Job bar;
+    bar.nodes = {Node(0.0, 0.0, 0.0), Node(1.0, 2.0, 2.0)};
+    bar.elems = {Eigen::Vector2i(0, 1)};
+    bar.props = {Props(100.0, 50.0, 60.0, 70.0, {2.0, -1.0, 0.0})};
+    forces = {Force(1, DOF::DISPLACEMENT_X, 1.0), Force(1, DOF::DISPLACEMENT_Y, 2.0),
+              Force(1, DOF::DISPLACEMENT_Z, 2.0)};
+    summary = solve(bar, bcs, forces, ties, equations, opts);
+    EXPECT_NEAR(-3.0, summary.elem_forces(0, 0), 1e-9);
+    EXPECT_NEAR(3.0, summary.elem_forces(0, 6), 1e-9);
+    for (unsigned int j = 1; j < DOF::NUM_DOFS; ++j) {
+        EXPECT_NEAR(0.0, summary.elem_forces(0, j), 1e-9);
+        EXPECT_NEAR(0.0, summary.elem_forces(0, 6 + j), 1e-9);
+    }
+    const ElemStressMatrix bar_stresses = computeElemStresses(summary.elem_forces, sections);
+    EXPECT_NEAR(6.0, bar_stresses(0, 0), 1e-9);
+    EXPECT_NEAR(6.0, bar_stresses(0, 4), 1e-9);
+}
+
+TEST_F(beamFEATest, ElemForcesFollowInputOrder) {
+    Job job = createGridJob(6);
+    std::vector<Tie> ties = {Tie(0, 1, 5.0, 7.0)};
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+        bcs.push_back(BC(5, j, 0.0));
+    }
+    std::vector<Equation> equations;
+    std::vector<Force> forces = {Force(35, DOF::DISPLACEMENT_Z, 1.0), Force(20, DOF::ROTATION_X, -2.0)};
+
+    Options opts;
+    opts.compute_elem_forces = true;
+    Summary expected = solve(job, bcs, forces, ties, equations, opts);
+
+    opts.node_ordering = REVERSE_CUTHILL_MCKEE;
+    opts.compute_elem_forces = false;
+    opts.save_elem_forces = true;
+    opts.elem_forces_filename = "ElemForcesFollowInputOrder.csv";
+    Summary summary = solve(job, bcs, forces, ties, equations, opts);
+    ASSERT_EQ(static_cast<long>(job.elems.size()), summary.elem_forces.rows());
+    for (long i = 0; i < summary.elem_forces.rows(); ++i) {
+        for (long j = 0; j < summary.elem_forces.cols(); ++j) {
+            EXPECT_NEAR(expected.elem_forces(i, j), summary.elem_forces(i, j), 1e-9);
+        }
+        // each element is in equilibrium
+        for (long j = 0; j < 3; ++j) {
+            EXPECT_NEAR(0.0, summary.elem_forces(i, j) + summary.elem_forces(i, 6 + j), 1e-9);
+        }
+    }
+
+    CSVParser csv;
+    std::vector<std::vector<double> > saved;
+    csv.parseToVector(opts.elem_forces_filename, saved);
+    ASSERT_EQ(job.elems.size(), saved.size());
+    ASSERT_EQ(12u, saved[3].size());
+    EXPECT_NEAR(summary.elem_forces(3, 11), saved[3][11], 1e-12);
+    std::remove(opts.elem_forces_filename.c_str());
+}
+
+TEST_F(beamFEATest, PropertyTableMatchesPerElementProps) {
+    Job job = createGridJob(4);
+
+    // three distinct sections assigned round robin
+    std::vector<double> normal_vec = {1.0, 1.0, 1.0};
+    std::vector<Props> table = {Props(10.0, 2.0, 3.0, 4.0, normal_vec),
+                                Props(20.0, 1.0, 5.0, 2.0, normal_vec),
+                                Props(5.0, 4.0, 1.0, 8.0, normal_vec)};
+    std::vector<unsigned int> prop_ids(job.elems.size());
+    for (size_t i = 0; i < prop_ids.size(); ++i) {
+        prop_ids[i] = i % table.size();
+        job.props[i] = table[prop_ids[i]];
+    }
+    Job table_job(job.nodes, job.elems, table, prop_ids);
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+    }
+    std::vector<Force> forces = {Force(63, DOF::DISPLACEMENT_X, 1.0), Force(21, DOF::ROTATION_Z, -2.0)};
+    std::vector<Tie> ties;
+    std::vector<Equation> equations;
+
+    const NodeOrdering orderings[] = {ORIGINAL_ORDER, REVERSE_CUTHILL_MCKEE};
+    for (size_t c = 0; c < 2; ++c) {
+        Options opts;
+        opts.node_ordering = orderings[c];
+        Summary expected = solve(job, bcs, forces, ties, equations, opts);
+        Summary summary = solve(table_job, bcs, forces, ties, equations, opts);
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_DOUBLE_EQ(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j));
+            }
+        }
+
+        // per element properties replace the table
+        std::vector<Props> props = job.props;
+        props[5].EA *= 4.0;
+        Job stiff_job = job;
+        stiff_job.props = props;
+        expected = solve(stiff_job, bcs, forces, ties, equations, opts);
+
+        Analysis analysis(table_job, bcs, ties, equations, opts);
+        analysis.setProps(props);
+        summary = analysis.solve(forces);
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_NEAR(expected.nodal_displacements(i, j), summary.nodal_displacements(i, j), 1e-10);
+            }
+        }
+    }
+
+    table_job.prop_ids[7] = table.size();
+    EXPECT_THROW(solve(table_job, bcs, forces, ties, equations, Options()), std::runtime_error);
+    table_job.prop_ids.pop_back();
+    EXPECT_THROW(solve(table_job, bcs, forces, ties, equations, Options()), std::runtime_error);
+}
+
 TEST_F(beamFEATest, CorrectNodalDisplacementsNoTies) {
     std::vector<Tie> ties;
     std::vector<Equation> equations;
@@ -197,9 +1179,9 @@ TEST_F(beamFEATest, CorrectNodalDisplacementsNoTies) {
                                                   {0., 0.5,                 0., -0.4375, 0., 0.125},
                                                   {0., 0.625,               0., -0.625,  0., 1.25, -0.625}};
 
-    for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-        for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j) {
-            EXPECT_NEAR(expected[i][j], summary.nodal_displacements[i][j], 1.e-10);
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+            EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1.e-10);
         }
     }
 }
@@ -249,9 +1231,9 @@ TEST_F(beamFEATest, CorrectNodalDisplacementsWithStiffTies) {
                                                   {0., 0.5,                 0., -0.4375, 0., 0.125},
                                                   {0., 0.625,               0., -0.625,  0., 1.25, -0.625}};
 
-    for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-        for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j) {
-            EXPECT_NEAR(expected[i][j], summary.nodal_displacements[i][j], 1.e-7);
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+            EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1.e-7);
         }
 
 
@@ -279,9 +1261,9 @@ TEST_F(beamFEATest, CorrectDisplacementWithEquationsCantileverBeam) {
     std::vector<std::vector<double> > expected = {{0.1, 0.,0., 0.,  0.,  0.},
                                                   {-0.1, 0., 0., 0., 0., 0.}};
 
-    for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-        for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j)
-                EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements[i][j]);
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j)
+                EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements(i, j));
     }
 }
 
@@ -301,9 +1283,9 @@ TEST_F(beamFEATest, CorrectTipDisplacementCantileverBeam) {
     std::vector<std::vector<double> > expected = {{0., 0.,                   0., 0., 0., 0.},
                                                   {0., 0.033333333333333333, 0., 0., 0., 0.05}};
 
-    for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-        for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j)
-                EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements[i][j]);
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j)
+                EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_displacements(i, j));
     }
 }
 
@@ -326,9 +1308,9 @@ TEST_F(beamFEATest, CorrectTipForcesCantileverBeam) {
     std::vector<std::vector<double> > expected = {{-0.1, -0.3, 0., 0., 0., -0.3},
                                                   { 0.1,  0.3, 0., 0., 0.,  0.}};
 
-    for (size_t i = 0; i < summary.nodal_forces.size(); ++i) {
-        for (size_t j = 0; j < summary.nodal_forces[i].size(); ++j)
-                EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_forces[i][j]);
+    for (size_t i = 0; i < summary.nodal_forces.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_forces.cols(); ++j)
+                EXPECT_DOUBLE_EQ(expected[i][j], summary.nodal_forces(i, j));
     }
 }
 
@@ -377,9 +1359,9 @@ TEST_F(beamFEATest, CorrectDisplacementWeakTies) {
                                                   {0.5, 0.0, 0.0, 0.0, 0.0, 0.0},
                                                   {0.5, 0.0, 0.0, 0.0, 0.0, 0.0}};
 
-    for (size_t i = 0; i < summary.nodal_displacements.size(); ++i) {
-        for (size_t j = 0; j < summary.nodal_displacements[i].size(); ++j) {
-            EXPECT_NEAR(expected[i][j], summary.nodal_displacements[i][j], 1e-10);
+    for (size_t i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        for (size_t j = 0; j < summary.nodal_displacements.cols(); ++j) {
+            EXPECT_NEAR(expected[i][j], summary.nodal_displacements(i, j), 1e-10);
         }
     }
 }
@@ -423,9 +1405,9 @@ TEST_F(beamFEATest, CorrectForcesWeakTies) {
 
     std::vector<std::vector<double> > expected = {{0.005, 0.0, 0.0, 0.005, 0.0, 0.0}};
 
-    for (size_t i = 0; i < summary.tie_forces.size(); ++i) {
-        for (size_t j = 0; j < summary.tie_forces[i].size(); ++j) {
-            EXPECT_NEAR(expected[i][j], summary.tie_forces[i][j], 1e-13);
+    for (size_t i = 0; i < summary.tie_forces.rows(); ++i) {
+        for (size_t j = 0; j < summary.tie_forces.cols(); ++j) {
+            EXPECT_NEAR(expected[i][j], summary.tie_forces(i, j), 1e-13);
         }
     }
 }
@@ -25,9 +25,80 @@
 
 #include <gtest/gtest.h>
 #include <csv_parser.h>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace fea;
 
+namespace {
+    // Writes `contents` to `filename` and returns the rows read by `CSVParser` and by the stream operator.
+    void parseBothWays(const std::string &filename,
+                       const std::string &contents,
+                       std::vector<std::vector<double> > &parsed,
+                       std::vector<std::vector<double> > &streamed) {
+        std::ofstream output_file(filename, std::ios::binary);
+        output_file << contents;
+        output_file.close();
+
+        CSVParser csv;
+        csv.parseToVector(filename, parsed);
+
+        std::ifstream input_file(filename, std::ios::binary);
+        input_file >> streamed;
+        input_file.close();
+
+        if (std::remove(filename.c_str()) != 0) {
+            std::cerr << "Error removing test csv file " << filename << ".\n";
+        }
+    }
+
+    void expectSameRows(const std::vector<std::vector<double> > &expected,
+                        const std::vector<std::vector<double> > &actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(expected[i].size(), actual[i].size()) << "row " << i;
+            for (size_t j = 0; j < expected[i].size(); ++j) {
+                if (std::isnan(expected[i][j])) {
+                    EXPECT_TRUE(std::isnan(actual[i][j])) << "row " << i << ", column " << j;
+                }
+                else {
+                    EXPECT_EQ(expected[i][j], actual[i][j]) << "row " << i << ", column " << j;
+                }
+            }
+        }
+    }
+
+    // Returns the contents of `data` as the stream based writer formatted them.
+    std::string formatWithStream(const std::vector<std::vector<double> > &data,
+                                 unsigned int precision,
+                                 const std::string &delimiter) {
+        std::ostringstream stream;
+        for (size_t i = 0; i < data.size(); ++i) {
+            for (size_t j = 0; j < data[i].size(); ++j) {
+                stream << std::fixed << std::setprecision(precision) << data[i][j];
+                if (j + 1 < data[i].size()) {
+                    stream << delimiter;
+                }
+            }
+            stream << "\n";
+        }
+        return stream.str();
+    }
+
+    std::string readFile(const std::string &filename) {
+        std::ifstream input_file(filename);
+        std::stringstream contents;
+        contents << input_file.rdbuf();
+        return contents.str();
+    }
+}
+
 TEST(CSVParserTest, ReadWriteElemsFromFile) {
 
     CSVParser csv;
@@ -98,3 +169,131 @@ TEST(CSVParserTest, ReadWriteElemSetFromFile) {
         std::cerr << "Error removing test csv file " << filename << ".\n";
     }
 }
+
+TEST(CSVParserTest, ParsesValuesLikeStrtod) {
+    std::string contents = "1,2\n"
+            "\n"
+            "1, 2\t3\n"
+            "1,2,\n"
+            "1e3,-2.5e-1,+3,abc,0x10,inf, nan\n"
+            "0.1,-0,3.14159265358979323846,123456789012345678901234,1e-400,1.5e,2.5x\n"
+            "0.000000000000000000000000000001,9007199254740993,1E22,1e23,-.5,5.";
+
+    std::vector<std::vector<double> > parsed, streamed;
+    parseBothWays("parses_values_like_strtod.csv", contents, parsed, streamed);
+
+    ASSERT_EQ(7, parsed.size());
+    EXPECT_EQ(0, parsed[1].size());
+    EXPECT_EQ(std::vector<double>({1, 0, 2, 3}), parsed[2]);
+    EXPECT_EQ(std::vector<double>({1, 2, 0}), parsed[3]);
+    expectSameRows(streamed, parsed);
+}
+
+TEST(CSVParserTest, IgnoresCarriageReturns) {
+    std::vector<std::vector<double> > parsed, streamed;
+    parseBothWays("ignores_carriage_returns.csv", "1,2\r\n3,4\r\n", parsed, streamed);
+
+    std::vector<std::vector<double> > expected = {{1, 2},
+                                                  {3, 4}};
+    expectSameRows(expected, parsed);
+}
+
+TEST(CSVParserTest, ParsesLargeFilesInChunks) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1e3, 1e3);
+
+#ifdef _OPENMP
+    // split the file into several chunks even on machines with a single core
+    const int num_threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+
+    // larger than the minimum chunk size of several threads
+    std::ostringstream contents;
+    contents << std::setprecision(17);
+    for (size_t i = 0; i < 200000; ++i) {
+        contents << i << "," << distribution(generator) << " " << distribution(generator) << "\t"
+                 << std::fixed << std::setprecision(6) << distribution(generator) << std::defaultfloat
+                 << std::setprecision(17) << "\n";
+    }
+
+    std::vector<std::vector<double> > parsed, streamed;
+    parseBothWays("parses_large_files_in_chunks.csv", contents.str(), parsed, streamed);
+
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#endif
+
+    ASSERT_EQ(200000, parsed.size());
+    EXPECT_EQ(199999, parsed.back()[0]);
+    expectSameRows(streamed, parsed);
+}
+
+TEST(CSVParserTest, ThrowsOnMissingFile) {
+    CSVParser csv;
+    std::vector<std::vector<double> > data;
+    EXPECT_THROW(csv.parseToVector("this_file_does_not_exist.csv", data), std::runtime_error);
+}
+
+TEST(CSVParserTest, WritesValuesLikeFixedStream) {
+    std::mt19937_64 generator(7);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-20, 20);
+    std::uniform_int_distribution<uint64_t> bits;
+
+    std::vector<std::vector<double> > data = {
+            {0.0, -0.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.375, -0.625, 1e-20},
+            {0.05, 0.15, 0.25, 0.35, 1.0005, 2.675, 999.9999999999999, 9.5, 99.5, 1e15},
+            {1e16, 4503599627370496.0, 4503599627370495.5, 1e22, -1e300, 5e-324, INFINITY, -INFINITY, NAN, 123.456},
+            {}
+    };
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<double> row;
+        for (int j = 0; j < 6; ++j) {
+            row.push_back(unit(generator) * std::pow(10.0, exponent(generator)));
+        }
+        data.push_back(row);
+    }
+    // arbitrary bit patterns and multiples of small powers of two, which are exact ties at low precisions
+    for (int i = 0; i < 500; ++i) {
+        double from_bits;
+        const uint64_t pattern = bits(generator);
+        std::memcpy(&from_bits, &pattern, sizeof(from_bits));
+        data.push_back({from_bits,
+                        (bits(generator) % 100000) / 1024.0,
+                        -static_cast<double>(bits(generator) % 4096) / 32.0});
+    }
+
+    const std::string filename = "WritesValuesLikeFixedStream.csv";
+    CSVParser csv;
+    const std::string delimiters[] = {",", " ; "};
+    for (unsigned int precision = 0; precision <= 18; ++precision) {
+        for (size_t d = 0; d < 2; ++d) {
+            csv.write(filename, data, precision, delimiters[d]);
+            EXPECT_EQ(formatWithStream(data, precision, delimiters[d]), readFile(filename))
+                << "precision " << precision;
+        }
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(CSVParserTest, WritesLargeFilesInChunks) {
+    std::vector<std::vector<double> > data(100000, std::vector<double>(6));
+    for (size_t i = 0; i < data.size(); ++i) {
+        for (size_t j = 0; j < 6; ++j) {
+            data[i][j] = std::sin(static_cast<double>(6 * i + j)) * (j + 1);
+        }
+    }
+
+    const std::string filename = "WritesLargeFilesInChunks.csv";
+    CSVParser csv;
+    csv.write(filename, data, 14, ",", 4);
+    EXPECT_EQ(formatWithStream(data, 14, ","), readFile(filename));
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
@@ -0,0 +1,125 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+// Compares the time to compute the elemental stiffness matrices with the
+// closed form blocks, the batched closed form and the dense triple product.
+// Not part of the unit tests, run it by hand:
+//
+//     benchmarkKelem [grid size] [number of repeats]
+
+#include "threed_beam_fea.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace fea;
+
+namespace {
+    // Creates a lattice of n x n x n nodes connected along the axes and one diagonal.
+    Job createGridJob(unsigned int n) {
+        std::vector<double> normal_vec = {1.0, 1.0, 1.0};
+        Props props(10.0, 2.0, 3.0, 4.0, normal_vec);
+
+        std::vector<Node> nodes;
+        for (unsigned int k = 0; k < n; ++k) {
+            for (unsigned int j = 0; j < n; ++j) {
+                for (unsigned int i = 0; i < n; ++i) {
+                    nodes.push_back(Node(i + 0.1 * j, j + 0.05 * k, k + 0.01 * i));
+                }
+            }
+        }
+
+        std::vector<Elem> elems;
+        for (unsigned int k = 0; k < n; ++k) {
+            for (unsigned int j = 0; j < n; ++j) {
+                for (unsigned int i = 0; i < n; ++i) {
+                    const unsigned int nn = (k * n + j) * n + i;
+                    if (i + 1 < n) elems.push_back(Elem(nn, nn + 1, props));
+                    if (j + 1 < n) elems.push_back(Elem(nn, nn + n, props));
+                    if (k + 1 < n) elems.push_back(Elem(nn, nn + n * n, props));
+                    if (i + 1 < n && j + 1 < n) elems.push_back(Elem(nn, nn + n + 1, props));
+                }
+            }
+        }
+        return Job(nodes, elems);
+    }
+
+    long long elapsedMicroseconds(const std::chrono::high_resolution_clock::time_point &start_time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start_time).count();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned int grid_size = argc > 1 ? std::atoi(argv[1]) : 12;
+    const unsigned int num_repeats = argc > 2 ? std::atoi(argv[2]) : 20;
+    const Job job = createGridJob(grid_size);
+
+    // the sums keep the compiler from dropping the computations
+    GlobalStiffAssembler assembler;
+    double dense_sum = 0.0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (unsigned int n = 0; n < num_repeats; ++n) {
+        for (unsigned int i = 0; i < job.elems.size(); ++i) {
+            assembler.calcKelemDense(i, job);
+            dense_sum += assembler.getKelem()(1, 5);
+        }
+    }
+    const long long dense_time = elapsedMicroseconds(start_time);
+
+    double closed_form_sum = 0.0;
+    start_time = std::chrono::high_resolution_clock::now();
+    for (unsigned int n = 0; n < num_repeats; ++n) {
+        for (unsigned int i = 0; i < job.elems.size(); ++i) {
+            assembler.calcKelem(i, job);
+            closed_form_sum += assembler.getKelem()(1, 5);
+        }
+    }
+    const long long closed_form_time = elapsedMicroseconds(start_time);
+
+    const ElemSoA elems(job);
+    const size_t num_batched = job.elems.size() - job.elems.size() % ELEM_BATCH_SIZE;
+    double batch_sum = 0.0;
+    start_time = std::chrono::high_resolution_clock::now();
+    for (unsigned int n = 0; n < num_repeats; ++n) {
+        for (unsigned int first = 0; first < num_batched; first += ELEM_BATCH_SIZE) {
+            assembler.calcKelemBatch(first, elems);
+            for (unsigned int l = 0; l < ELEM_BATCH_SIZE; ++l) {
+                batch_sum += assembler.getKelemBatch(l)(1, 5);
+            }
+        }
+        for (size_t i = num_batched; i < job.elems.size(); ++i) {
+            assembler.calcKelem(i, job);
+            batch_sum += assembler.getKelem()(1, 5);
+        }
+    }
+    const long long batch_time = elapsedMicroseconds(start_time);
+
+    std::cout << num_repeats * job.elems.size() << " elemental stiffness matrices: "
+              << "dense " << dense_time << " us, closed form " << closed_form_time << " us, "
+              << "batched closed form " << batch_time << " us" << std::endl;
+    std::cout << "checksums: " << dense_sum << ", " << closed_form_sum << ", " << batch_sum << std::endl;
+    return 0;
+}
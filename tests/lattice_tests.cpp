@@ -0,0 +1,188 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "lattice.h"
+#include "threed_beam_fea.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace fea;
+
+namespace {
+    // Checks that no two nodes coincide and no two elements connect the same pair of nodes.
+    void expectNoDuplicates(const Job &job) {
+        std::vector<std::vector<double> > nodes;
+        for (size_t i = 0; i < job.nodes.size(); ++i) {
+            nodes.push_back({job.nodes[i](0), job.nodes[i](1), job.nodes[i](2)});
+        }
+        std::sort(nodes.begin(), nodes.end());
+        EXPECT_TRUE(std::adjacent_find(nodes.begin(), nodes.end()) == nodes.end());
+
+        std::vector<std::pair<int, int> > elems;
+        for (size_t i = 0; i < job.elems.size(); ++i) {
+            elems.push_back(std::make_pair(std::min(job.elems[i](0), job.elems[i](1)),
+                                           std::max(job.elems[i](0), job.elems[i](1))));
+        }
+        std::sort(elems.begin(), elems.end());
+        EXPECT_TRUE(std::adjacent_find(elems.begin(), elems.end()) == elems.end());
+    }
+
+    // Checks that every element has the expected length and a normal vector perpendicular to it.
+    void expectStruts(const Job &job, double length) {
+        ASSERT_EQ(job.elems.size(), job.prop_ids.size());
+        for (size_t i = 0; i < job.elems.size(); ++i) {
+            ASSERT_LT(job.prop_ids[i], job.props.size());
+            const Eigen::Vector3d axis = job.nodes[job.elems[i](1)] - job.nodes[job.elems[i](0)];
+            EXPECT_NEAR(length, axis.norm(), 1e-12);
+            EXPECT_NEAR(0, axis.dot(job.getElemProps(i).normal_vec), 1e-12);
+            EXPECT_NEAR(1, job.getElemProps(i).normal_vec.norm(), 1e-12);
+        }
+    }
+
+    const Props SECTION(1000.0, 100.0, 100.0, 200.0, {0, 0, 0});
+}
+
+TEST(LatticeTest, CreatesBuiltInUnitCells) {
+    const UnitCell cubic = createUnitCell(CUBIC_CELL);
+    EXPECT_EQ(1u, cubic.nodes.size());
+    EXPECT_EQ(3u, cubic.struts.size());
+
+    const UnitCell octet = createUnitCell(OCTET_CELL);
+    EXPECT_EQ(4u, octet.nodes.size());
+    EXPECT_EQ(24u, octet.struts.size());
+
+    // every vertex of the Kelvin foam joins 4 struts
+    const UnitCell kelvin = createUnitCell(KELVIN_CELL);
+    ASSERT_EQ(12u, kelvin.nodes.size());
+    ASSERT_EQ(24u, kelvin.struts.size());
+    std::vector<int> degree(kelvin.nodes.size(), 0);
+    for (size_t i = 0; i < kelvin.struts.size(); ++i) {
+        ++degree[kelvin.struts[i].node_1];
+        ++degree[kelvin.struts[i].node_2];
+    }
+    for (size_t i = 0; i < degree.size(); ++i) {
+        EXPECT_EQ(4, degree[i]);
+    }
+}
+
+TEST(LatticeTest, TilesCubicLattice) {
+    const Job job = createLatticeJob(createUnitCell(CUBIC_CELL), Eigen::Vector3i(2, 3, 4),
+                                     Eigen::Vector3d(0.5, 0.5, 0.5), SECTION);
+
+    EXPECT_EQ(3u * 4u * 5u, job.nodes.size());
+    EXPECT_EQ(2u * 4u * 5u + 3u * 3u * 5u + 3u * 4u * 4u, job.elems.size());
+    EXPECT_EQ(3u, job.props.size());
+    EXPECT_DOUBLE_EQ(SECTION.EA, job.props[0].EA);
+    EXPECT_DOUBLE_EQ(SECTION.GJ, job.props[2].GJ);
+    expectNoDuplicates(job);
+    expectStruts(job, 0.5);
+}
+
+TEST(LatticeTest, TilesOctetAndKelvinLattices) {
+    const Job octet = createLatticeJob(createUnitCell(OCTET_CELL), Eigen::Vector3i(3, 2, 2),
+                                       Eigen::Vector3d(2, 2, 2), SECTION);
+
+    // corners plus the centers of the faces parallel to each coordinate plane
+    EXPECT_EQ(4u * 3u * 3u + 3u * 2u * 3u + 3u * 3u * 2u + 4u * 2u * 2u, octet.nodes.size());
+    expectNoDuplicates(octet);
+    expectStruts(octet, std::sqrt(2.0));
+
+    const Job kelvin = createLatticeJob(createUnitCell(KELVIN_CELL), Eigen::Vector3i(2, 2, 2),
+                                        Eigen::Vector3d(4, 4, 4), SECTION);
+    EXPECT_FALSE(kelvin.elems.empty());
+    expectNoDuplicates(kelvin);
+    expectStruts(kelvin, std::sqrt(2.0));
+}
+
+TEST(LatticeTest, ParallelConstructionIsDeterministic) {
+    const UnitCell cell = createUnitCell(OCTET_CELL);
+    const Eigen::Vector3i num_cells(5, 4, 3);
+    const Eigen::Vector3d cell_size(1, 2, 3);
+
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    const Job expected = createLatticeJob(cell, num_cells, cell_size, SECTION);
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    const Job job = createLatticeJob(cell, num_cells, cell_size, SECTION);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+
+    ASSERT_EQ(expected.nodes.size(), job.nodes.size());
+    for (size_t i = 0; i < job.nodes.size(); ++i) {
+        EXPECT_EQ(expected.nodes[i], job.nodes[i]);
+    }
+    ASSERT_EQ(expected.elems.size(), job.elems.size());
+    for (size_t i = 0; i < job.elems.size(); ++i) {
+        EXPECT_EQ(expected.elems[i], job.elems[i]);
+        EXPECT_EQ(expected.prop_ids[i], job.prop_ids[i]);
+    }
+}
+
+TEST(LatticeTest, SolvesLoadedLattice) {
+    const Job job = createLatticeJob(createUnitCell(CUBIC_CELL), Eigen::Vector3i(2, 2, 3),
+                                     Eigen::Vector3d(1, 1, 1), SECTION);
+
+    const std::vector<unsigned int> bottom = findFaceNodes(job, Z_MIN);
+    const std::vector<unsigned int> top = findFaceNodes(job, Z_MAX);
+    ASSERT_EQ(9u, bottom.size());
+    ASSERT_EQ(9u, top.size());
+
+    const std::vector<BC> bcs = createFixedBCs(bottom);
+    EXPECT_EQ(9u * NUM_DOFS, bcs.size());
+
+    const std::vector<Force> forces = createDistributedForces(top, Eigen::Vector3d(0, 0, -9));
+    ASSERT_EQ(9u, forces.size());
+    EXPECT_DOUBLE_EQ(-1, forces[0].value);
+    EXPECT_EQ(DISPLACEMENT_Z, forces[0].dof);
+
+    Options opts;
+    const Summary summary = solve(job, bcs, forces, std::vector<Tie>(), std::vector<Equation>(), opts);
+
+    // the columns shorten by the axial load on each of the 9 columns of 3 struts
+    for (size_t i = 0; i < top.size(); ++i) {
+        EXPECT_NEAR(-3.0 / SECTION.EA, summary.nodal_displacements(top[i], 2), 1e-12);
+    }
+}
+
+TEST(LatticeTest, RejectsInvalidInput) {
+    std::vector<Eigen::Vector3d> nodes(1, Eigen::Vector3d(0, 0, 1));
+    EXPECT_THROW(createUnitCell(nodes, 1.0), std::runtime_error);
+    nodes[0] = Eigen::Vector3d(0, 0, 0);
+    EXPECT_THROW(createUnitCell(nodes, 1.5), std::runtime_error);
+    EXPECT_THROW(createLatticeJob(createUnitCell(CUBIC_CELL), Eigen::Vector3i(1, 0, 1), Eigen::Vector3d(1, 1, 1),
+                                  SECTION), std::runtime_error);
+    EXPECT_THROW(createDistributedForces(std::vector<unsigned int>(), Eigen::Vector3d(1, 0, 0)), std::runtime_error);
+}
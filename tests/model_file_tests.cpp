@@ -0,0 +1,236 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include "model_file.h"
+#include "setup.h"
+
+using namespace fea;
+
+namespace {
+    void writeStringToTxt(std::string filename, std::string data) {
+        std::ofstream output_file;
+        output_file.open(filename);
+
+        if (!output_file.is_open()) {
+            std::cerr << "Error opening file" << filename << ".\n";
+        }
+        else {
+            output_file << data;
+            output_file.close();
+        }
+    }
+
+    void removeFile(const std::string &filename) {
+        if (std::remove(filename.c_str()) != 0) {
+            std::cerr << "Error removing test file " << filename << ".\n";
+        }
+    }
+}
+
+TEST(ModelFileTest, RoundTripsModelFromJSON) {
+    writeStringToTxt("RoundTripsModel_nodes.csv", "0,0,0\n1,0,0\n2,0.5,0\n");
+    writeStringToTxt("RoundTripsModel_elems.csv", "0,1\n1,2\n");
+    writeStringToTxt("RoundTripsModel_props.csv", "1,2,3,4,0,0,1\n5,6,7,8,0,1,0\n");
+    writeStringToTxt("RoundTripsModel_bcs.csv", "0,0,0\n0,1,0.5\n");
+    writeStringToTxt("RoundTripsModel_forces.csv", "2,1,-10\n2,2,3,2\n1,0,4\n");
+    writeStringToTxt("RoundTripsModel_ties.csv", "1,2,100,200\n");
+    writeStringToTxt("RoundTripsModel_equations.csv", "0,1,1,2,1,-1\n1,5,2\n");
+    std::string json = "{\"nodes\":\"RoundTripsModel_nodes.csv\",\"elems\":\"RoundTripsModel_elems.csv\","
+            "\"props\":\"RoundTripsModel_props.csv\",\"bcs\":\"RoundTripsModel_bcs.csv\","
+            "\"forces\":\"RoundTripsModel_forces.csv\",\"ties\":\"RoundTripsModel_ties.csv\","
+            "\"equations\":\"RoundTripsModel_equations.csv\","
+            "\"options\":{\"epsilon\":1e-10,\"linear_solver\":\"ldlt\",\"report_filename\":\"model_report.txt\"}}\n";
+    writeStringToTxt("RoundTripsModel.json", json);
+
+    rapidjson::Document doc = parseJSONConfig("RoundTripsModel.json");
+    const Model expected = createModelFromJSON(doc);
+    convertJSONToModelFile(doc, "RoundTripsModel.feab");
+
+    EXPECT_TRUE(isModelFile("RoundTripsModel.feab"));
+    EXPECT_FALSE(isModelFile("RoundTripsModel.json"));
+
+    const Model model = readModelFile("RoundTripsModel.feab");
+
+    ASSERT_EQ(expected.job.nodes.size(), model.job.nodes.size());
+    for (size_t i = 0; i < model.job.nodes.size(); ++i) {
+        EXPECT_EQ(expected.job.nodes[i], model.job.nodes[i]);
+    }
+    ASSERT_EQ(expected.job.elems.size(), model.job.elems.size());
+    ASSERT_EQ(expected.job.props.size(), model.job.props.size());
+    for (size_t i = 0; i < model.job.elems.size(); ++i) {
+        EXPECT_EQ(expected.job.elems[i], model.job.elems[i]);
+        EXPECT_EQ(expected.job.props[i].EA, model.job.props[i].EA);
+        EXPECT_EQ(expected.job.props[i].EIz, model.job.props[i].EIz);
+        EXPECT_EQ(expected.job.props[i].EIy, model.job.props[i].EIy);
+        EXPECT_EQ(expected.job.props[i].GJ, model.job.props[i].GJ);
+        EXPECT_EQ(expected.job.props[i].normal_vec, model.job.props[i].normal_vec);
+    }
+
+    ASSERT_EQ(expected.bcs.size(), model.bcs.size());
+    for (size_t i = 0; i < model.bcs.size(); ++i) {
+        EXPECT_EQ(expected.bcs[i].node, model.bcs[i].node);
+        EXPECT_EQ(expected.bcs[i].dof, model.bcs[i].dof);
+        EXPECT_EQ(expected.bcs[i].value, model.bcs[i].value);
+    }
+
+    ASSERT_EQ(3u, model.load_cases.size());
+    for (size_t i = 0; i < model.load_cases.size(); ++i) {
+        ASSERT_EQ(expected.load_cases[i].size(), model.load_cases[i].size());
+        for (size_t j = 0; j < model.load_cases[i].size(); ++j) {
+            EXPECT_EQ(expected.load_cases[i][j].node, model.load_cases[i][j].node);
+            EXPECT_EQ(expected.load_cases[i][j].dof, model.load_cases[i][j].dof);
+            EXPECT_EQ(expected.load_cases[i][j].value, model.load_cases[i][j].value);
+        }
+    }
+
+    ASSERT_EQ(1u, model.ties.size());
+    EXPECT_EQ(1u, model.ties[0].node_number_1);
+    EXPECT_EQ(2u, model.ties[0].node_number_2);
+    EXPECT_EQ(100, model.ties[0].lmult);
+    EXPECT_EQ(200, model.ties[0].rmult);
+
+    ASSERT_EQ(expected.equations.size(), model.equations.size());
+    for (size_t i = 0; i < model.equations.size(); ++i) {
+        ASSERT_EQ(expected.equations[i].terms.size(), model.equations[i].terms.size());
+        for (size_t j = 0; j < model.equations[i].terms.size(); ++j) {
+            EXPECT_EQ(expected.equations[i].terms[j].node_number, model.equations[i].terms[j].node_number);
+            EXPECT_EQ(expected.equations[i].terms[j].dof, model.equations[i].terms[j].dof);
+            EXPECT_EQ(expected.equations[i].terms[j].coefficient, model.equations[i].terms[j].coefficient);
+        }
+    }
+
+    EXPECT_EQ(1e-10, model.options.epsilon);
+    EXPECT_EQ(SPARSE_LDLT, model.options.linear_solver);
+    EXPECT_EQ("model_report.txt", model.options.report_filename);
+    EXPECT_EQ(expected.options.csv_precision, model.options.csv_precision);
+
+    const char *files[] = {"RoundTripsModel_nodes.csv", "RoundTripsModel_elems.csv", "RoundTripsModel_props.csv",
+                           "RoundTripsModel_bcs.csv", "RoundTripsModel_forces.csv", "RoundTripsModel_ties.csv",
+                           "RoundTripsModel_equations.csv", "RoundTripsModel.json", "RoundTripsModel.feab"};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+        removeFile(files[i]);
+    }
+}
+
+TEST(ModelFileTest, RoundTripsModelWithDefaults) {
+    Model model;
+    model.job.nodes.push_back(Node(1, 2, 3));
+
+    writeModelFile("RoundTripsDefaults.feab", model);
+    const Model read = readModelFile("RoundTripsDefaults.feab");
+
+    ASSERT_EQ(1u, read.job.nodes.size());
+    EXPECT_EQ(model.job.nodes[0], read.job.nodes[0]);
+    EXPECT_TRUE(read.job.elems.empty());
+    EXPECT_TRUE(read.bcs.empty());
+    ASSERT_EQ(1u, read.load_cases.size());
+    EXPECT_TRUE(read.load_cases[0].empty());
+    EXPECT_TRUE(read.ties.empty());
+    EXPECT_TRUE(read.equations.empty());
+    EXPECT_EQ(model.options.epsilon, read.options.epsilon);
+
+    removeFile("RoundTripsDefaults.feab");
+}
+
+TEST(ModelFileTest, RoundTripsOptionsSetInCode) {
+    Model model;
+    model.job.nodes.push_back(Node(1, 2, 3));
+    model.options.epsilon = 1.25e-9;
+    model.options.csv_delimiter = ";";
+    model.options.result_format = NPY_RESULTS;
+    model.options.save_vtu = true;
+    model.options.compute_tie_forces = false;
+    model.options.num_threads = 3;
+    model.options.linear_solver = MINRES;
+    model.options.preconditioner = INCOMPLETE_CHOLESKY;
+    model.options.tolerance = 1.0 / 3.0;
+    model.options.node_ordering = HILBERT_CURVE;
+    model.options.eliminate_bcs = true;
+    model.options.vtu_filename = "options.vtu";
+
+    // written, read and written again, so options read from a model file survive another round trip
+    writeModelFile("RoundTripsOptions.feab", model);
+    writeModelFile("RoundTripsOptions.feab", readModelFile("RoundTripsOptions.feab"));
+    const Options read = readModelFile("RoundTripsOptions.feab").options;
+
+    EXPECT_EQ(model.options.epsilon, read.epsilon);
+    EXPECT_EQ(model.options.csv_delimiter, read.csv_delimiter);
+    EXPECT_EQ(NPY_RESULTS, read.result_format);
+    EXPECT_TRUE(read.save_vtu);
+    EXPECT_FALSE(read.compute_tie_forces);
+    EXPECT_EQ(3u, read.num_threads);
+    EXPECT_EQ(MINRES, read.linear_solver);
+    EXPECT_EQ(INCOMPLETE_CHOLESKY, read.preconditioner);
+    EXPECT_EQ(model.options.tolerance, read.tolerance);
+    EXPECT_EQ(HILBERT_CURVE, read.node_ordering);
+    EXPECT_TRUE(read.eliminate_bcs);
+    EXPECT_EQ("options.vtu", read.vtu_filename);
+    EXPECT_EQ(model.options.report_filename, read.report_filename);
+
+    removeFile("RoundTripsOptions.feab");
+}
+
+TEST(ModelFileTest, RoundTripsPropertyTable) {
+    Model model;
+    std::vector<double> normal_vec = {0.0, 0.0, 1.0};
+    model.job.nodes = {Node(0, 0, 0), Node(1, 0, 0), Node(2, 0, 0)};
+    model.job.elems = {Eigen::Vector2i(0, 1), Eigen::Vector2i(1, 2)};
+    model.job.props = {Props(1, 2, 3, 4, normal_vec)};
+    model.job.prop_ids = {0, 0};
+
+    writeModelFile("RoundTripsPropertyTable.feab", model);
+    const Model read = readModelFile("RoundTripsPropertyTable.feab");
+    ASSERT_EQ(1u, read.job.props.size());
+    EXPECT_EQ(model.job.prop_ids, read.job.prop_ids);
+    EXPECT_EQ(3, read.job.getElemProps(1).EIy);
+
+    removeFile("RoundTripsPropertyTable.feab");
+}
+
+TEST(ModelFileTest, RejectsInvalidFiles) {
+    writeStringToTxt("RejectsInvalidFiles.feab", "1,2,3\n");
+    EXPECT_THROW(readModelFile("RejectsInvalidFiles.feab"), std::runtime_error);
+
+    Model model;
+    model.job.nodes.resize(100, Node(1, 2, 3));
+    writeModelFile("RejectsInvalidFiles.feab", model);
+
+    // truncate the file in the middle of the nodes
+    std::string contents;
+    {
+        std::ifstream file("RejectsInvalidFiles.feab", std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::ofstream file("RejectsInvalidFiles.feab", std::ios::binary);
+    file.write(contents.data(), 1024);
+    file.close();
+    EXPECT_THROW(readModelFile("RejectsInvalidFiles.feab"), std::runtime_error);
+
+    EXPECT_THROW(readModelFile("this_file_does_not_exist.feab"), std::runtime_error);
+
+    removeFile("RejectsInvalidFiles.feab");
+}
@@ -0,0 +1,273 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "result_file.h"
+#include "threed_beam_fea.h"
+
+using namespace fea;
+
+namespace {
+    // Reads a version 1.0 .npy file written on this machine. Returns the header dictionary and the values.
+    std::string readNpyFile(const std::string &filename, std::vector<double> &values) {
+        std::ifstream file(filename, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const std::string bytes = contents.str();
+
+        EXPECT_GE(bytes.size(), 10u);
+        EXPECT_EQ(std::string("\x93NUMPY\x01\x00", 8), bytes.substr(0, 8));
+        const size_t header_length = static_cast<unsigned char>(bytes[8])
+                                     + 256 * static_cast<size_t>(static_cast<unsigned char>(bytes[9]));
+        const size_t data_offset = 10 + header_length;
+        EXPECT_EQ(0u, data_offset % 64);
+        EXPECT_EQ('\n', bytes[data_offset - 1]);
+        EXPECT_EQ(0u, (bytes.size() - data_offset) % sizeof(double));
+
+        values.resize((bytes.size() - data_offset) / sizeof(double));
+        if (!values.empty()) {
+            std::memcpy(values.data(), bytes.data() + data_offset, values.size() * sizeof(double));
+        }
+        return bytes.substr(10, header_length);
+    }
+
+    std::string nativeDescr() {
+        const uint16_t one = 1;
+        char first_byte;
+        std::memcpy(&first_byte, &one, 1);
+        return first_byte == 1 ? "'<f8'" : "'>f8'";
+    }
+
+    // Returns the values of the appended array `name` of a .vtu file written on this machine.
+    template<typename T>
+    std::vector<T> readVtuArray(const std::string &contents, const std::string &name) {
+        const size_t array_pos = contents.find("Name=\"" + name + "\"");
+        EXPECT_NE(std::string::npos, array_pos) << name;
+        const size_t offset_pos = contents.find("offset=\"", array_pos) + 8;
+        const size_t offset = std::stoul(contents.substr(offset_pos, contents.find('"', offset_pos) - offset_pos));
+        const size_t data_pos = contents.find("<AppendedData encoding=\"raw\">");
+        const size_t base = contents.find('_', data_pos) + 1;
+
+        uint64_t num_bytes;
+        std::memcpy(&num_bytes, contents.data() + base + offset, sizeof(num_bytes));
+        std::vector<T> values(num_bytes / sizeof(T));
+        if (!values.empty()) {
+            std::memcpy(values.data(), contents.data() + base + offset + sizeof(num_bytes), num_bytes);
+        }
+        return values;
+    }
+
+    std::string readFile(const std::string &filename) {
+        std::ifstream file(filename, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void removeFile(const std::string &filename) {
+        if (std::remove(filename.c_str()) != 0) {
+            std::cerr << "Error removing test file " << filename << ".\n";
+        }
+    }
+}
+
+TEST(ResultFileTest, WritesNpyFile) {
+    ResultMatrix data(2, 6);
+    data << 1, 2, 3, 4, 5, 6,
+            -0.1, 1e-300, 1e300, -0.0, 7.25, 3.141592653589793;
+    const std::string filename = "WritesNpyFile.npy";
+    writeNpyFile(filename, data);
+
+    std::vector<double> values;
+    const std::string header = readNpyFile(filename, values);
+    EXPECT_NE(std::string::npos, header.find("'descr': " + nativeDescr()));
+    EXPECT_NE(std::string::npos, header.find("'fortran_order': False"));
+    EXPECT_NE(std::string::npos, header.find("'shape': (2, 6)"));
+    ASSERT_EQ(12u, values.size());
+    for (long i = 0; i < data.rows(); ++i) {
+        for (long j = 0; j < 6; ++j) {
+            EXPECT_EQ(data(i, j), values[6 * i + j]);
+        }
+    }
+
+    writeNpyFile(filename, ResultMatrix(0, 6));
+    EXPECT_NE(std::string::npos, readNpyFile(filename, values).find("'shape': (0, 6)"));
+    EXPECT_TRUE(values.empty());
+    removeFile(filename);
+}
+
+TEST(ResultFileTest, SolveSavesNpyResults) {
+    std::vector<Node> nodes = {Node(0, 0, 0), Node(1, 0, 0), Node(2, 0, 0)};
+    Props props(1000.0, 100.0, 100.0, 200.0, {0.0, 0.0, 1.0});
+    std::vector<Elem> elems = {Elem(0, 1, props), Elem(1, 2, props)};
+    Job job(nodes, elems);
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+    }
+    std::vector<std::vector<Force> > load_cases = {{Force(2, DOF::DISPLACEMENT_Y, 1.0)},
+                                                   {Force(2, DOF::DISPLACEMENT_Z, -2.0)}};
+    std::vector<Tie> ties = {Tie(1, 2, 10.0, 10.0)};
+
+    Options opts;
+    opts.result_format = NPY_RESULTS;
+    opts.save_nodal_displacements = true;
+    opts.save_nodal_forces = true;
+    opts.save_tie_forces = true;
+    opts.nodal_displacements_filename = "SolveSavesNpyResults_disp.csv";
+    opts.nodal_forces_filename = "SolveSavesNpyResults_forces.npy";
+    opts.tie_forces_filename = "SolveSavesNpyResults_ties";
+    std::vector<Summary> summaries = solve(job, bcs, load_cases, ties, std::vector<Equation>(), opts);
+
+    for (size_t c = 0; c < load_cases.size(); ++c) {
+        const std::string suffix = c == 0 ? "_case0" : "_case1";
+        std::vector<double> values;
+
+        const std::string disp_file = "SolveSavesNpyResults_disp" + suffix + ".npy";
+        EXPECT_NE(std::string::npos, readNpyFile(disp_file, values).find("'shape': (3, 6)"));
+        ASSERT_EQ(18u, values.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+                EXPECT_EQ(summaries[c].nodal_displacements(i, j), values[6 * i + j]);
+            }
+        }
+
+        const std::string forces_file = "SolveSavesNpyResults_forces" + suffix + ".npy";
+        readNpyFile(forces_file, values);
+        ASSERT_EQ(18u, values.size());
+        EXPECT_EQ(summaries[c].nodal_forces(2, c == 0 ? 1 : 2), values[6 * 2 + (c == 0 ? 1 : 2)]);
+
+        const std::string ties_file = "SolveSavesNpyResults_ties" + suffix;
+        EXPECT_NE(std::string::npos, readNpyFile(ties_file, values).find("'shape': (1, 6)"));
+        ASSERT_EQ(6u, values.size());
+        for (size_t j = 0; j < DOF::NUM_DOFS; ++j) {
+            EXPECT_EQ(summaries[c].tie_forces(0, j), values[j]);
+        }
+
+        removeFile(disp_file);
+        removeFile(forces_file);
+        removeFile(ties_file);
+    }
+}
+
+TEST(ResultFileTest, WritesVtuFile) {
+    std::vector<Node> nodes = {Node(0, 0, 0), Node(1, 0, 0), Node(1, 2, 3)};
+    Job job;
+    job.nodes = nodes;
+    job.elems = {Eigen::Vector2i(0, 1), Eigen::Vector2i(1, 2)};
+    std::vector<Tie> ties = {Tie(2, 0, 1.0, 1.0)};
+
+    Summary summary;
+    summary.nodal_displacements.resize(nodes.size(), 6);
+    for (long i = 0; i < summary.nodal_displacements.rows(); ++i) {
+        summary.nodal_displacements.row(i) << 1.0 * i, 2.0 * i, 3.0 * i, 4.0 * i, 5.0 * i, 6.0 * i;
+    }
+    summary.nodal_forces = -summary.nodal_displacements;
+    summary.tie_forces.resize(1, 6);
+    summary.tie_forces << 7, 8, 9, 10, 11, 12;
+
+    const std::string filename = "WritesVtuFile.vtu";
+    writeVtuFile(filename, job, ties, summary);
+    const std::string contents = readFile(filename);
+
+    EXPECT_NE(std::string::npos, contents.find("<Piece NumberOfPoints=\"3\" NumberOfCells=\"3\">"));
+    EXPECT_NE(std::string::npos, contents.find("header_type=\"UInt64\""));
+    EXPECT_EQ("</VTKFile>\n", contents.substr(contents.size() - 11));
+
+    const std::vector<double> points = readVtuArray<double>(contents, "Points");
+    ASSERT_EQ(9u, points.size());
+    EXPECT_EQ(3.0, points[8]);
+
+    // VTK rejects cell arrays with more than one component
+    EXPECT_NE(std::string::npos, contents.find("Name=\"connectivity\" NumberOfComponents=\"1\""));
+    EXPECT_NE(std::string::npos, contents.find("Name=\"offsets\" NumberOfComponents=\"1\""));
+    EXPECT_NE(std::string::npos, contents.find("Name=\"types\" NumberOfComponents=\"1\""));
+    const std::vector<int64_t> connectivity = readVtuArray<int64_t>(contents, "connectivity");
+    const std::vector<int64_t> expected_connectivity = {0, 1, 1, 2, 2, 0};
+    EXPECT_EQ(expected_connectivity, connectivity);
+    const std::vector<int64_t> offsets = readVtuArray<int64_t>(contents, "offsets");
+    const std::vector<int64_t> expected_offsets = {2, 4, 6};
+    EXPECT_EQ(expected_offsets, offsets);
+    EXPECT_EQ(std::vector<uint8_t>(3, 3), readVtuArray<uint8_t>(contents, "types"));
+    const std::vector<uint8_t> expected_cell_set = {0, 0, 1};
+    EXPECT_EQ(expected_cell_set, readVtuArray<uint8_t>(contents, "cell_set"));
+
+    const std::vector<double> rotation = readVtuArray<double>(contents, "rotation");
+    ASSERT_EQ(9u, rotation.size());
+    EXPECT_EQ(6.0, rotation[5]);
+    const std::vector<double> force = readVtuArray<double>(contents, "force");
+    ASSERT_EQ(9u, force.size());
+    EXPECT_EQ(-6.0, force[8]);
+    const std::vector<double> tie_moment = readVtuArray<double>(contents, "tie_moment");
+    const std::vector<double> expected_tie_moment = {0, 0, 0, 0, 0, 0, 10, 11, 12};
+    EXPECT_EQ(expected_tie_moment, tie_moment);
+
+    summary.nodal_forces.conservativeResize(2, 6);
+    EXPECT_THROW(writeVtuFile(filename, job, ties, summary), std::runtime_error);
+    removeFile(filename);
+}
+
+TEST(ResultFileTest, SolveSavesVtuInInputNumbering) {
+    std::vector<Node> nodes = {Node(0, 0, 0), Node(2, 0, 0), Node(1, 0, 0), Node(1, 1, 0), Node(2, 1, 0)};
+    Props props(1000.0, 100.0, 100.0, 200.0, {0.0, 0.0, 1.0});
+    std::vector<Elem> elems = {Elem(0, 2, props), Elem(2, 1, props), Elem(2, 3, props), Elem(3, 4, props)};
+    Job job(nodes, elems);
+
+    std::vector<BC> bcs;
+    for (unsigned int j = 0; j < DOF::NUM_DOFS; ++j) {
+        bcs.push_back(BC(0, j, 0.0));
+    }
+    std::vector<Force> forces = {Force(4, DOF::DISPLACEMENT_Z, 1.0)};
+    std::vector<Tie> ties = {Tie(1, 4, 10.0, 10.0)};
+
+    Options opts;
+    opts.save_vtu = true;
+    opts.vtu_filename = "SolveSavesVtuInInputNumbering_original.vtu";
+    solve(job, bcs, forces, ties, std::vector<Equation>(), opts);
+
+    opts.node_ordering = REVERSE_CUTHILL_MCKEE;
+    opts.vtu_filename = "SolveSavesVtuInInputNumbering_rcm.vtu";
+    Summary summary = solve(job, bcs, forces, ties, std::vector<Equation>(), opts);
+
+    const std::string expected = readFile("SolveSavesVtuInInputNumbering_original.vtu");
+    const std::string renumbered = readFile("SolveSavesVtuInInputNumbering_rcm.vtu");
+    EXPECT_EQ(readVtuArray<double>(expected, "Points"), readVtuArray<double>(renumbered, "Points"));
+    EXPECT_EQ(readVtuArray<int64_t>(expected, "connectivity"), readVtuArray<int64_t>(renumbered, "connectivity"));
+
+    const std::vector<double> displacement = readVtuArray<double>(renumbered, "displacement");
+    ASSERT_EQ(3 * nodes.size(), displacement.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(summary.nodal_displacements(i, j), displacement[3 * i + j]);
+        }
+    }
+
+    removeFile("SolveSavesVtuInInputNumbering_original.vtu");
+    removeFile("SolveSavesVtuInInputNumbering_rcm.vtu");
+}
@@ -0,0 +1,144 @@
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "result_statistics.h"
+#include "summary.h"
+
+using namespace fea;
+
+TEST(ResultStatisticsTest, ComputesColumnStatistics) {
+    ResultMatrix results(4, 6);
+    results << 1, 0, 0, 0, 0, 0,
+            -3, 0, 0, 0, 0, 2,
+            3, 0, 0, 0, 0, 2,
+            -1, 0, 0, 0, 0, -4;
+
+    const ResultStatistics statistics = computeResultStatistics(results, 2, 4);
+    EXPECT_EQ(4u, statistics.num_rows);
+    ASSERT_EQ(6u, statistics.columns.size());
+
+    const ColumnStatistics &x = statistics.columns[0];
+    EXPECT_EQ(1u, x.min.row);
+    EXPECT_DOUBLE_EQ(-3.0, x.min.value);
+    EXPECT_EQ(2u, x.max.row);
+    EXPECT_DOUBLE_EQ(3.0, x.max.value);
+    EXPECT_DOUBLE_EQ(0.0, x.mean);
+    EXPECT_DOUBLE_EQ(std::sqrt(5.0), x.rms);
+    ASSERT_EQ(2u, x.largest.size());
+    EXPECT_EQ(1u, x.largest[0].row);
+    EXPECT_EQ(2u, x.largest[1].row);
+    const std::vector<unsigned long> expected_x_histogram = {1, 1, 1, 1};
+    EXPECT_EQ(expected_x_histogram, x.histogram);
+    EXPECT_DOUBLE_EQ(-3.0, x.histogram_min);
+    EXPECT_DOUBLE_EQ(3.0, x.histogram_max);
+
+    const ColumnStatistics &y = statistics.columns[1];
+    EXPECT_EQ(0u, y.min.row);
+    EXPECT_EQ(0u, y.max.row);
+    const std::vector<unsigned long> expected_y_histogram = {4, 0, 0, 0};
+    EXPECT_EQ(expected_y_histogram, y.histogram);
+
+    const ColumnStatistics &rot_z = statistics.columns[5];
+    EXPECT_DOUBLE_EQ(0.0, rot_z.mean);
+    ASSERT_EQ(2u, rot_z.largest.size());
+    EXPECT_EQ(3u, rot_z.largest[0].row);
+    EXPECT_EQ(1u, rot_z.largest[1].row);
+    const std::vector<unsigned long> expected_rot_z_histogram = {1, 0, 1, 2};
+    EXPECT_EQ(expected_rot_z_histogram, rot_z.histogram);
+}
+
+TEST(ResultStatisticsTest, MatchesSerialScanOverSeveralChunks) {
+    const long num_rows = 10007;
+    std::srand(7);
+    ResultMatrix results(num_rows, 6);
+    for (long i = 0; i < num_rows; ++i) {
+        for (long j = 0; j < 6; ++j) {
+            results(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / (j + 1);
+        }
+    }
+
+    const unsigned int num_largest = 5;
+    const unsigned int num_bins = 7;
+    // let OpenMP choose the number of threads, the result must not depend on it
+    const ResultStatistics statistics = computeResultStatistics(results, num_largest, num_bins, 0);
+    ASSERT_EQ(6u, statistics.columns.size());
+    for (long j = 0; j < 6; ++j) {
+        const ColumnStatistics &column = statistics.columns[j];
+        long min_row = 0;
+        long max_row = 0;
+        double sum = 0.0;
+        double sum_of_squares = 0.0;
+        std::vector<std::pair<double, long> > magnitudes;
+        for (long i = 0; i < num_rows; ++i) {
+            if (results(i, j) < results(min_row, j)) min_row = i;
+            if (results(i, j) > results(max_row, j)) max_row = i;
+            sum += results(i, j);
+            sum_of_squares += results(i, j) * results(i, j);
+            magnitudes.push_back(std::make_pair(-std::abs(results(i, j)), i));
+        }
+        std::sort(magnitudes.begin(), magnitudes.end());
+
+        EXPECT_EQ(static_cast<size_t>(min_row), column.min.row);
+        EXPECT_EQ(static_cast<size_t>(max_row), column.max.row);
+        EXPECT_NEAR(sum / num_rows, column.mean, 1e-9);
+        EXPECT_NEAR(std::sqrt(sum_of_squares / num_rows), column.rms, 1e-9);
+        ASSERT_EQ(num_largest, column.largest.size());
+        for (size_t k = 0; k < num_largest; ++k) {
+            EXPECT_EQ(static_cast<size_t>(magnitudes[k].second), column.largest[k].row);
+        }
+        ASSERT_EQ(num_bins, column.histogram.size());
+        unsigned long count = 0;
+        for (size_t b = 0; b < num_bins; ++b) {
+            count += column.histogram[b];
+        }
+        EXPECT_EQ(static_cast<unsigned long>(num_rows), count);
+    }
+}
+
+TEST(ResultStatisticsTest, HandlesEmptyResults) {
+    const ResultStatistics statistics = computeResultStatistics(ResultMatrix(0, 6), 3, 10);
+    EXPECT_EQ(0u, statistics.num_rows);
+    EXPECT_TRUE(statistics.columns.empty());
+}
+
+TEST(ResultStatisticsTest, FullReportFormatsStatistics) {
+    Summary summary;
+    summary.nodal_displacements.resize(2, 6);
+    summary.nodal_displacements << 0, 0, -2, 0, 0, 0,
+            0, 5, 0, 0, 0, 0;
+    summary.nodal_displacement_statistics = computeResultStatistics(summary.nodal_displacements, 1, 2);
+
+    const std::string report = summary.FullReport();
+    EXPECT_NE(std::string::npos, report.find("Minimum : Node 0\tDOF 2\tValue -2.000"));
+    EXPECT_NE(std::string::npos, report.find("Maximum : Node 1\tDOF 1\tValue 5.000"));
+    EXPECT_NE(std::string::npos, report.find("DOF 1 : Mean 2.500e+00\tRMS 3.536e+00"));
+    EXPECT_NE(std::string::npos, report.find("Largest magnitudes : Node 1 (5.000e+00)"));
+    EXPECT_NE(std::string::npos, report.find("Histogram [0.000e+00, 5.000e+00] : 1 1"));
+    EXPECT_EQ(std::string::npos, report.find("Nodal Forces"));
+}
@@ -199,6 +199,261 @@ TEST(SetupTest, CreatesCorrectForcesFromJSON) {
     }
 }
 
+TEST(SetupTest, CreatesCorrectLoadCasesFromJSON) {
+    std::string forces_file = "CreatesCorrectLoadCases.csv";
+    std::string json = "{\"forces\":\"" + forces_file + "\"}\n";
+    std::string filename = "CreatesCorrectLoadCases.json";
+    writeStringToTxt(filename, json);
+    writeStringToTxt(forces_file, "1,2,3.5\n4,5,6.5,2\n7,0,-1.5,0\n");
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+    std::vector<std::vector<Force> > load_cases = createLoadCasesFromJSON(doc);
+
+    ASSERT_EQ(3u, load_cases.size());
+    ASSERT_EQ(2u, load_cases[0].size());
+    EXPECT_TRUE(load_cases[1].empty());
+    ASSERT_EQ(1u, load_cases[2].size());
+
+    EXPECT_EQ(1u, load_cases[0][0].node);
+    EXPECT_EQ(2u, load_cases[0][0].dof);
+    EXPECT_DOUBLE_EQ(3.5, load_cases[0][0].value);
+    EXPECT_EQ(7u, load_cases[0][1].node);
+    EXPECT_EQ(0u, load_cases[0][1].dof);
+    EXPECT_DOUBLE_EQ(-1.5, load_cases[0][1].value);
+    EXPECT_EQ(4u, load_cases[2][0].node);
+    EXPECT_EQ(5u, load_cases[2][0].dof);
+    EXPECT_DOUBLE_EQ(6.5, load_cases[2][0].value);
+
+    writeStringToTxt(forces_file, "1,2,3.5,-1\n");
+    EXPECT_THROW(createLoadCasesFromJSON(doc), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(forces_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << forces_file << ".\n";
+    }
+}
+
+TEST(SetupTest, ReportsFirstInvalidRowFromJSON) {
+    std::string nodes_file = "ReportsFirstInvalidRow.csv";
+    std::string json = "{\"nodes\":\"" + nodes_file + "\"}\n";
+    std::string filename = "ReportsFirstInvalidRow.json";
+    writeStringToTxt(filename, json);
+    writeStringToTxt(nodes_file, "1,2,3\n4,5\n6,7,8\n9\n");
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+    try {
+        createNodeVecFromJSON(doc);
+        FAIL() << "Expected an exception for the invalid rows.";
+    }
+    catch (std::runtime_error &e) {
+        EXPECT_EQ("Row 1 in nodes does not specify x, y and z coordinates.", std::string(e.what()));
+    }
+
+    writeStringToTxt(nodes_file, "");
+    EXPECT_THROW(createNodeVecFromJSON(doc), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(nodes_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << nodes_file << ".\n";
+    }
+}
+
+TEST(SetupTest, CreatesModelFromInlineArrays) {
+    std::string props_file = "CreatesModelFromInlineArrays_props.csv";
+    writeStringToTxt(props_file, "1,2,3,4,0,0,1\n5,6,7,8,0,1,0\n");
+    std::string json = "{\"options\":{\"epsilon\":1e-10,\"linear_solver\":\"ldlt\"},"
+            "\"nodes\":[[0,0,0],[1,0,0],[2,0.1,-3e-1]],"
+            "\"elems\":[[0,1],[1,2]],"
+            "\"props\":\"" + props_file + "\","
+            "\"bcs\":[[0,0,0],[0,1,0.5]],"
+            "\"forces\":[[2,1,-10],[2,2,3,2],[1,0,4]],"
+            "\"ties\":[[1,2,100,200]],"
+            "\"equations\":[[0,1,1,2,1,-1],[1,5,2]]}\n";
+    std::string filename = "CreatesModelFromInlineArrays.json";
+    writeStringToTxt(filename, json);
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+    const Model expected = createModelFromJSON(doc);
+    const Model model = createModelFromJSONFile(filename);
+
+    ASSERT_EQ(3u, model.job.nodes.size());
+    for (size_t i = 0; i < model.job.nodes.size(); ++i) {
+        EXPECT_EQ(expected.job.nodes[i], model.job.nodes[i]);
+    }
+    EXPECT_DOUBLE_EQ(-0.3, model.job.nodes[2](2));
+    ASSERT_EQ(2u, model.job.elems.size());
+    ASSERT_EQ(2u, model.job.props.size());
+    for (size_t i = 0; i < model.job.elems.size(); ++i) {
+        EXPECT_EQ(expected.job.elems[i], model.job.elems[i]);
+        EXPECT_EQ(expected.job.props[i].EA, model.job.props[i].EA);
+        EXPECT_EQ(expected.job.props[i].normal_vec, model.job.props[i].normal_vec);
+    }
+    ASSERT_EQ(2u, model.bcs.size());
+    EXPECT_EQ(1u, model.bcs[1].dof);
+    EXPECT_DOUBLE_EQ(0.5, model.bcs[1].value);
+    ASSERT_EQ(3u, model.load_cases.size());
+    ASSERT_EQ(2u, model.load_cases[0].size());
+    EXPECT_TRUE(model.load_cases[1].empty());
+    ASSERT_EQ(1u, model.load_cases[2].size());
+    EXPECT_DOUBLE_EQ(3, model.load_cases[2][0].value);
+    ASSERT_EQ(1u, model.ties.size());
+    EXPECT_DOUBLE_EQ(200, model.ties[0].rmult);
+    ASSERT_EQ(2u, model.equations.size());
+    ASSERT_EQ(2u, model.equations[0].terms.size());
+    EXPECT_DOUBLE_EQ(-1, model.equations[0].terms[1].coefficient);
+    EXPECT_EQ(1u, model.equations[1].terms.size());
+    EXPECT_EQ(1e-10, model.options.epsilon);
+    EXPECT_EQ(SPARSE_LDLT, model.options.linear_solver);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(props_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << props_file << ".\n";
+    }
+}
+
+TEST(SetupTest, ReportsInvalidInlineRows) {
+    std::string filename = "ReportsInvalidInlineRows.json";
+    const std::string configs[] = {"{\"nodes\":[[0,0,0],[1,\"a\",0]],\"elems\":[[0,1]],\"props\":[[1,1,1,1,0,0,1]]}",
+                                   "{\"nodes\":[[0,0,0],1],\"elems\":[[0,1]],\"props\":[[1,1,1,1,0,0,1]]}",
+                                   "{\"nodes\":[[0,0,0],[1,[0],0]],\"elems\":[[0,1]],\"props\":[[1,1,1,1,0,0,1]]}"};
+    for (size_t i = 0; i < 3; ++i) {
+        writeStringToTxt(filename, configs[i]);
+        rapidjson::Document doc = parseJSONConfig(filename);
+        for (int streamed = 0; streamed < 2; ++streamed) {
+            try {
+                if (streamed) {
+                    createModelFromJSONFile(filename);
+                }
+                else {
+                    createNodeVecFromJSON(doc);
+                }
+                FAIL() << "Expected an exception for config " << i;
+            }
+            catch (std::runtime_error &e) {
+                EXPECT_EQ("Row 1 in nodes is not an array of numbers.", std::string(e.what()));
+            }
+        }
+    }
+
+    writeStringToTxt(filename, "{\"nodes\":[[0,0,0],[1,0]],\"elems\":[[0,1]],\"props\":[[1,1,1,1,0,0,1]]}");
+    try {
+        createModelFromJSONFile(filename);
+        FAIL() << "Expected an exception for the row with 2 coordinates";
+    }
+    catch (std::runtime_error &e) {
+        EXPECT_EQ("Row 1 in nodes does not specify x, y and z coordinates.", std::string(e.what()));
+    }
+
+    writeStringToTxt(filename, "{\"nodes\":[],\"elems\":[[0,1]],\"props\":[[1,1,1,1,0,0,1]]}");
+    EXPECT_THROW(createModelFromJSONFile(filename), std::runtime_error);
+
+    writeStringToTxt(filename, "{\"nodes\":[[0,0,0],[1,0,0]],\"elems\":[[0,1]]");
+    EXPECT_THROW(createModelFromJSONFile(filename), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+}
+
+TEST(SetupTest, LoadsInputFilesConcurrently) {
+    std::string nodes_file = "LoadsInputFilesConcurrently_nodes.csv";
+    std::string elems_file = "LoadsInputFilesConcurrently_elems.csv";
+    std::string props_file = "LoadsInputFilesConcurrently_props.csv";
+    std::string bcs_file = "LoadsInputFilesConcurrently_bcs.csv";
+    writeStringToTxt(nodes_file, "0,0,0\n1,0,0\n");
+    writeStringToTxt(elems_file, "0,1\n");
+    writeStringToTxt(props_file, "1,1,1,1,0,0,1\n");
+    writeStringToTxt(bcs_file, "0,0,0\n");
+    std::string json = "{\"nodes\":\"" + nodes_file + "\",\"elems\":\"" + elems_file + "\",\"props\":\"" +
+            props_file + "\",\"bcs\":\"" + bcs_file + "\",\"forces\":[[1,1,1]]}\n";
+    std::string filename = "LoadsInputFilesConcurrently.json";
+    writeStringToTxt(filename, json);
+
+    const Model model = createModelFromJSONFile(filename);
+    ASSERT_EQ(5u, model.input_load_times.size());
+    const std::string variables[] = {"config", "nodes", "elems", "props", "bcs"};
+    const std::string filenames[] = {filename, nodes_file, elems_file, props_file, bcs_file};
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(variables[i], model.input_load_times[i].variable);
+        EXPECT_EQ(filenames[i], model.input_load_times[i].filename);
+        EXPECT_LE(0, model.input_load_times[i].load_time_in_ms);
+    }
+    EXPECT_EQ(2u, model.job.nodes.size());
+    EXPECT_EQ(1u, model.bcs.size());
+    EXPECT_EQ(1u, model.load_cases[0].size());
+
+    // the error of the first member is reported even if later members fail as well
+    writeStringToTxt(nodes_file, "0,0\n");
+    writeStringToTxt(bcs_file, "0,0\n");
+    try {
+        createModelFromJSONFile(filename);
+        FAIL() << "Expected an exception for the invalid nodes and bcs.";
+    }
+    catch (std::runtime_error &e) {
+        EXPECT_EQ("Row 0 in nodes does not specify x, y and z coordinates.", std::string(e.what()));
+    }
+
+    const std::string files[] = {filename, nodes_file, elems_file, props_file, bcs_file};
+    for (size_t i = 0; i < 5; ++i) {
+        if (std::remove(files[i].c_str()) != 0) {
+            std::cerr << "Error removing test csv file " << files[i] << ".\n";
+        }
+    }
+}
+
+TEST(SetupTest, CreatesPropertyTableFromJSON) {
+    std::string prop_ids_file = "CreatesPropertyTable_prop_ids.csv";
+    writeStringToTxt(prop_ids_file, "1\n0\n1\n");
+    std::string json = "{\"nodes\":[[0,0,0],[1,0,0],[2,0,0],[3,0,0]],"
+            "\"elems\":[[0,1],[1,2],[2,3]],"
+            "\"props\":[[1,2,3,4,0,0,1],[5,6,7,8,0,1,0]],"
+            "\"prop_ids\":\"" + prop_ids_file + "\"}\n";
+    std::string filename = "CreatesPropertyTable.json";
+    writeStringToTxt(filename, json);
+
+    rapidjson::Document doc = parseJSONConfig(filename);
+    Job job = createJobFromJSON(doc);
+    ASSERT_EQ(2u, job.props.size());
+    ASSERT_EQ(3u, job.prop_ids.size());
+    EXPECT_EQ(5, job.getElemProps(0).EA);
+    EXPECT_EQ(1, job.getElemProps(1).EA);
+    EXPECT_EQ(5, job.getElemProps(2).EA);
+
+    std::vector<Elem> elems = createElemVecFromJSON(doc);
+    ASSERT_EQ(3u, elems.size());
+    EXPECT_EQ(6, elems[2].props.EIz);
+
+    const Model model = createModelFromJSONFile(filename);
+    EXPECT_EQ(job.prop_ids, model.job.prop_ids);
+    EXPECT_EQ(2u, model.job.props.size());
+
+    writeStringToTxt(prop_ids_file, "1\n0\n2\n");
+    try {
+        createModelFromJSONFile(filename);
+        FAIL() << "Expected an exception for the missing property.";
+    }
+    catch (std::runtime_error &e) {
+        EXPECT_EQ("Row 2 in prop_ids refers to row 2 of props, but props only has 2 rows.", std::string(e.what()));
+    }
+    writeStringToTxt(prop_ids_file, "1\n0\n");
+    EXPECT_THROW(createJobFromJSON(doc), std::runtime_error);
+    writeStringToTxt(prop_ids_file, "1\n0.5\n1\n");
+    EXPECT_THROW(createJobFromJSON(doc), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(prop_ids_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << prop_ids_file << ".\n";
+    }
+}
+
 TEST(SetupTest, CreatesCorrectTiesFromJSON) {
     std::string ties_file = "CreatesCorrectTies.csv";
     std::string json = "{\"ties\":\"" + ties_file + "\"}\n";
@@ -325,10 +580,16 @@ TEST(SetupTest, CreatesCorrectJobFromJSON) {
 
 TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
     std::string json = "{\"options\":{\"epsilon\":1E-10,\"csv_precision\":10,\"csv_delimiter\":\" \","
+            "\"result_format\":\"npy\",\"save_vtu\":true,\"vtu_filename\":\"vf.vtu\","
+            "\"num_largest_values\":5,\"num_histogram_bins\":0,\"compute_nodal_forces\":false,"
+            "\"compute_reaction_forces\":false,\"compute_tie_forces\":false,\"compute_elem_forces\":true,"
+            "\"save_elem_forces\":true,\"elem_forces_filename\":\"eff.csv\","
             "\"save_nodal_displacements\":true,\"save_nodal_forces\":true,\"save_nodal_forces\":true,"
             "\"save_tie_forces\":true,\"verbose\":true,\"save_report\":true,"
             "\"nodal_displacements_filename\":\"ndf.csv\",\"nodal_forces_filename\":\"nff.csv\","
-            "\"tie_forces_filename\":\"tff.csv\",\"report_filename\":\"rf.txt\"}}\n";
+            "\"tie_forces_filename\":\"tff.csv\",\"report_filename\":\"rf.txt\",\"num_threads\":3,\"use_sparsity_pattern\":true,"
+            "\"linear_solver\":\"minres\",\"eliminate_bcs\":true,\"preconditioner\":\"incomplete_cholesky\","
+            "\"tolerance\":1E-8,\"max_iterations\":500,\"node_ordering\":\"rcm\"}}\n";
     std::string filename = "CreatesCorrectOptions.json";
     writeStringToTxt(filename, json);
 
@@ -338,6 +599,7 @@ TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
     expected.epsilon = 1E-10;
     expected.csv_precision = 10;
     expected.csv_delimiter = " ";
+    expected.result_format = NPY_RESULTS;
     expected.save_nodal_displacements = true;
     expected.save_nodal_forces = true;
     expected.save_tie_forces = true;
@@ -346,12 +608,31 @@ TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
     expected.nodal_forces_filename = "nff.csv";
     expected.tie_forces_filename = "tff.csv";
     expected.report_filename = "rf.txt";
+    expected.save_vtu = true;
+    expected.vtu_filename = "vf.vtu";
+    expected.num_largest_values = 5;
+    expected.compute_nodal_forces = false;
+    expected.compute_reaction_forces = false;
+    expected.compute_tie_forces = false;
+    expected.compute_elem_forces = true;
+    expected.save_elem_forces = true;
+    expected.elem_forces_filename = "eff.csv";
+    expected.num_histogram_bins = 0;
+    expected.num_threads = 3;
+    expected.use_sparsity_pattern = true;
+    expected.linear_solver = MINRES;
+    expected.eliminate_bcs = true;
+    expected.preconditioner = INCOMPLETE_CHOLESKY;
+    expected.tolerance = 1E-8;
+    expected.max_iterations = 500;
+    expected.node_ordering = REVERSE_CUTHILL_MCKEE;
 
     Options options = createOptionsFromJSON(doc);
 
     EXPECT_DOUBLE_EQ(expected.epsilon, options.epsilon);
     EXPECT_EQ(expected.csv_precision, options.csv_precision);
     EXPECT_EQ(expected.csv_delimiter, options.csv_delimiter);
+    EXPECT_EQ(expected.result_format, options.result_format);
     EXPECT_EQ(expected.save_nodal_displacements, options.save_nodal_displacements);
     EXPECT_EQ(expected.save_nodal_forces, options.save_nodal_forces);
     EXPECT_EQ(expected.save_tie_forces, options.save_tie_forces);
@@ -360,8 +641,77 @@ TEST(SetupTest, CreatesCorrectOptionsFromJSON) {
     EXPECT_EQ(expected.nodal_forces_filename, options.nodal_forces_filename);
     EXPECT_EQ(expected.tie_forces_filename, options.tie_forces_filename);
     EXPECT_EQ(expected.report_filename, options.report_filename);
+    EXPECT_EQ(expected.save_vtu, options.save_vtu);
+    EXPECT_EQ(expected.vtu_filename, options.vtu_filename);
+    EXPECT_EQ(expected.num_largest_values, options.num_largest_values);
+    EXPECT_EQ(expected.compute_nodal_forces, options.compute_nodal_forces);
+    EXPECT_EQ(expected.compute_reaction_forces, options.compute_reaction_forces);
+    EXPECT_EQ(expected.compute_tie_forces, options.compute_tie_forces);
+    EXPECT_EQ(expected.compute_elem_forces, options.compute_elem_forces);
+    EXPECT_EQ(expected.save_elem_forces, options.save_elem_forces);
+    EXPECT_EQ(expected.elem_forces_filename, options.elem_forces_filename);
+    EXPECT_EQ(expected.num_histogram_bins, options.num_histogram_bins);
+    EXPECT_EQ(expected.num_threads, options.num_threads);
+    EXPECT_EQ(expected.use_sparsity_pattern, options.use_sparsity_pattern);
+    EXPECT_EQ(expected.linear_solver, options.linear_solver);
+    EXPECT_EQ(expected.eliminate_bcs, options.eliminate_bcs);
+    EXPECT_EQ(expected.preconditioner, options.preconditioner);
+    EXPECT_DOUBLE_EQ(expected.tolerance, options.tolerance);
+    EXPECT_EQ(expected.max_iterations, options.max_iterations);
+    EXPECT_EQ(expected.node_ordering, options.node_ordering);
 
     if (std::remove(filename.c_str()) != 0) {
         std::cerr << "Error removing test csv file " << filename << ".\n";
     }
 }
+
+TEST(SetupTest, CreatesModelFromLattice) {
+    std::string bcs_file = "CreatesModelFromLattice_bcs.csv";
+    writeStringToTxt(bcs_file, "26,0,0.5\n");
+    std::string json = "{\"lattice\":{\"unit_cell\":\"cubic\",\"cells\":[2,2,2],\"cell_size\":[1,1,2],"
+            "\"section\":[1000,100,100,200],\"fixed_face\":\"z_min\",\"loaded_face\":\"z_max\","
+            "\"face_force\":[0,9,-18]},"
+            "\"bcs\":\"" + bcs_file + "\",\"forces\":[[13,0,1,1]]}\n";
+    std::string filename = "CreatesModelFromLattice.json";
+    writeStringToTxt(filename, json);
+
+    const Model model = createModelFromJSONFile(filename);
+    rapidjson::Document doc = parseJSONConfig(filename);
+    const Job job = createJobFromJSON(doc);
+
+    ASSERT_EQ(27u, model.job.nodes.size());
+    EXPECT_EQ(54u, model.job.elems.size());
+    EXPECT_EQ(3u, model.job.props.size());
+    EXPECT_EQ(model.job.nodes.size(), job.nodes.size());
+    EXPECT_EQ(model.job.elems.size(), job.elems.size());
+    EXPECT_DOUBLE_EQ(4, model.job.nodes[26](2));
+
+    // the bcs from the file come first, then the fixed face
+    ASSERT_EQ(1u + 9u * NUM_DOFS, model.bcs.size());
+    EXPECT_EQ(26u, model.bcs[0].node);
+    EXPECT_DOUBLE_EQ(0, model.job.nodes[model.bcs.back().node](2));
+
+    // the face force is spread over the 9 top nodes of the first load case
+    ASSERT_EQ(2u, model.load_cases.size());
+    ASSERT_EQ(18u, model.load_cases[0].size());
+    EXPECT_DOUBLE_EQ(1, model.load_cases[0][0].value);
+    EXPECT_DOUBLE_EQ(-2, model.load_cases[0][1].value);
+    EXPECT_EQ(1u, model.load_cases[1].size());
+
+    std::string invalid_json = "{\"lattice\":{\"unit_cell\":\"cubic\",\"cells\":[1,1,1],"
+            "\"section\":[1,1,1,1]},\"nodes\":[[0,0,0]]}";
+    rapidjson::Document invalid_doc;
+    invalid_doc.Parse(invalid_json.c_str());
+    EXPECT_THROW(createModelFromJSON(invalid_doc), std::runtime_error);
+
+    invalid_json = "{\"lattice\":{\"unit_cell\":\"diamond\",\"cells\":[1,1,1],\"section\":[1,1,1,1]}}";
+    invalid_doc.Parse(invalid_json.c_str());
+    EXPECT_THROW(createModelFromJSON(invalid_doc), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << filename << ".\n";
+    }
+    if (std::remove(bcs_file.c_str()) != 0) {
+        std::cerr << "Error removing test csv file " << bcs_file << ".\n";
+    }
+}